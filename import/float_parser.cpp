@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "float_parser.h"
+
+namespace sandbox {
+	namespace {
+		// Every power of ten up to 10^10 is exactly representable as a float, as is every integer up to 2^24; the
+		// quotient of two exact values is correctly rounded, and therefore identical to what std::from_chars() produces
+		constexpr std::array<float, 11> exact_powers_of_ten {
+			1e0f,
+			1e1f,
+			1e2f,
+			1e3f,
+			1e4f,
+			1e5f,
+			1e6f,
+			1e7f,
+			1e8f,
+			1e9f,
+			1e10f,
+		};
+
+		constexpr std::uint64_t max_exact_mantissa {1 << 24};
+
+		bool is_digit(char character) noexcept { return character >= '0' && character <= '9'; }
+
+		// Succeeds only for [-]digits[.digits] that can be converted exactly; leaves `iterator` untouched otherwise
+		GSL_SUPPRESS(bounds .1)
+		bool parse_simple_decimal(const char*& iterator, const char* last, float& value) noexcept
+		{
+			auto cursor = iterator;
+			const auto negative = cursor != last && *cursor == '-';
+			if (negative)
+				++cursor;
+
+			std::uint64_t mantissa {};
+			std::size_t digits {};
+			for (; cursor != last && is_digit(*cursor) && digits < 10; ++cursor, ++digits)
+				mantissa = mantissa * 10 + (*cursor - '0');
+
+			std::size_t fraction_digits {};
+			if (cursor != last && *cursor == '.') {
+				++cursor;
+				for (; cursor != last && is_digit(*cursor) && fraction_digits < 10 && digits + fraction_digits < 18;
+					 ++cursor, ++fraction_digits)
+					mantissa = mantissa * 10 + (*cursor - '0');
+			}
+
+			if (digits + fraction_digits == 0 || mantissa > max_exact_mantissa)
+				return false;
+
+			if (cursor != last && *cursor != ' ')
+				return false;
+
+			const auto magnitude = gsl::narrow_cast<float>(mantissa) / exact_powers_of_ten.at(fraction_digits);
+			value = negative ? -magnitude : magnitude;
+			iterator = cursor;
+			return true;
+		}
+
+		GSL_SUPPRESS(bounds .1)
+		bool parse_general(const char*& iterator, const char* last, float& value) noexcept
+		{
+			const auto token_last = std::find(iterator, last, ' ');
+			const auto [end, error] = std::from_chars(iterator, token_last, value);
+			iterator = token_last;
+			return error == std::errc {} && end == token_last;
+		}
+	}
+}
+
+GSL_SUPPRESS(bounds .1)
+std::size_t sandbox::parse_float_record(std::string_view text, gsl::span<float> values, std::size_t required) noexcept
+{
+	auto iterator = text.data();
+	const auto last = std::next(text.data(), text.size());
+	std::size_t malformed {};
+	std::size_t index {};
+	for (auto& value : values) {
+		value = 0.0f;
+		for (; iterator != last && *iterator == ' '; ++iterator)
+			;
+
+		if (iterator == last) {
+			if (index < required)
+				++malformed;
+		}
+		else if (!parse_simple_decimal(iterator, last, value) && !parse_general(iterator, last, value)) {
+			++malformed;
+		}
+
+		++index;
+	}
+
+	return malformed;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// Parses space-separated floats from `text` into `values` in a single pass, ignoring anything past the last one.
+	// Plain decimals are converted inline; exponents, inf, nan and anything else std::from_chars() accepts go through
+	// it instead. Components that are missing (only counted for the first `required`), cannot be parsed, or are
+	// followed by trailing junk are counted as malformed; the number of malformed components is returned.
+	// Unparseable components are left zeroed, exactly as std::from_chars() would leave them.
+	std::size_t parse_float_record(std::string_view text, gsl::span<float> values, std::size_t required) noexcept;
+}
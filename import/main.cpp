@@ -1,36 +1,21 @@
 #include "pch.h"
 
 #include "../runtime/stream_format.h"
+#include "mesh_optimizer.h"
+#include "meshlet_building.h"
+#include "stream_writer.h"
+#include "submesh_splitting.h"
+#include "vertex_compression.h"
+#include "vertex_repacking.h"
 #include "wavefront_loader.h"
 
 namespace sandbox {
-	bool operator==(const vertex& a, const vertex& b) noexcept
-	{
-		return a.position == b.position && a.texture == b.texture && a.normal == b.normal;
-	}
-
 	bool operator==(const vector3& a, const vector3& b) noexcept
 	{
 		return a.x == b.x && a.y == b.y && a.z == b.z;
 	}
 
 	namespace {
-		GSL_SUPPRESS(type) // Used to write byte representation to a binary file
-		void write_streams(
-			gsl::czstring filename,
-			gsl::span<const unsigned int> indices,
-			gsl::span<const vertex_data> vertices)
-		{
-			std::ofstream outfile {filename, outfile.binary};
-			outfile.exceptions(outfile.failbit | outfile.badbit);
-			const auto index_count = indices.size();
-			const auto vertex_count = vertices.size();
-			outfile.write(reinterpret_cast<const char*>(&index_count), sizeof(index_count));
-			outfile.write(reinterpret_cast<const char*>(&vertex_count), sizeof(vertex_count));
-			outfile.write(reinterpret_cast<const char*>(indices.data()), index_count * sizeof(unsigned int));
-			outfile.write(reinterpret_cast<const char*>(vertices.data()), vertex_count * sizeof(vertex_data));
-		}
-
 		void write_wavefront(
 			gsl::czstring filename,
 			gsl::span<const unsigned int> indices,
@@ -57,26 +42,105 @@ namespace sandbox {
 			}
 		}
 
-		vector3 map_index(gsl::span<const vector3> values, std::size_t index) noexcept
+		struct import_options {
+			gsl::czstring input;
+			gsl::czstring output;
+			bool mapped;
+			bool optimize_cache;
+			bool optimize_overdraw;
+			bool optimize_fetch;
+			bool compact;
+			bool meshlets;
+			meshlet_limits meshlet_size;
+			unsigned int thread_count;
+		};
+
+		std::optional<unsigned int> parse_count(std::string_view text) noexcept
 		{
-			constexpr auto sentinel = std::numeric_limits<std::size_t>::max();
-			return (index == sentinel || index >= values.size()) ? vector3 {1.0f} : values[index];
+			unsigned int value {};
+			const auto last = std::next(text.data(), text.size());
+			const auto [end, error] = std::from_chars(text.data(), last, value);
+			if (error != std::errc {} || end != last)
+				return {};
+
+			return value;
 		}
-	}
-}
 
-namespace std {
-	template <>
-	struct hash<sandbox::vertex> {
-		std::size_t operator()(const sandbox::vertex& v) const noexcept
+		std::optional<import_options> parse_arguments(gsl::span<char*> arguments)
 		{
-			std::uint64_t hash = 0xffffffff;
-			hash = _mm_crc32_u64(hash, v.position);
-			hash = _mm_crc32_u64(hash, v.texture);
-			hash = _mm_crc32_u64(hash, v.normal);
-			return hash;
+			import_options options {
+				.meshlet_size {default_meshlet_limits},
+				.thread_count {std::max(std::thread::hardware_concurrency(), 1u)}};
+
+			std::vector<gsl::czstring> positional {};
+			for (auto argument = std::next(arguments.begin()); argument != arguments.end(); ++argument) {
+				const std::string_view name {*argument};
+				if (name == "--mapped") {
+					options.mapped = true;
+				}
+				else if (name == "--optimize-cache") {
+					options.optimize_cache = true;
+				}
+				else if (name == "--optimize-overdraw") {
+					options.optimize_overdraw = true;
+				}
+				else if (name == "--optimize-fetch") {
+					options.optimize_fetch = true;
+				}
+				else if (name == "--compact") {
+					options.compact = true;
+				}
+				else if (name == "--meshlets") {
+					options.meshlets = true;
+				}
+				else if (name == "--meshlet-vertices") {
+					if (++argument == arguments.end())
+						return {};
+
+					const auto vertex_count = parse_count(*argument);
+					if (!vertex_count || *vertex_count < 3 || *vertex_count > max_meshlet_size)
+						return {};
+
+					options.meshlets = true;
+					options.meshlet_size.max_vertices = *vertex_count;
+				}
+				else if (name == "--meshlet-triangles") {
+					if (++argument == arguments.end())
+						return {};
+
+					const auto triangle_count = parse_count(*argument);
+					if (!triangle_count || *triangle_count == 0 || *triangle_count > max_meshlet_size)
+						return {};
+
+					options.meshlets = true;
+					options.meshlet_size.max_triangles = *triangle_count;
+				}
+				else if (name == "--threads") {
+					if (++argument == arguments.end())
+						return {};
+
+					const auto thread_count = parse_count(*argument);
+					if (!thread_count || *thread_count == 0)
+						return {};
+
+					options.thread_count = *thread_count;
+				}
+				else if (name.starts_with("--")) {
+					return {};
+				}
+				else {
+					positional.push_back(*argument);
+				}
+			}
+
+			if (positional.size() != 2)
+				return {};
+
+			options.input = positional.at(0);
+			options.output = positional.at(1);
+			return options;
 		}
-	};
+	}
 }
 
 int main(int argc, char** argv)
@@ -84,34 +148,159 @@ int main(int argc, char** argv)
 	using namespace sandbox;
 
 	const gsl::span arguments {argv, gsl::narrow_cast<std::size_t>(argc)};
-	if (argc < 3) {
-		std::cout << "Usage: import <*.obj> <output>\n";
+	const auto options = parse_arguments(arguments);
+	if (!options) {
+		std::cout << "Usage: import [--mapped] [--threads <count>] [--optimize-cache] [--optimize-overdraw] "
+					 "[--optimize-fetch] [--compact] [--meshlets] [--meshlet-vertices <count>] "
+					 "[--meshlet-triangles <count>] <*.obj> <output>\n";
+
+		std::cout << "\t--mapped\tmemory-map the input and parse it concurrently\n";
+		std::cout << "\t--threads\tthreads used for parsing, repacking and building meshlets (default: all cores)\n";
+		std::cout << "\t--optimize-cache\treorder triangles for post-transform vertex cache reuse\n";
+		std::cout << "\t--optimize-overdraw\treorder triangle clusters so that likely occluders are drawn first\n";
+		std::cout << "\t--optimize-fetch\trenumber vertices in order of first use\n";
+		std::cout << "\t--compact\tquantize vertices to " << sizeof(compact_vertex_data) << " bytes\n";
+		std::cout << "\t--meshlets\tgroup triangles into meshlets for mesh shaders, with bounding spheres and normal "
+					 "cones\n";
+
+		std::cout << "\t--meshlet-vertices\tmost vertices per meshlet, up to " << max_meshlet_size
+				  << " (default: " << default_meshlet_limits.max_vertices << "; implies --meshlets)\n";
+
+		std::cout << "\t--meshlet-triangles\tmost triangles per meshlet, up to " << max_meshlet_size
+				  << " (default: " << default_meshlet_limits.max_triangles << "; implies --meshlets)\n";
+
 		return 1;
 	}
 
-	const auto object = load_wavefront(arguments[1]);
+	// The main thread executes jobs while it waits, so it counts as one of the threads
+	job_system jobs {options->thread_count - 1};
+	const auto object = options->mapped ? load_wavefront_mapped(options->input, jobs) : load_wavefront(options->input);
+
 	std::cout << "Found:\n\t" << object.faces.size() << " vertices,\n";
 	std::cout << "\t" << object.positions.size() << " posiitons\n";
 	std::cout << "\t" << object.textures.size() << " textures\n";
 	std::cout << "\t" << object.normals.size() << " normals\n";
 
-	std::unordered_map<vertex, unsigned int> index_map;
-	std::vector<vertex_data> vertices;
-	std::vector<unsigned int> indices;
-	for (const auto& vertex : object.faces) {
-		const auto& [iterator, inserted] = index_map.insert({vertex, gsl::narrow_cast<unsigned int>(vertices.size())});
-		if (inserted) {
-			indices.emplace_back(iterator->second);
-			vertices.emplace_back(vertex_data {
-				.position {map_index(object.positions, vertex.position)},
-				.texture_coord {map_index(object.textures, vertex.texture)},
-				.normal {map_index(object.normals, vertex.normal)}});
+	auto [indices, vertices] = repack(object, jobs);
+	std::cout << "Repacked " << indices.size() << " indices and " << vertices.size() << " vertices\n";
+	if (options->optimize_cache) {
+		constexpr std::size_t reported_cache_size {32};
+		const auto before = analyze_vertex_cache(indices, vertices.size(), reported_cache_size);
+		optimize_vertex_cache(indices, vertices.size());
+		const auto after = analyze_vertex_cache(indices, vertices.size(), reported_cache_size);
+		std::cout << "Vertex cache (" << reported_cache_size << " entries):\n";
+		std::cout << "\tACMR " << before.acmr << " -> " << after.acmr << "\n";
+		std::cout << "\tATVR " << before.atvr << " -> " << after.atvr << "\n";
+	}
+
+	if (options->optimize_overdraw) {
+		constexpr auto acmr_threshold = 1.05f;
+		const auto before = analyze_overdraw(indices, vertices);
+		optimize_overdraw(indices, vertices, acmr_threshold);
+		const auto after = analyze_overdraw(indices, vertices);
+		std::cout << "Overdraw (pixels shaded per pixel covered): " << before.overdraw << " -> " << after.overdraw
+				  << "\n";
+	}
+
+	if (options->optimize_fetch) {
+		// Measured with the stride that is actually written out
+		constexpr std::size_t reported_line_count {256};
+		const auto stride = options->compact ? sizeof(compact_vertex_data) : sizeof(vertex_data);
+		const auto before = analyze_vertex_fetch(indices, vertices.size(), stride, reported_line_count);
+		optimize_vertex_fetch(indices, vertices);
+		const auto after = analyze_vertex_fetch(indices, vertices.size(), stride, reported_line_count);
+		std::cout << "Vertex fetch (" << reported_line_count << " cache lines):\n";
+		std::cout << "\tbytes per triangle " << before.bytes_per_triangle << " -> " << after.bytes_per_triangle << "\n";
+		std::cout << "\toverfetch " << before.overfetch << " -> " << after.overfetch << "\n";
+	}
+
+	const auto mesh = split_submeshes(indices, vertices);
+	std::cout << "Split into " << mesh.submeshes.size() << " submeshes with 16-bit indices, duplicating "
+			  << mesh.vertices.size() - vertices.size() << " vertices\n";
+
+	std::vector<section_source> sections {
+		{section_type::submeshes, 0, sizeof(submesh), gsl::as_bytes(gsl::span {mesh.submeshes})},
+		{section_type::indices,
+		 static_cast<std::uint32_t>(index_format::uint16),
+		 sizeof(std::uint16_t),
+		 gsl::as_bytes(gsl::span {mesh.indices})}};
+
+	compressed_vertices compressed {};
+	if (options->compact) {
+		compressed = compress_vertices(mesh.vertices);
+		const auto error = measure_compression_error(mesh.vertices, compressed);
+		std::cout << "Compacted vertices from " << sizeof(vertex_data) << " to " << sizeof(compact_vertex_data)
+				  << " bytes, round-trip error:\n";
+
+		std::cout << "\tposition " << error.position << "\n";
+		std::cout << "\ttexture coordinate " << error.texture_coord << "\n";
+		std::cout << "\tnormal " << error.normal << " degrees\n";
+
+		sections.push_back(
+			{section_type::vertices,
+			 static_cast<std::uint32_t>(vertex_format::compact),
+			 sizeof(compact_vertex_data),
+			 gsl::as_bytes(gsl::span {compressed.vertices})});
+	}
+	else {
+		sections.push_back(
+			{section_type::vertices,
+			 static_cast<std::uint32_t>(vertex_format::full),
+			 sizeof(vertex_data),
+			 gsl::as_bytes(gsl::span {mesh.vertices})});
+	}
+
+	meshlet_mesh meshlets {};
+	if (options->meshlets) {
+		// Bounded by the positions the shaders will decode, which may have been quantized
+		std::vector<vector3> positions(mesh.vertices.size());
+		if (options->compact) {
+			std::transform(
+				compressed.vertices.begin(),
+				compressed.vertices.end(),
+				positions.begin(),
+				[&bounds = compressed.bounds](const compact_vertex_data& vertex) {
+					return decompress_vertex(vertex, bounds).position;
+				});
 		}
 		else {
-			indices.push_back(iterator->second);
+			std::transform(
+				mesh.vertices.begin(),
+				mesh.vertices.end(),
+				positions.begin(),
+				[](const vertex_data& vertex) { return vertex.position; });
 		}
+
+		const auto& limits = options->meshlet_size;
+		meshlets = build_meshlets(mesh.submeshes, mesh.indices, positions, limits, jobs);
+
+		const auto meshlet_count = gsl::narrow_cast<float>(std::max(meshlets.meshlets.size(), std::size_t {1}));
+		const auto cone_count = std::count_if(meshlets.meshlets.begin(), meshlets.meshlets.end(), [](const meshlet& m) {
+			return m.cone_cutoff < 1.0f;
+		});
+
+		std::cout << "Built " << meshlets.meshlets.size() << " meshlets of at most " << limits.max_vertices
+				  << " vertices and " << limits.max_triangles << " triangles:\n";
+
+		std::cout << "\t" << meshlets.vertices.size() / meshlet_count << " vertices on average\n";
+		std::cout << "\t" << meshlets.triangles.size() / meshlet_count << " triangles on average\n";
+		std::cout << "\t" << cone_count << " with a normal cone\n";
+
+		sections.push_back(
+			{section_type::meshlets, 0, sizeof(meshlet), gsl::as_bytes(gsl::span {meshlets.meshlets})});
+
+		sections.push_back(
+			{section_type::meshlet_vertices,
+			 0,
+			 sizeof(std::uint32_t),
+			 gsl::as_bytes(gsl::span {meshlets.vertices})});
+
+		sections.push_back(
+			{section_type::meshlet_triangles,
+			 0,
+			 sizeof(std::uint32_t),
+			 gsl::as_bytes(gsl::span {meshlets.triangles})});
 	}
 
-	std::cout << "Repacked " << indices.size() << " indices and " << vertices.size() << " vertices\n";
-	write_streams(arguments[2], indices, vertices);
+	write_streams(options->output, compressed.bounds, sections);
 }
@@ -0,0 +1,491 @@
+#include "pch.h"
+
+#include "mesh_optimizer.h"
+
+namespace sandbox {
+	namespace {
+		constexpr std::size_t modelled_cache_size {32};
+		constexpr std::size_t max_scored_valence {32};
+		constexpr auto no_triangle = std::numeric_limits<unsigned int>::max();
+
+		// Scores are tabulated once; positions beyond the modelled cache, and valences beyond the table, are clamped
+		struct score_tables {
+			std::array<float, modelled_cache_size + 1> cache_position;
+			std::array<float, max_scored_valence + 1> valence;
+		};
+
+		score_tables compute_score_tables() noexcept
+		{
+			constexpr auto cache_decay_power = 1.5f;
+			constexpr auto last_triangle_score = 0.75f;
+			constexpr auto valence_boost_scale = 2.0f;
+			constexpr auto valence_boost_power = 0.5f;
+
+			score_tables tables {};
+			for (std::size_t i {}; i < modelled_cache_size; ++i) {
+				// The vertices of the triangle just emitted are scored equally, regardless of their order
+				if (i < 3) {
+					tables.cache_position.at(i) = last_triangle_score;
+				}
+				else {
+					const auto distance = gsl::narrow_cast<float>(i - 3) / (modelled_cache_size - 3);
+					tables.cache_position.at(i) = std::pow(1.0f - distance, cache_decay_power);
+				}
+			}
+
+			for (std::size_t i {1}; i <= max_scored_valence; ++i) {
+				tables.valence.at(i)
+					= valence_boost_scale * std::pow(gsl::narrow_cast<float>(i), -valence_boost_power);
+			}
+
+			return tables;
+		}
+
+		// Vertices without remaining triangles never contribute to a triangle's score
+		float score_vertex(const score_tables& tables, std::size_t cache_position, unsigned int valence) noexcept
+		{
+			if (valence == 0)
+				return -1.0f;
+
+			return tables.cache_position.at(std::min(cache_position, modelled_cache_size))
+				+ tables.valence.at(std::min<std::size_t>(valence, max_scored_valence));
+		}
+
+		// Counts the misses a triangle causes in a FIFO cache, using the timestamp scheme of analyze_vertex_cache()
+		class fifo_cache {
+		public:
+			fifo_cache(std::size_t entry_count, std::size_t capacity) :
+				m_load_times(entry_count),
+				m_time {capacity + 1},
+				m_capacity {capacity}
+			{
+			}
+
+			bool access(std::size_t entry)
+			{
+				auto& load_time = m_load_times.at(entry);
+				if (m_time - load_time <= m_capacity)
+					return false;
+
+				load_time = m_time++;
+				return true;
+			}
+
+			void flush() noexcept { m_time += m_capacity + 1; }
+
+		private:
+			std::vector<std::size_t> m_load_times;
+			std::size_t m_time;
+			std::size_t m_capacity;
+		};
+
+		std::size_t count_misses(fifo_cache& cache, gsl::span<const unsigned int> indices, std::size_t triangle)
+		{
+			return std::size_t {cache.access(indices[triangle * 3])} + cache.access(indices[triangle * 3 + 1])
+				+ cache.access(indices[triangle * 3 + 2]);
+		}
+
+		vector3 operator+(const vector3& a, const vector3& b) noexcept { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+		vector3 operator-(const vector3& a, const vector3& b) noexcept { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+		vector3 operator*(const vector3& a, float b) noexcept { return {a.x * b, a.y * b, a.z * b}; }
+		float dot(const vector3& a, const vector3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+		vector3 cross(const vector3& a, const vector3& b) noexcept
+		{
+			return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+		}
+
+		// Screen-space axes (right, up) and view direction, for a left-handed view with clockwise front faces
+		struct view_axes {
+			vector3 right;
+			vector3 up;
+			vector3 forward;
+		};
+
+		constexpr std::array<view_axes, 6> overdraw_views {
+			view_axes {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}},
+			view_axes {{-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}},
+			view_axes {{0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+			view_axes {{0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}},
+			view_axes {{-1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}},
+			view_axes {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, 0.0f}},
+		};
+
+		constexpr std::size_t overdraw_resolution {256};
+
+		struct raster_counts {
+			std::size_t shaded;
+			std::size_t covered;
+		};
+
+		raster_counts rasterize(
+			gsl::span<const unsigned int> indices,
+			gsl::span<const vertex_data> vertices,
+			const view_axes& view)
+		{
+			std::vector<vector3> projected(vertices.size());
+			vector3 minimum {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 0.0f};
+			vector3 maximum {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), 0.0f};
+			for (std::size_t i {}; i < vertices.size(); ++i) {
+				const auto& position = vertices[i].position;
+				auto& point = projected[i];
+				point = {dot(position, view.right), dot(position, view.up), dot(position, view.forward)};
+
+				minimum = {std::min(minimum.x, point.x), std::min(minimum.y, point.y), 0.0f};
+				maximum = {std::max(maximum.x, point.x), std::max(maximum.y, point.y), 0.0f};
+			}
+
+			// A uniform scale keeps the mesh's proportions
+			const auto extent
+				= std::max({maximum.x - minimum.x, maximum.y - minimum.y, std::numeric_limits<float>::min()});
+
+			const auto scale = (overdraw_resolution - 1) / extent;
+			for (auto& point : projected)
+				point = {(point.x - minimum.x) * scale, (point.y - minimum.y) * scale, point.z};
+
+			std::vector<float> depth(overdraw_resolution * overdraw_resolution, std::numeric_limits<float>::max());
+			raster_counts counts {};
+			for (std::size_t i {}; i + 2 < indices.size(); i += 3) {
+				const auto& a = projected.at(indices[i]);
+				const auto& b = projected.at(indices[i + 1]);
+				const auto& c = projected.at(indices[i + 2]);
+
+				// Twice the signed area, which is negative for triangles that wind clockwise as seen by the viewer
+				const auto area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+				if (area >= 0.0f)
+					continue;
+
+				const auto first_x = gsl::narrow_cast<std::size_t>(std::floor(std::min({a.x, b.x, c.x})));
+				const auto first_y = gsl::narrow_cast<std::size_t>(std::floor(std::min({a.y, b.y, c.y})));
+				const auto last_x = std::min(
+					gsl::narrow_cast<std::size_t>(std::ceil(std::max({a.x, b.x, c.x}))),
+					overdraw_resolution - 1);
+
+				const auto last_y = std::min(
+					gsl::narrow_cast<std::size_t>(std::ceil(std::max({a.y, b.y, c.y}))),
+					overdraw_resolution - 1);
+
+				for (auto y = first_y; y <= last_y; ++y) {
+					for (auto x = first_x; x <= last_x; ++x) {
+						const auto px = gsl::narrow_cast<float>(x) + 0.5f;
+						const auto py = gsl::narrow_cast<float>(y) + 0.5f;
+						const auto wa = ((b.x - px) * (c.y - py) - (c.x - px) * (b.y - py)) / area;
+						const auto wb = ((c.x - px) * (a.y - py) - (a.x - px) * (c.y - py)) / area;
+						const auto wc = 1.0f - wa - wb;
+						if (wa < 0.0f || wb < 0.0f || wc < 0.0f)
+							continue;
+
+						auto& stored = depth.at(y * overdraw_resolution + x);
+						const auto z = wa * a.z + wb * b.z + wc * c.z;
+						if (z < stored) {
+							if (stored == std::numeric_limits<float>::max())
+								++counts.covered;
+
+							stored = z;
+							++counts.shaded;
+						}
+					}
+				}
+			}
+
+			return counts;
+		}
+	}
+}
+
+sandbox::vertex_cache_statistics sandbox::analyze_vertex_cache(
+	gsl::span<const unsigned int> indices,
+	std::size_t vertex_count,
+	std::size_t cache_size)
+{
+	// A vertex is still cached if fewer than cache_size misses have occurred since it was loaded
+	std::vector<std::size_t> load_times(vertex_count);
+	auto time = cache_size + 1;
+	std::size_t misses {};
+	for (const auto index : indices) {
+		auto& load_time = load_times.at(index);
+		if (time - load_time > cache_size) {
+			load_time = time++;
+			++misses;
+		}
+	}
+
+	const auto triangle_count = indices.size() / 3;
+	return {
+		.acmr {triangle_count ? gsl::narrow_cast<double>(misses) / triangle_count : 0.0},
+		.atvr {vertex_count ? gsl::narrow_cast<double>(misses) / vertex_count : 0.0}};
+}
+
+void sandbox::optimize_vertex_cache(gsl::span<unsigned int> indices, std::size_t vertex_count)
+{
+	static const auto tables = compute_score_tables();
+	const auto triangle_count = indices.size() / 3;
+
+	// Per-vertex lists of triangles yet to be emitted; a vertex's list is its first `valences[v]` entries
+	std::vector<unsigned int> valences(vertex_count);
+	for (const auto index : indices)
+		++valences.at(index);
+
+	std::vector<std::size_t> adjacency_offsets(vertex_count + 1);
+	std::inclusive_scan(
+		valences.begin(),
+		valences.end(),
+		std::next(adjacency_offsets.begin()),
+		std::plus<std::size_t> {});
+
+	std::vector<unsigned int> adjacency(indices.size());
+	{
+		auto cursors = adjacency_offsets;
+		for (std::size_t i {}; i < indices.size(); ++i)
+			adjacency.at(cursors.at(indices[i])++) = gsl::narrow_cast<unsigned int>(i / 3);
+	}
+
+	std::vector<std::size_t> cache_positions(vertex_count, modelled_cache_size);
+	std::vector<float> vertex_scores(vertex_count);
+	for (std::size_t v {}; v < vertex_count; ++v)
+		vertex_scores[v] = score_vertex(tables, modelled_cache_size, valences[v]);
+
+	const auto score_triangle = [&](std::size_t triangle) {
+		return vertex_scores.at(indices[triangle * 3]) + vertex_scores.at(indices[triangle * 3 + 1])
+			+ vertex_scores.at(indices[triangle * 3 + 2]);
+	};
+
+	std::vector<bool> emitted(triangle_count);
+	auto best_triangle = no_triangle;
+	auto best_score = 0.0f;
+	for (std::size_t t {}; t < triangle_count; ++t) {
+		const auto score = score_triangle(t);
+		if (best_triangle == no_triangle || score > best_score) {
+			best_triangle = gsl::narrow_cast<unsigned int>(t);
+			best_score = score;
+		}
+	}
+
+	std::vector<unsigned int> output {};
+	output.reserve(triangle_count * 3);
+	std::vector<unsigned int> cache {};
+	std::vector<unsigned int> next_cache {};
+	std::size_t next_unemitted {};
+	while (output.size() < triangle_count * 3) {
+		// With nothing in the cache left to draw from, continue with the earliest remaining triangle
+		if (best_triangle == no_triangle) {
+			while (emitted.at(next_unemitted))
+				++next_unemitted;
+
+			best_triangle = gsl::narrow_cast<unsigned int>(next_unemitted);
+		}
+
+		emitted.at(best_triangle) = true;
+		next_cache.clear();
+		for (std::size_t corner {}; corner < 3; ++corner) {
+			const auto v = indices[best_triangle * 3 + corner];
+			output.push_back(v);
+			if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+				next_cache.push_back(v);
+
+			const auto first = std::next(adjacency.begin(), adjacency_offsets[v]);
+			const auto last = std::next(first, valences[v]);
+			const auto entry = std::find(first, last, best_triangle);
+			if (entry != last) {
+				std::iter_swap(entry, std::prev(last));
+				--valences[v];
+			}
+		}
+
+		for (const auto v : cache) {
+			if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+				next_cache.push_back(v);
+		}
+
+		for (std::size_t i {}; i < next_cache.size(); ++i) {
+			const auto v = next_cache[i];
+			cache_positions[v] = std::min(i, modelled_cache_size);
+			vertex_scores[v] = score_vertex(tables, cache_positions[v], valences[v]);
+		}
+
+		// Only triangles touching the cache can have changed score
+		best_triangle = no_triangle;
+		best_score = 0.0f;
+		for (const auto v : next_cache) {
+			const auto first = std::next(adjacency.begin(), adjacency_offsets[v]);
+			for (auto triangle = first; triangle != std::next(first, valences[v]); ++triangle) {
+				const auto score = score_triangle(*triangle);
+				if (cache_positions[v] < modelled_cache_size && score > best_score) {
+					best_triangle = *triangle;
+					best_score = score;
+				}
+			}
+		}
+
+		if (next_cache.size() > modelled_cache_size)
+			next_cache.resize(modelled_cache_size);
+
+		std::swap(cache, next_cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+sandbox::vertex_fetch_statistics sandbox::analyze_vertex_fetch(
+	gsl::span<const unsigned int> indices,
+	std::size_t vertex_count,
+	std::size_t vertex_size,
+	std::size_t line_count)
+{
+	constexpr std::size_t line_size {64};
+	const auto buffer_size = vertex_count * vertex_size;
+	fifo_cache cache {(buffer_size + line_size - 1) / line_size, line_count};
+	std::size_t misses {};
+	for (const auto index : indices) {
+		const auto first_byte = index * vertex_size;
+		const auto last_byte = first_byte + vertex_size - 1;
+		for (auto line = first_byte / line_size; line <= last_byte / line_size; ++line)
+			misses += cache.access(line);
+	}
+
+	const auto bytes = gsl::narrow_cast<double>(misses * line_size);
+	const auto triangle_count = indices.size() / 3;
+	return {
+		.bytes_per_triangle {triangle_count ? bytes / triangle_count : 0.0},
+		.overfetch {buffer_size ? bytes / buffer_size : 0.0}};
+}
+
+void sandbox::optimize_vertex_fetch(gsl::span<unsigned int> indices, std::vector<vertex_data>& vertices)
+{
+	constexpr auto unused = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> remap(vertices.size(), unused);
+	std::vector<vertex_data> reordered {};
+	reordered.reserve(vertices.size());
+	for (auto& index : indices) {
+		auto& new_index = remap.at(index);
+		if (new_index == unused) {
+			new_index = gsl::narrow_cast<unsigned int>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+
+		index = new_index;
+	}
+
+	vertices = std::move(reordered);
+}
+
+sandbox::overdraw_statistics
+sandbox::analyze_overdraw(gsl::span<const unsigned int> indices, gsl::span<const vertex_data> vertices)
+{
+	raster_counts total {};
+	for (const auto& view : overdraw_views) {
+		const auto counts = rasterize(indices, vertices, view);
+		total.shaded += counts.shaded;
+		total.covered += counts.covered;
+	}
+
+	return {.overdraw {total.covered ? gsl::narrow_cast<double>(total.shaded) / total.covered : 0.0}};
+}
+
+void sandbox::optimize_overdraw(
+	gsl::span<unsigned int> indices,
+	gsl::span<const vertex_data> vertices,
+	float threshold)
+{
+	constexpr std::size_t modelled_fifo_size {16};
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return;
+
+	// Hard boundaries fall where the cache optimizer started afresh: triangles that miss on all three vertices
+	fifo_cache cache {vertices.size(), modelled_fifo_size};
+	std::vector<std::size_t> hard_boundaries {};
+	for (std::size_t t {}; t < triangle_count; ++t) {
+		if (count_misses(cache, indices, t) == 3)
+			hard_boundaries.push_back(t);
+	}
+
+	hard_boundaries.push_back(triangle_count);
+
+	// Soft boundaries split each hard cluster wherever its running ACMR is within `threshold` of the cluster's
+	std::vector<std::size_t> boundaries {};
+	for (std::size_t i {}; i + 1 < hard_boundaries.size(); ++i) {
+		const auto first = hard_boundaries[i];
+		const auto last = hard_boundaries[i + 1];
+		cache.flush();
+		std::size_t cluster_misses {};
+		for (auto t = first; t < last; ++t)
+			cluster_misses += count_misses(cache, indices, t);
+
+		const auto cluster_threshold = threshold * gsl::narrow_cast<float>(cluster_misses) / (last - first);
+		boundaries.push_back(first);
+		cache.flush();
+		auto cluster_first = first;
+		std::size_t misses {};
+		for (auto t = first; t < last; ++t) {
+			misses += count_misses(cache, indices, t);
+			if (t + 1 < last && misses <= (t + 1 - cluster_first) * cluster_threshold) {
+				cluster_first = t + 1;
+				boundaries.push_back(cluster_first);
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+
+	boundaries.push_back(triangle_count);
+
+	// Clusters that face away from the mesh's centroid are likely to occlude the rest, and so are drawn first
+	struct cluster {
+		std::size_t first;
+		std::size_t last;
+		vector3 centroid;
+		vector3 normal;
+		float sort_key;
+	};
+
+	std::vector<cluster> clusters {};
+	vector3 mesh_centroid {};
+	auto mesh_area = 0.0f;
+	for (std::size_t i {}; i + 1 < boundaries.size(); ++i) {
+		cluster current {.first {boundaries[i]}, .last {boundaries[i + 1]}};
+		auto area = 0.0f;
+		for (auto t = current.first; t < current.last; ++t) {
+			const auto& a = vertices[indices[t * 3]].position;
+			const auto& b = vertices[indices[t * 3 + 1]].position;
+			const auto& c = vertices[indices[t * 3 + 2]].position;
+			// Front faces wind clockwise in a left-handed space, so this is the outward normal
+			const auto normal = cross(b - a, c - a);
+			const auto triangle_area = std::sqrt(dot(normal, normal)) * 0.5f;
+			current.centroid = current.centroid + (a + b + c) * (triangle_area / 3.0f);
+			current.normal = current.normal + normal;
+			area += triangle_area;
+		}
+
+		mesh_centroid = mesh_centroid + current.centroid;
+		mesh_area += area;
+		if (area > 0.0f)
+			current.centroid = current.centroid * (1.0f / area);
+
+		clusters.push_back(current);
+	}
+
+	if (mesh_area > 0.0f)
+		mesh_centroid = mesh_centroid * (1.0f / mesh_area);
+
+	for (auto& current : clusters) {
+		const auto normal_length = std::sqrt(dot(current.normal, current.normal));
+		if (normal_length > 0.0f)
+			current.sort_key = dot(current.centroid - mesh_centroid, current.normal) / normal_length;
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const cluster& a, const cluster& b) {
+		return a.sort_key > b.sort_key;
+	});
+
+	std::vector<unsigned int> output {};
+	output.reserve(indices.size());
+	for (const auto& current : clusters) {
+		output.insert(
+			output.end(),
+			std::next(indices.begin(), current.first * 3),
+			std::next(indices.begin(), current.last * 3));
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
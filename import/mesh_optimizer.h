@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/stream_format.h"
+
+namespace sandbox {
+	struct vertex_cache_statistics {
+		double acmr; // Average cache miss ratio: transformed vertices per triangle
+		double atvr; // Average transform to vertex ratio: transformed vertices per unique vertex
+	};
+
+	// Simulates a FIFO post-transform cache of `cache_size` entries
+	vertex_cache_statistics
+	analyze_vertex_cache(gsl::span<const unsigned int> indices, std::size_t vertex_count, std::size_t cache_size);
+
+	// Reorders triangles for post-transform cache reuse, after Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	void optimize_vertex_cache(gsl::span<unsigned int> indices, std::size_t vertex_count);
+
+	struct vertex_fetch_statistics {
+		double bytes_per_triangle; // Bytes read from the vertex buffer per triangle
+		double overfetch; // Bytes read from the vertex buffer per byte of vertex data
+	};
+
+	// Simulates a FIFO cache of `line_count` 64-byte lines in front of a buffer of `vertex_size`-byte vertices
+	vertex_fetch_statistics analyze_vertex_fetch(
+		gsl::span<const unsigned int> indices,
+		std::size_t vertex_count,
+		std::size_t vertex_size,
+		std::size_t line_count);
+
+	// Renumbers vertices in order of first use by the index stream, so that fetches walk the vertex buffer forward
+	void optimize_vertex_fetch(gsl::span<unsigned int> indices, std::vector<vertex_data>& vertices);
+
+	struct overdraw_statistics {
+		double overdraw; // Pixels shaded per pixel covered
+	};
+
+	// Rasterizes the mesh with back-face culling and a depth test from each of the six axis-aligned directions
+	overdraw_statistics analyze_overdraw(gsl::span<const unsigned int> indices, gsl::span<const vertex_data> vertices);
+
+	// Splits a cache-optimized index stream into clusters wherever doing so costs at most a factor of `threshold` in
+	// ACMR, then draws outward-facing clusters first, after Sander et al.'s "Fast Triangle Reordering for Vertex
+	// Locality and Reduced Overdraw"
+	void optimize_overdraw(
+		gsl::span<unsigned int> indices,
+		gsl::span<const vertex_data> vertices,
+		float threshold);
+}
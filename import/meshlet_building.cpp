@@ -0,0 +1,219 @@
+#include "pch.h"
+
+#include "meshlet_building.h"
+
+namespace sandbox {
+	namespace {
+		// Submesh indices are 16-bit
+		constexpr std::size_t submesh_vertex_count {std::numeric_limits<std::uint16_t>::max() + 1};
+
+		// The last meshlet of each run may be cut short, so runs are long enough for that to rarely matter
+		constexpr std::size_t run_triangle_count {1 << 14};
+
+		struct triangle_run {
+			std::size_t submesh;
+			std::size_t first; // In triangles from the start of the submesh
+			std::size_t last;
+		};
+
+		// Which meshlet last used each vertex of a submesh, and its index within that meshlet; meshlets are numbered
+		// from one, so that the map never needs clearing
+		struct vertex_map {
+			std::vector<std::uint32_t> owners;
+			std::vector<std::uint8_t> local_indices;
+			std::uint32_t current;
+		};
+
+		vector3 operator+(const vector3& a, const vector3& b) noexcept { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+		vector3 operator-(const vector3& a, const vector3& b) noexcept { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+		vector3 operator*(const vector3& a, float b) noexcept { return {a.x * b, a.y * b, a.z * b}; }
+		float dot(const vector3& a, const vector3& b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+		float get_length(const vector3& a) noexcept { return std::sqrt(dot(a, a)); }
+
+		vector3 cross(const vector3& a, const vector3& b) noexcept
+		{
+			return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+		}
+
+		std::uint32_t get_corner(std::uint32_t triangle, std::size_t corner) noexcept
+		{
+			return (triangle >> (corner * 8)) & 0xff;
+		}
+
+		// Front faces wind clockwise in a left-handed space, so this points out of the front face
+		vector3 get_face_normal(
+			std::uint32_t triangle,
+			gsl::span<const std::uint32_t> vertices,
+			gsl::span<const vector3> positions)
+		{
+			const auto& a = positions[vertices[get_corner(triangle, 0)]];
+			const auto& b = positions[vertices[get_corner(triangle, 1)]];
+			const auto& c = positions[vertices[get_corner(triangle, 2)]];
+			return cross(b - a, c - a);
+		}
+
+		// The sphere is centered on the vertices' bounding box. The cone's axis averages the unit normals of the
+		// triangles, ignoring degenerate ones, and its cutoff is the sine of the widest angle between the axis and a
+		// normal; once that angle reaches 90 degrees no viewer sees only back faces, so the meshlet gets no cone.
+		void bound_meshlet(
+			meshlet& bounded,
+			gsl::span<const std::uint32_t> vertices,
+			gsl::span<const std::uint32_t> triangles,
+			gsl::span<const vector3> positions)
+		{
+			auto minimum = positions[vertices.front()];
+			auto maximum = minimum;
+			for (const auto vertex : vertices) {
+				const auto& [x, y, z] = positions[vertex];
+				minimum = {std::min(minimum.x, x), std::min(minimum.y, y), std::min(minimum.z, z)};
+				maximum = {std::max(maximum.x, x), std::max(maximum.y, y), std::max(maximum.z, z)};
+			}
+
+			bounded.center = (minimum + maximum) * 0.5f;
+			bounded.radius = 0.0f;
+			for (const auto vertex : vertices)
+				bounded.radius = std::max(bounded.radius, get_length(positions[vertex] - bounded.center));
+
+			bounded.cone_axis = {};
+			bounded.cone_cutoff = 1.0f;
+			vector3 normal_sum {};
+			for (const auto triangle : triangles) {
+				const auto normal = get_face_normal(triangle, vertices, positions);
+				const auto length = get_length(normal);
+				if (length > 0.0f)
+					normal_sum = normal_sum + normal * (1.0f / length);
+			}
+
+			const auto sum_length = get_length(normal_sum);
+			if (!(sum_length > 0.0f))
+				return;
+
+			const auto axis = normal_sum * (1.0f / sum_length);
+			auto min_dot = 1.0f;
+			for (const auto triangle : triangles) {
+				const auto normal = get_face_normal(triangle, vertices, positions);
+				const auto length = get_length(normal);
+				if (length > 0.0f)
+					min_dot = std::min(min_dot, dot(normal, axis) / length);
+			}
+
+			if (!(min_dot > 0.0f))
+				return;
+
+			bounded.cone_axis = axis;
+			bounded.cone_cutoff = std::sqrt(1.0f - std::min(min_dot * min_dot, 1.0f));
+		}
+
+		// Meshlets are numbered from the start of the run
+		void build_run(
+			const triangle_run& run,
+			gsl::span<const submesh> submeshes,
+			gsl::span<const std::uint16_t> indices,
+			const meshlet_limits& limits,
+			vertex_map& map,
+			meshlet_mesh& built)
+		{
+			const auto& [first_index, index_count, base_vertex] = submeshes[run.submesh];
+			const auto start_meshlet = [&map, &built] {
+				++map.current;
+				built.meshlets.push_back(
+					{.first_vertex {gsl::narrow<std::uint32_t>(built.vertices.size())},
+					 .vertex_count {},
+					 .first_triangle {gsl::narrow<std::uint32_t>(built.triangles.size())},
+					 .triangle_count {},
+					 .center {},
+					 .radius {},
+					 .cone_axis {},
+					 .cone_cutoff {}});
+			};
+
+			start_meshlet();
+			for (auto triangle = run.first; triangle < run.last; ++triangle) {
+				const auto corners = indices.subspan(first_index + triangle * 3, 3);
+				const auto a = corners[0];
+				const auto b = corners[1];
+				const auto c = corners[2];
+				const auto is_new = [&map](std::uint16_t corner) { return map.owners[corner] != map.current; };
+				const auto new_count = is_new(a) + (is_new(b) && b != a) + (is_new(c) && c != a && c != b);
+				const auto& last = built.meshlets.back();
+				if (last.vertex_count + new_count > limits.max_vertices || last.triangle_count == limits.max_triangles)
+					start_meshlet();
+
+				auto& current = built.meshlets.back();
+				std::uint32_t packed {};
+				for (std::size_t i {}; i < corners.size(); ++i) {
+					const auto corner = corners[i];
+					if (map.owners[corner] != map.current) {
+						map.owners[corner] = map.current;
+						map.local_indices[corner] = gsl::narrow_cast<std::uint8_t>(current.vertex_count++);
+						built.vertices.push_back(gsl::narrow<std::uint32_t>(base_vertex + corner));
+					}
+
+					packed |= std::uint32_t {map.local_indices[corner]} << (i * 8);
+				}
+
+				built.triangles.push_back(packed);
+				++current.triangle_count;
+			}
+		}
+	}
+}
+
+sandbox::meshlet_mesh sandbox::build_meshlets(
+	gsl::span<const submesh> submeshes,
+	gsl::span<const std::uint16_t> indices,
+	gsl::span<const vector3> positions,
+	const meshlet_limits& limits,
+	job_system& jobs)
+{
+	const auto& [max_vertices, max_triangles] = limits;
+	if (max_vertices < 3 || max_vertices > max_meshlet_size || max_triangles < 1 || max_triangles > max_meshlet_size)
+		throw std::invalid_argument {"meshlet limits out of range"};
+
+	std::vector<triangle_run> runs {};
+	for (std::size_t i {}; i < submeshes.size(); ++i) {
+		const std::size_t triangle_count {submeshes[i].index_count / 3};
+		for (std::size_t first {}; first < triangle_count; first += run_triangle_count) {
+			const auto last = std::min(first + run_triangle_count, triangle_count);
+			runs.push_back({.submesh {i}, .first {first}, .last {last}});
+		}
+	}
+
+	std::vector<meshlet_mesh> built_runs(runs.size());
+	const auto slice_count = std::min<std::size_t>(jobs.thread_count(), runs.size());
+	jobs.parallel_for(runs.size(), slice_count, [&](std::size_t first, std::size_t last, std::size_t) {
+		vertex_map map {
+			.owners = std::vector<std::uint32_t>(submesh_vertex_count),
+			.local_indices = std::vector<std::uint8_t>(submesh_vertex_count),
+			.current {}};
+
+		for (auto i = first; i < last; ++i) {
+			auto& built = built_runs[i];
+			build_run(runs[i], submeshes, indices, limits, map, built);
+			for (auto& bounded : built.meshlets) {
+				bound_meshlet(
+					bounded,
+					gsl::span {built.vertices}.subspan(bounded.first_vertex, bounded.vertex_count),
+					gsl::span {built.triangles}.subspan(bounded.first_triangle, bounded.triangle_count),
+					positions);
+			}
+		}
+	});
+
+	// Concatenated in run order, which is all that makes the result independent of the slicing
+	meshlet_mesh mesh {};
+	for (const auto& [meshlets, vertices, triangles] : built_runs) {
+		const auto vertex_offset = gsl::narrow<std::uint32_t>(mesh.vertices.size());
+		const auto triangle_offset = gsl::narrow<std::uint32_t>(mesh.triangles.size());
+		for (auto moved : meshlets) {
+			moved.first_vertex += vertex_offset;
+			moved.first_triangle += triangle_offset;
+			mesh.meshlets.push_back(moved);
+		}
+
+		mesh.vertices.insert(mesh.vertices.end(), vertices.begin(), vertices.end());
+		mesh.triangles.insert(mesh.triangles.end(), triangles.begin(), triangles.end());
+	}
+
+	return mesh;
+}
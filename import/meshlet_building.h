@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/job_system.h"
+#include "../runtime/stream_format.h"
+
+namespace sandbox {
+	// Meshlet triangles index their vertices with 8 bits, and a mesh shader outputs at most 256 primitives
+	constexpr std::size_t max_meshlet_size {256};
+
+	struct meshlet_limits {
+		std::size_t max_vertices;
+		std::size_t max_triangles;
+	};
+
+	// Common choices for current hardware
+	constexpr meshlet_limits default_meshlet_limits {.max_vertices {64}, .max_triangles {124}};
+
+	struct meshlet_mesh {
+		std::vector<meshlet> meshlets;
+		std::vector<std::uint32_t> vertices;
+		std::vector<std::uint32_t> triangles;
+	};
+
+	// Groups each submesh's triangles, in order, into meshlets of at most `limits` vertices and triangles, and bounds
+	// each one with a sphere and a normal cone computed from `positions`, which are indexed like the vertex section.
+	// Submeshes are cut into fixed runs of triangles that are built in parallel; no meshlet spans two runs, so the
+	// result is the same for any number of threads. Throws std::invalid_argument unless the limits are from 3 vertices
+	// and 1 triangle up to max_meshlet_size.
+	meshlet_mesh build_meshlets(
+		gsl::span<const submesh> submeshes,
+		gsl::span<const std::uint16_t> indices,
+		gsl::span<const vector3> positions,
+		const meshlet_limits& limits,
+		job_system& jobs);
+}
@@ -1,14 +1,48 @@
 #pragma once
 
+#define NOMINMAX
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <charconv>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stop_token>
 #include <string_view>
-#include <unordered_map>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <gsl/gsl>
 
+// The importer itself only builds for Windows; elsewhere, the memory-mapped reader goes through POSIX, so that the
+// headless tests can build it along with the rest
+#ifdef _WIN32
 #include <intrin.h>
+
+#include <Windows.h>
+#else
+#include <immintrin.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include "stream_writer.h"
+
+#include "../runtime/xxhash64.h"
+
+namespace sandbox {
+	namespace {
+		std::uint64_t align_section(std::uint64_t offset) noexcept
+		{
+			return (offset + stream_alignment - 1) / stream_alignment * stream_alignment;
+		}
+	}
+}
+
+GSL_SUPPRESS(type) // Used to write byte representation to a binary file
+void sandbox::write_streams(
+	gsl::czstring filename,
+	const position_bounds& bounds,
+	gsl::span<const section_source> sources)
+{
+	stream_header header {
+		.magic {stream_magic},
+		.version {stream_version},
+		.section_count {gsl::narrow<std::uint32_t>(sources.size())},
+		.bounds {bounds}};
+
+	std::vector<stream_section> sections {};
+	std::uint64_t offset {sizeof(header) + sources.size() * sizeof(stream_section)};
+	for (const auto& [type, format, element_size, bytes] : sources) {
+		offset = align_section(offset);
+		xxhash64 hash {};
+		hash.update(bytes);
+		sections.push_back(
+			{.type {type},
+			 .format {format},
+			 .offset {offset},
+			 .element_count {bytes.size() / element_size},
+			 .element_size {element_size},
+			 .checksum {hash.digest()}});
+
+		offset += bytes.size();
+	}
+
+	header.file_size = offset;
+
+	std::ofstream outfile {filename, outfile.binary};
+	outfile.exceptions(outfile.failbit | outfile.badbit);
+	outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	outfile.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(stream_section));
+
+	constexpr std::array<char, stream_alignment> padding {};
+	std::uint64_t written {sizeof(header) + sections.size() * sizeof(stream_section)};
+	for (std::size_t i {}; i < sections.size(); ++i) {
+		const auto bytes = sources[i].bytes;
+		outfile.write(padding.data(), gsl::narrow<std::streamsize>(sections[i].offset - written));
+		outfile.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		written = sections[i].offset + bytes.size();
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/stream_format.h"
+
+namespace sandbox {
+	struct section_source {
+		section_type type;
+		std::uint32_t format;
+		std::size_t element_size;
+		gsl::span<const std::byte> bytes;
+	};
+
+	// Writes a stream_header, the section table, and each source's bytes at the next multiple of stream_alignment,
+	// with its checksum
+	void write_streams(gsl::czstring filename, const position_bounds& bounds, gsl::span<const section_source> sources);
+}
@@ -0,0 +1,66 @@
+#include "pch.h"
+
+#include "submesh_splitting.h"
+
+namespace sandbox {
+	namespace {
+		constexpr std::size_t max_submesh_vertices {std::numeric_limits<std::uint16_t>::max() + 1};
+
+		split_mesh make_single_submesh(gsl::span<const unsigned int> indices, gsl::span<const vertex_data> vertices)
+		{
+			split_mesh mesh {
+				.submeshes {{.index_count {gsl::narrow<std::uint32_t>(indices.size())}}},
+				.indices = std::vector<std::uint16_t>(indices.size()),
+				.vertices {vertices.begin(), vertices.end()}};
+
+			std::transform(indices.begin(), indices.end(), mesh.indices.begin(), [](unsigned int index) {
+				return gsl::narrow_cast<std::uint16_t>(index);
+			});
+
+			return mesh;
+		}
+	}
+}
+
+sandbox::split_mesh
+sandbox::split_submeshes(gsl::span<const unsigned int> indices, gsl::span<const vertex_data> vertices)
+{
+	if (vertices.size() <= max_submesh_vertices)
+		return make_single_submesh(indices, vertices);
+
+	constexpr auto unassigned = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> owners(vertices.size(), unassigned);
+	std::vector<std::uint16_t> local_indices(vertices.size());
+
+	split_mesh mesh {.submeshes {{}}};
+	mesh.indices.reserve(indices.size());
+	unsigned int current {};
+	std::size_t local_count {};
+	for (std::size_t i {}; i + 2 < indices.size(); i += 3) {
+		const std::array corners {indices[i], indices[i + 1], indices[i + 2]};
+		const auto& [a, b, c] = corners;
+		const auto is_new = [&](unsigned int corner) { return owners.at(corner) != current; };
+		const auto new_count = is_new(a) + (is_new(b) && b != a) + (is_new(c) && c != a && c != b);
+		if (local_count + new_count > max_submesh_vertices) {
+			++current;
+			local_count = 0;
+			mesh.submeshes.push_back(
+				{.first_index {gsl::narrow<std::uint32_t>(mesh.indices.size())},
+				 .base_vertex {gsl::narrow<std::int32_t>(mesh.vertices.size())}});
+		}
+
+		for (const auto corner : corners) {
+			if (owners[corner] != current) {
+				owners[corner] = current;
+				local_indices[corner] = gsl::narrow_cast<std::uint16_t>(local_count++);
+				mesh.vertices.push_back(vertices[corner]);
+			}
+
+			mesh.indices.push_back(local_indices[corner]);
+		}
+
+		mesh.submeshes.back().index_count += 3;
+	}
+
+	return mesh;
+}
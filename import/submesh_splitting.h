@@ -0,0 +1,18 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/stream_format.h"
+
+namespace sandbox {
+	struct split_mesh {
+		std::vector<submesh> submeshes;
+		std::vector<std::uint16_t> indices;
+		std::vector<vertex_data> vertices;
+	};
+
+	// Splits the mesh into runs of consecutive triangles that each reference at most 65536 distinct vertices, so that
+	// every run can be drawn with 16-bit indices relative to its own base vertex. Triangle order is preserved.
+	// Vertices shared across a split are duplicated; a mesh that fits in a single submesh keeps its vertex order.
+	split_mesh split_submeshes(gsl::span<const unsigned int> indices, gsl::span<const vertex_data> vertices);
+}
@@ -0,0 +1,101 @@
+#include "pch.h"
+
+#include "token_scanner.h"
+
+namespace sandbox {
+	namespace {
+#if defined(__AVX2__)
+		constexpr std::ptrdiff_t block_size {32};
+
+		GSL_SUPPRESS(type .1) // Unaligned vector loads require the cast
+		std::uint32_t match_block(const char* block, char value) noexcept
+		{
+			const auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+			const auto matches = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(value));
+			return gsl::narrow_cast<std::uint32_t>(_mm256_movemask_epi8(matches));
+		}
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		constexpr std::ptrdiff_t block_size {16};
+
+		GSL_SUPPRESS(type .1) // Unaligned vector loads require the cast
+		std::uint32_t match_block(const char* block, char value) noexcept
+		{
+			const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+			const auto matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(value));
+			return gsl::narrow_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+		}
+#else
+		constexpr std::ptrdiff_t block_size {16};
+
+		GSL_SUPPRESS(bounds .1)
+		std::uint32_t match_block(const char* block, char value) noexcept
+		{
+			std::uint32_t mask {};
+			for (std::ptrdiff_t i {}; i < block_size; ++i)
+				mask |= std::uint32_t {block[i] == value} << i;
+
+			return mask;
+		}
+#endif
+
+		// Bit i of the result is set if block[i] == value, for every byte of the block that lies before `last`
+		GSL_SUPPRESS(bounds .1)
+		std::uint32_t match_bytes(const char* block, const char* last, const char* readable_end, char value) noexcept
+		{
+			const auto valid = last - block;
+			if (readable_end - block >= block_size) {
+				const auto mask = match_block(block, value);
+				return valid >= block_size ? mask : mask & ((std::uint32_t {1} << valid) - 1);
+			}
+
+			std::uint32_t mask {};
+			for (std::ptrdiff_t i {}; i < std::min(valid, block_size); ++i)
+				mask |= std::uint32_t {block[i] == value} << i;
+
+			return mask;
+		}
+	}
+}
+
+GSL_SUPPRESS(bounds .1) // Block iteration is pointer arithmetic by nature
+const char* sandbox::find_byte(const char* first, const char* last, const char* readable_end, char value) noexcept
+{
+	for (auto block = first; block < last; block += block_size) {
+		if (const auto mask = match_bytes(block, last, readable_end, value))
+			return block + std::countr_zero(mask);
+	}
+
+	return last;
+}
+
+GSL_SUPPRESS(bounds .1) // Block iteration is pointer arithmetic by nature
+std::size_t sandbox::split_tokens(
+	std::string_view text,
+	const char* readable_end,
+	char delimiter,
+	bool skip_empty,
+	gsl::span<std::string_view> tokens) noexcept
+{
+	const auto first = text.data();
+	const auto last = first + text.size();
+	std::size_t count {};
+	auto token_first = first;
+	const auto emit = [&](const char* token_last) noexcept {
+		if (!skip_empty || token_last != token_first)
+			tokens[count++] = {token_first, gsl::narrow_cast<std::size_t>(token_last - token_first)};
+	};
+
+	for (auto block = first; block < last && count < tokens.size(); block += block_size) {
+		auto mask = match_bytes(block, last, readable_end, delimiter);
+		for (; mask && count < tokens.size(); mask &= mask - 1) {
+			const auto token_last = block + std::countr_zero(mask);
+			emit(token_last);
+			token_first = token_last + 1;
+		}
+	}
+
+	if (count < tokens.size())
+		emit(last);
+
+	return count;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// Both scanners inspect whole blocks of bytes at a time; `readable_end` bounds the memory they are allowed to load,
+	// and may lie past the end of the range being scanned (e.g. at the end of the enclosing file)
+
+	// Returns the first occurrence of `value` in [first, last), or `last` if there is none
+	const char* find_byte(const char* first, const char* last, const char* readable_end, char value) noexcept;
+
+	// Splits `text` on `delimiter` into at most tokens.size() tokens and returns how many were produced; empty tokens
+	// are dropped if `skip_empty` is set
+	std::size_t split_tokens(
+		std::string_view text,
+		const char* readable_end,
+		char delimiter,
+		bool skip_empty,
+		gsl::span<std::string_view> tokens) noexcept;
+}
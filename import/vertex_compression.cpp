@@ -0,0 +1,156 @@
+#include "pch.h"
+
+#include "vertex_compression.h"
+
+#include "../runtime/half_float.h"
+
+namespace sandbox {
+	namespace {
+		constexpr auto max_unorm16 = 65535.0f;
+		constexpr auto max_snorm16 = 32767.0f;
+
+		// NaNs quantize to zero
+		std::uint16_t to_unorm16(float value) noexcept
+		{
+			const auto clamped = value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+			return gsl::narrow_cast<std::uint16_t>(std::lround(clamped * max_unorm16));
+		}
+
+		std::int16_t to_snorm16(float value) noexcept
+		{
+			const auto clamped = value > -1.0f ? std::min(value, 1.0f) : -1.0f;
+			return gsl::narrow_cast<std::int16_t>(std::lround(clamped * max_snorm16));
+		}
+
+		float from_snorm16(std::int16_t value) noexcept { return std::max(value / max_snorm16, -1.0f); }
+
+		float sign_not_zero(float value) noexcept { return value >= 0.0f ? 1.0f : -1.0f; }
+
+		// Projects the normal onto the octahedron |x| + |y| + |z| = 1 and folds the lower hemisphere over the upper
+		// one; a zero normal decodes to +z
+		std::array<std::int16_t, 2> encode_octahedral(const vector3& normal) noexcept
+		{
+			const auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+			if (!(length > 0.0f))
+				return {};
+
+			auto u = normal.x / length;
+			auto v = normal.y / length;
+			if (normal.z < 0.0f) {
+				const auto folded_u = (1.0f - std::abs(v)) * sign_not_zero(u);
+				v = (1.0f - std::abs(u)) * sign_not_zero(v);
+				u = folded_u;
+			}
+
+			return {to_snorm16(u), to_snorm16(v)};
+		}
+
+		vector3 decode_octahedral(const std::array<std::int16_t, 2>& encoded) noexcept
+		{
+			auto x = from_snorm16(encoded[0]);
+			auto y = from_snorm16(encoded[1]);
+			const auto z = 1.0f - std::abs(x) - std::abs(y);
+			const auto fold = std::max(-z, 0.0f);
+			x -= fold * sign_not_zero(x);
+			y -= fold * sign_not_zero(y);
+			const auto length = std::sqrt(x * x + y * y + z * z);
+			return {x / length, y / length, z / length};
+		}
+
+		float dequantize(std::uint16_t value, float minimum, float extent) noexcept
+		{
+			return minimum + value / max_unorm16 * extent;
+		}
+
+		float quantize_ratio(float value, float minimum, float extent) noexcept
+		{
+			return extent > 0.0f ? (value - minimum) / extent : 0.0f;
+		}
+
+		position_bounds compute_bounds(gsl::span<const vertex_data> vertices) noexcept
+		{
+			if (vertices.empty())
+				return {};
+
+			auto minimum = vertices.front().position;
+			auto maximum = minimum;
+			for (const auto& [position, texture_coord, normal] : vertices) {
+				minimum.x = std::min(minimum.x, position.x);
+				minimum.y = std::min(minimum.y, position.y);
+				minimum.z = std::min(minimum.z, position.z);
+				maximum.x = std::max(maximum.x, position.x);
+				maximum.y = std::max(maximum.y, position.y);
+				maximum.z = std::max(maximum.z, position.z);
+			}
+
+			return {
+				.minimum {minimum},
+				.extent {maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z}};
+		}
+
+		float get_angle(const vector3& a, const vector3& b) noexcept
+		{
+			const auto length = std::sqrt((a.x * a.x + a.y * a.y + a.z * a.z) * (b.x * b.x + b.y * b.y + b.z * b.z));
+			const auto cosine = (a.x * b.x + a.y * b.y + a.z * b.z) / length;
+			return std::acos(std::clamp(cosine, -1.0f, 1.0f)) * 180.0f / 3.14159265f;
+		}
+	}
+}
+
+sandbox::compressed_vertices sandbox::compress_vertices(gsl::span<const vertex_data> vertices)
+{
+	compressed_vertices compressed {.bounds {compute_bounds(vertices)}};
+	const auto& [minimum, extent] = compressed.bounds;
+	compressed.vertices.reserve(vertices.size());
+	for (const auto& [position, texture_coord, normal] : vertices) {
+		compressed.vertices.push_back(
+			{.position {
+				 to_unorm16(quantize_ratio(position.x, minimum.x, extent.x)),
+				 to_unorm16(quantize_ratio(position.y, minimum.y, extent.y)),
+				 to_unorm16(quantize_ratio(position.z, minimum.z, extent.z)),
+				 0},
+			 .texture_coord {to_half(texture_coord.x), to_half(texture_coord.y)},
+			 .normal {encode_octahedral(normal)}});
+	}
+
+	return compressed;
+}
+
+sandbox::vertex_data
+sandbox::decompress_vertex(const compact_vertex_data& vertex, const position_bounds& bounds) noexcept
+{
+	const auto& [minimum, extent] = bounds;
+	return {
+		.position {
+			dequantize(vertex.position[0], minimum.x, extent.x),
+			dequantize(vertex.position[1], minimum.y, extent.y),
+			dequantize(vertex.position[2], minimum.z, extent.z)},
+		.texture_coord {from_half(vertex.texture_coord[0]), from_half(vertex.texture_coord[1]), 0.0f},
+		.normal {decode_octahedral(vertex.normal)}};
+}
+
+sandbox::compression_error
+sandbox::measure_compression_error(gsl::span<const vertex_data> originals, const compressed_vertices& compressed)
+{
+	compression_error error {};
+	for (std::size_t i {}; i < originals.size(); ++i) {
+		const auto& original = originals[i];
+		const auto decoded = decompress_vertex(compressed.vertices.at(i), compressed.bounds);
+		error.position = std::max(
+			{error.position,
+			 std::abs(decoded.position.x - original.position.x),
+			 std::abs(decoded.position.y - original.position.y),
+			 std::abs(decoded.position.z - original.position.z)});
+
+		error.texture_coord = std::max(
+			{error.texture_coord,
+			 std::abs(decoded.texture_coord.x - original.texture_coord.x),
+			 std::abs(decoded.texture_coord.y - original.texture_coord.y)});
+
+		const auto& normal = original.normal;
+		if (normal.x != 0.0f || normal.y != 0.0f || normal.z != 0.0f)
+			error.normal = std::max(error.normal, get_angle(normal, decoded.normal));
+	}
+
+	return error;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/stream_format.h"
+
+namespace sandbox {
+	struct compressed_vertices {
+		position_bounds bounds;
+		std::vector<compact_vertex_data> vertices;
+	};
+
+	// Quantizes positions to 16 bits per component within the bounds of the mesh, rounds texture coordinates to
+	// half-precision (dropping the unused w), and octahedral-encodes normals into two 16-bit components
+	compressed_vertices compress_vertices(gsl::span<const vertex_data> vertices);
+
+	// Performs the same decoding as project_compact.hlsl; the texture coordinate's w is always zero
+	vertex_data decompress_vertex(const compact_vertex_data& vertex, const position_bounds& bounds) noexcept;
+
+	struct compression_error {
+		float position; // Largest per-component position error, in object space units
+		float texture_coord; // Largest per-component texture coordinate error
+		float normal; // Largest angle between an original normal and its decoded counterpart, in degrees
+	};
+
+	// Decompresses every vertex and compares it against the original it was compressed from
+	compression_error
+	measure_compression_error(gsl::span<const vertex_data> originals, const compressed_vertices& compressed);
+}
@@ -0,0 +1,144 @@
+#include "pch.h"
+
+#include "vertex_repacking.h"
+
+#include "vertex_table.h"
+
+namespace sandbox {
+	namespace {
+		vector3 map_index(gsl::span<const vector3> values, std::size_t index) noexcept
+		{
+			constexpr auto sentinel = std::numeric_limits<std::size_t>::max();
+			return (index == sentinel || index >= values.size()) ? vector3 {1.0f} : values[index];
+		}
+
+		vertex_data make_vertex(const wavefront& object, const vertex& corner) noexcept
+		{
+			return {
+				.position {map_index(object.positions, corner.position)},
+				.texture_coord {map_index(object.textures, corner.texture)},
+				.normal {map_index(object.normals, corner.normal)}};
+		}
+
+		// The vertex table keeps corner components in 32 bits, which only tells attributes apart below that count
+		void check_attribute_counts(const wavefront& object)
+		{
+			constexpr std::size_t max_count {std::numeric_limits<std::uint32_t>::max()};
+			if (object.positions.size() > max_count || object.textures.size() > max_count
+				|| object.normals.size() > max_count)
+				throw std::length_error {"too many vertex attributes to index"};
+		}
+
+		std::size_t get_shard(const vertex& corner, unsigned int shard_bits) noexcept
+		{
+			// The shard tables index by the low bits of the hash, so shards are picked from a remixed copy of it
+			return (hash(corner) * 0x9e3779b97f4a7c15) >> (64 - shard_bits);
+		}
+	}
+}
+
+sandbox::repacked_mesh sandbox::repack(const wavefront& object)
+{
+	check_attribute_counts(object);
+	vertex_table index_map {object.faces.size()};
+	repacked_mesh mesh {};
+	auto& [indices, vertices] = mesh;
+	indices.reserve(object.faces.size());
+	for (const auto& corner : object.faces) {
+		const auto [index, inserted] = index_map.insert(corner, gsl::narrow_cast<unsigned int>(vertices.size()));
+		if (inserted)
+			vertices.emplace_back(make_vertex(object, corner));
+
+		indices.push_back(index);
+	}
+
+	return mesh;
+}
+
+sandbox::repacked_mesh sandbox::repack(const wavefront& object, job_system& jobs)
+{
+	const auto thread_count = jobs.thread_count();
+	const auto& faces = object.faces;
+	const auto corner_count = gsl::narrow<unsigned int>(faces.size());
+	if (thread_count <= 1)
+		return repack(object);
+
+	check_attribute_counts(object);
+
+	constexpr unsigned int max_shard_bits {16};
+	const auto shard_bits
+		= std::min(gsl::narrow_cast<unsigned int>(std::bit_width(thread_count * 4u - 1)), max_shard_bits);
+	const std::size_t shard_count {1u << shard_bits};
+
+	// Bucket the corners by shard, preserving their order within each shard
+	std::vector<std::vector<unsigned int>> shard_counts(thread_count, std::vector<unsigned int>(shard_count));
+	std::vector<std::uint16_t> shards(corner_count);
+	jobs.parallel_for(corner_count, thread_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+		auto& counts = shard_counts.at(slice);
+		for (auto i = first; i < last; ++i) {
+			const auto shard = get_shard(faces[i], shard_bits);
+			shards[i] = gsl::narrow_cast<std::uint16_t>(shard);
+			++counts[shard];
+		}
+	});
+
+	std::vector<unsigned int> shard_offsets(shard_count + 1);
+	unsigned int offset {};
+	for (std::size_t shard {}; shard < shard_count; ++shard) {
+		shard_offsets[shard] = offset;
+		for (auto& counts : shard_counts)
+			offset += std::exchange(counts[shard], offset);
+	}
+
+	shard_offsets[shard_count] = offset;
+
+	std::vector<unsigned int> bucketed(corner_count);
+	jobs.parallel_for(corner_count, thread_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+		auto& cursors = shard_counts.at(slice);
+		for (auto i = first; i < last; ++i)
+			bucketed[cursors[shards[i]]++] = gsl::narrow_cast<unsigned int>(i);
+	});
+
+	// Map every corner to the first corner with the same vertex; visiting each shard in face order guarantees that
+	// the first insertion of a vertex is its first use
+	std::vector<unsigned int> first_uses(corner_count);
+	jobs.parallel_for(shard_count, shard_count, [&](std::size_t shard, std::size_t, std::size_t) {
+		const auto first = shard_offsets[shard];
+		const auto last = shard_offsets[shard + 1];
+		vertex_table index_map {last - first};
+		for (auto i = first; i < last; ++i) {
+			const auto corner = bucketed[i];
+			first_uses[corner] = index_map.insert(faces[corner], corner).first;
+		}
+	});
+
+	// Number the first uses in face order, exactly as the serial path does
+	std::vector<unsigned int> range_counts(thread_count);
+	jobs.parallel_for(corner_count, thread_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+		auto& count = range_counts.at(slice);
+		for (auto i = first; i < last; ++i)
+			count += first_uses[i] == i;
+	});
+
+	const auto vertex_count = std::accumulate(range_counts.begin(), range_counts.end(), 0u);
+	std::exclusive_scan(range_counts.begin(), range_counts.end(), range_counts.begin(), 0u);
+
+	auto& vertex_numbers = bucketed;
+	std::vector<vertex_data> vertices(vertex_count);
+	jobs.parallel_for(corner_count, thread_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+		auto next_number = range_counts.at(slice);
+		for (auto i = first; i < last; ++i) {
+			if (first_uses[i] == i) {
+				vertex_numbers[i] = next_number;
+				vertices[next_number++] = make_vertex(object, faces[i]);
+			}
+		}
+	});
+
+	jobs.parallel_for(corner_count, thread_count, [&](std::size_t first, std::size_t last, std::size_t) {
+		for (auto i = first; i < last; ++i)
+			first_uses[i] = vertex_numbers[first_uses[i]];
+	});
+
+	return {.indices {std::move(first_uses)}, .vertices {std::move(vertices)}};
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "pch.h"
+
+#include "../runtime/job_system.h"
+#include "../runtime/stream_format.h"
+#include "wavefront_loader.h"
+
+namespace sandbox {
+	struct repacked_mesh {
+		std::vector<unsigned int> indices;
+		std::vector<vertex_data> vertices;
+	};
+
+	// Vertices are numbered in order of first use by the face list
+	repacked_mesh repack(const wavefront& object);
+
+	// Deduplicates hash-sharded corners concurrently, then merges them deterministically; the result is identical to
+	// repack(object)
+	repacked_mesh repack(const wavefront& object, job_system& jobs);
+}
@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include "vertex_table.h"
+
+namespace sandbox {
+	namespace {
+		// Tables are kept at most 7/8 full
+		std::size_t get_capacity(std::size_t count) noexcept { return std::bit_ceil(count + count / 7 + 1); }
+
+		std::uint32_t narrow_component(std::size_t component) noexcept
+		{
+			constexpr auto missing = std::numeric_limits<std::uint32_t>::max();
+			return component < missing ? gsl::narrow_cast<std::uint32_t>(component) : missing;
+		}
+
+		std::uint32_t hash_components(std::uint32_t position, std::uint32_t texture, std::uint32_t normal) noexcept
+		{
+			std::uint32_t hash {0xffffffff};
+			hash = _mm_crc32_u32(hash, position);
+			hash = _mm_crc32_u32(hash, texture);
+			hash = _mm_crc32_u32(hash, normal);
+			return hash;
+		}
+	}
+}
+
+std::size_t sandbox::hash(const vertex& key) noexcept
+{
+	return hash_components(
+		narrow_component(key.position),
+		narrow_component(key.texture),
+		narrow_component(key.normal));
+}
+
+sandbox::vertex_table::vertex_table(std::size_t expected_count) :
+	m_slots(get_capacity(expected_count), slot {.key {}, .index {empty_index}}),
+	m_mask {m_slots.size() - 1},
+	m_size {}
+{
+}
+
+std::pair<unsigned int, bool> sandbox::vertex_table::insert(const vertex& key, unsigned int index)
+{
+	if (index == empty_index)
+		throw std::out_of_range {"vertex index out of range"};
+
+	return insert_packed(
+		{.position {narrow_component(key.position)},
+		 .texture {narrow_component(key.texture)},
+		 .normal {narrow_component(key.normal)}},
+		index);
+}
+
+std::size_t sandbox::vertex_table::size() const noexcept { return m_size; }
+
+std::size_t sandbox::vertex_table::memory_footprint() const noexcept { return m_slots.size() * sizeof(slot); }
+
+std::pair<unsigned int, bool> sandbox::vertex_table::insert_packed(const packed_vertex& key, unsigned int index)
+{
+	if (get_capacity(m_size + 1) > m_slots.size())
+		grow();
+
+	const auto get_distance = [this](const packed_vertex& other, std::size_t other_position) {
+		return (other_position - hash_components(other.position, other.texture, other.normal)) & m_mask;
+	};
+
+	slot candidate {.key {key}, .index {index}};
+	auto position = hash_components(key.position, key.texture, key.normal) & m_mask;
+	std::size_t distance {};
+	auto inserted = false;
+	while (true) {
+		auto& current = m_slots[position];
+		if (current.index == empty_index) {
+			current = candidate;
+			++m_size;
+			return {index, true};
+		}
+
+		if (!inserted && current.key == key)
+			return {current.index, false};
+
+		// Robin Hood: the candidate takes the slot of any key that is closer to home, which then has to move on. Past
+		// this point the original key cannot be in the table.
+		const auto current_distance = get_distance(current.key, position);
+		if (current_distance < distance) {
+			std::swap(current, candidate);
+			distance = current_distance;
+			inserted = true;
+		}
+
+		position = (position + 1) & m_mask;
+		++distance;
+	}
+}
+
+void sandbox::vertex_table::grow()
+{
+	const slot empty {.key {}, .index {empty_index}};
+	auto old_slots = std::exchange(m_slots, std::vector<slot>(m_slots.size() * 2, empty));
+	m_mask = m_slots.size() - 1;
+	m_size = 0;
+	for (const auto& entry : old_slots) {
+		if (entry.index != empty_index)
+			insert_packed(entry.key, entry.index);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pch.h"
+
+#include "wavefront_loader.h"
+
+namespace sandbox {
+	std::size_t hash(const vertex& key) noexcept;
+
+	// Flat, open-addressed (Robin Hood) map from face corners to vertex indices; keys are stored inline, so a lookup
+	// touches one or two cache lines and insertion never allocates unless the table outgrows its initial size.
+	// Corner components are stored in 32 bits: every component past the largest 32-bit index is treated as the same
+	// missing reference, which is only safe while no attribute array is that long.
+	class vertex_table {
+	public:
+		explicit vertex_table(std::size_t expected_count);
+
+		// Returns the index mapped to `key` and whether it was just inserted (with the value `index`, which must not
+		// be the largest unsigned int)
+		std::pair<unsigned int, bool> insert(const vertex& key, unsigned int index);
+
+		std::size_t size() const noexcept;
+		std::size_t memory_footprint() const noexcept;
+
+	private:
+		struct packed_vertex {
+			std::uint32_t position;
+			std::uint32_t texture;
+			std::uint32_t normal;
+
+			bool operator==(const packed_vertex&) const noexcept = default;
+		};
+
+		// 16 bytes; a key's distance from its home slot is recomputed from its hash rather than stored
+		struct slot {
+			packed_vertex key;
+			unsigned int index; // empty_index if the slot is empty
+		};
+
+		static constexpr auto empty_index = std::numeric_limits<unsigned int>::max();
+
+		std::vector<slot> m_slots;
+		std::size_t m_mask;
+		std::size_t m_size;
+
+		std::pair<unsigned int, bool> insert_packed(const packed_vertex& key, unsigned int index);
+		void grow();
+	};
+}
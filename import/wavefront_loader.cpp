@@ -2,28 +2,12 @@
 
 #include "wavefront_loader.h"
 
+#include "../runtime/mapped_file.h"
+#include "float_parser.h"
+#include "token_scanner.h"
+
 namespace sandbox {
 	namespace {
-		template <char delimiter, bool skip_leading = true, typename iterator_type>
-		std::string_view get_next_token(iterator_type& iterator, const iterator_type& last) noexcept
-		{
-			if constexpr (skip_leading) {
-				for (; iterator != last && *iterator == delimiter; ++iterator)
-					;
-			}
-
-			const iterator_type first_char {iterator};
-			for (; iterator != last && *iterator != delimiter; ++iterator)
-				;
-
-			const iterator_type last_char {iterator};
-
-			if (first_char == last_char)
-				return {};
-
-			return {&*first_char, gsl::narrow_cast<std::size_t>(last_char - first_char)};
-		}
-
 		template <typename type>
 		type convert_from(std::string_view string)
 		{
@@ -42,23 +26,206 @@ namespace sandbox {
 				return std::numeric_limits<std::size_t>::max();
 		}
 
-		vertex convert_vertex(
-			std::string_view vertex_string,
-			std::size_t n_positions,
-			std::size_t n_textures,
-			std::size_t n_normals)
+		struct vertex_references {
+			std::ptrdiff_t position;
+			std::ptrdiff_t texture;
+			std::ptrdiff_t normal;
+		};
+
+		vertex_references convert_references(std::string_view vertex_string, const char* readable_end) noexcept
+		{
+			std::array<std::string_view, 3> tokens {};
+			split_tokens(vertex_string, readable_end, '/', false, tokens);
+			return {
+				.position {convert_from<std::ptrdiff_t>(tokens[0])},
+				.texture {convert_from<std::ptrdiff_t>(tokens[1])},
+				.normal {convert_from<std::ptrdiff_t>(tokens[2])}};
+		}
+
+		// Relative (negative) references are resolved against the counts seen so far in their own chunk; they are
+		// rebased once the counts of all preceding chunks are known
+		enum relative_component : std::uint8_t { relative_position = 1, relative_texture = 2, relative_normal = 4 };
+
+		struct relative_reference {
+			std::size_t corner;
+			std::uint8_t components;
+		};
+
+		struct wavefront_chunk {
+			wavefront object;
+			std::vector<relative_reference> relative_references;
+			int non_triangles;
+			std::size_t malformed_values;
+		};
+
+		void emplace_vertex(wavefront_chunk& chunk, std::string_view vertex_string, const char* readable_end)
+		{
+			auto& object = chunk.object;
+			const auto references = convert_references(vertex_string, readable_end);
+			object.faces.push_back(
+				{.position {map_index(references.position, object.positions.size())},
+				 .texture {map_index(references.texture, object.textures.size())},
+				 .normal {map_index(references.normal, object.normals.size())}});
+
+			const std::uint8_t components = (references.position < 0 ? relative_position : 0)
+				| (references.texture < 0 ? relative_texture : 0) | (references.normal < 0 ? relative_normal : 0);
+
+			if (components)
+				chunk.relative_references.push_back({object.faces.size() - 1, components});
+		}
+
+		wavefront_chunk parse_chunk(std::string_view content)
+		{
+			auto line_first = content.data();
+			const auto content_end = std::next(content.data(), content.size());
+
+			wavefront_chunk chunk {};
+			auto& [positions, textures, normals, faces] = chunk.object;
+			while (true) {
+				for (; line_first != content_end && *line_first == '\r'; ++line_first)
+					;
+
+				if (line_first == content_end)
+					break;
+
+				const auto line_last = find_byte(line_first, content_end, content_end, '\r');
+				const std::string_view line {
+					std::next(line_first),
+					gsl::narrow_cast<std::size_t>(line_last - line_first) - 1};
+
+				line_first = line_last;
+
+				std::array<std::string_view, 1> line_type {};
+				split_tokens(line, content_end, ' ', true, line_type);
+				if (line_type[0].empty())
+					continue;
+
+				const auto elements_first = std::next(line_type[0].data(), line_type[0].size());
+				const std::string_view elements {
+					elements_first,
+					gsl::narrow_cast<std::size_t>(line_last - elements_first)};
+
+				if (line_type[0] == "f") {
+					// Up to three corners, and one more to detect non-triangular faces
+					std::array<std::string_view, 4> corners {};
+					split_tokens(elements, content_end, ' ', true, corners);
+					emplace_vertex(chunk, corners[0], content_end);
+					emplace_vertex(chunk, corners[1], content_end);
+					emplace_vertex(chunk, corners[2], content_end);
+					if (!corners[3].empty())
+						++chunk.non_triangles;
+				}
+				else if (line_type[0] == "v") {
+					std::array<float, 3> value {};
+					chunk.malformed_values += parse_float_record(elements, value, 3);
+					positions.push_back({value[0], value[1], value[2]});
+				}
+				else if (line_type[0] == "vn") {
+					std::array<float, 3> value {};
+					chunk.malformed_values += parse_float_record(elements, value, 3);
+					normals.push_back({value[0], value[1], value[2]});
+				}
+				else if (line_type[0] == "vt") {
+					// Only u is mandatory
+					std::array<float, 3> value {};
+					chunk.malformed_values += parse_float_record(elements, value, 1);
+					textures.push_back({value[0], value[1], value[2]});
+				}
+			}
+
+			return chunk;
+		}
+
+		void report_warnings(int non_triangles, std::size_t malformed_values)
 		{
-			auto iterator = vertex_string.cbegin();
-			const auto stop = vertex_string.cend();
-			const auto position = convert_from<std::ptrdiff_t>(get_next_token<'/', false>(iterator, stop));
-			++iterator;
-			const auto texture = convert_from<std::ptrdiff_t>(get_next_token<'/', false>(iterator, stop));
-			++iterator;
-			const auto normal = convert_from<std::ptrdiff_t>(get_next_token<'/', false>(iterator, stop));
-			return vertex {
-				.position {map_index(position, n_positions)},
-				.texture {map_index(texture, n_textures)},
-				.normal {map_index(normal, n_normals)}};
+			if (non_triangles)
+				std::cout << "warning: " << non_triangles << " faces were not triangles\n";
+
+			if (malformed_values)
+				std::cout << "warning: " << malformed_values << " malformed vertex components were read as zero\n";
+		}
+
+		// Every split point lies just past a line delimiter, so no line straddles two chunks
+		std::vector<std::string_view> split_content(std::string_view content, unsigned int chunk_count)
+		{
+			std::vector<std::string_view> chunks {};
+			std::size_t first {};
+			for (unsigned int i {1}; i <= chunk_count && first < content.size(); ++i) {
+				auto last = content.size();
+				if (i < chunk_count) {
+					const auto nominal = std::max(first, content.size() / chunk_count * i);
+					const auto delimiter = content.find('\r', nominal);
+					if (delimiter != content.npos)
+						last = delimiter + 1;
+				}
+
+				chunks.emplace_back(content.substr(first, last - first));
+				first = last;
+			}
+
+			return chunks;
+		}
+
+		template <typename type>
+		void copy_to(const std::vector<type>& source, std::vector<type>& destination, std::size_t offset)
+		{
+			std::copy(source.begin(), source.end(), std::next(destination.begin(), offset));
+		}
+
+		wavefront merge_chunks(const std::vector<wavefront_chunk>& chunks, job_system& jobs)
+		{
+			struct chunk_offsets {
+				std::size_t positions;
+				std::size_t textures;
+				std::size_t normals;
+				std::size_t faces;
+			};
+
+			std::vector<chunk_offsets> offsets {};
+			chunk_offsets totals {};
+			auto non_triangles = 0;
+			std::size_t malformed_values {};
+			for (const auto& chunk : chunks) {
+				offsets.push_back(totals);
+				totals.positions += chunk.object.positions.size();
+				totals.textures += chunk.object.textures.size();
+				totals.normals += chunk.object.normals.size();
+				totals.faces += chunk.object.faces.size();
+				non_triangles += chunk.non_triangles;
+				malformed_values += chunk.malformed_values;
+			}
+
+			report_warnings(non_triangles, malformed_values);
+
+			wavefront object {
+				.positions = std::vector<vector3>(totals.positions),
+				.textures = std::vector<vector3>(totals.textures),
+				.normals = std::vector<vector3>(totals.normals),
+				.faces = std::vector<vertex>(totals.faces)};
+
+			jobs.parallel_for(chunks.size(), chunks.size(), [&](std::size_t i, std::size_t, std::size_t) {
+				const auto& chunk = chunks.at(i);
+				const auto& offset = offsets.at(i);
+				copy_to(chunk.object.positions, object.positions, offset.positions);
+				copy_to(chunk.object.textures, object.textures, offset.textures);
+				copy_to(chunk.object.normals, object.normals, offset.normals);
+				copy_to(chunk.object.faces, object.faces, offset.faces);
+
+				// Modular arithmetic makes rebasing a relative reference identical to resolving it globally
+				for (const auto& reference : chunk.relative_references) {
+					auto& corner = object.faces.at(offset.faces + reference.corner);
+					if (reference.components & relative_position)
+						corner.position += offset.positions;
+
+					if (reference.components & relative_texture)
+						corner.texture += offset.textures;
+
+					if (reference.components & relative_normal)
+						corner.normal += offset.normals;
+				}
+			});
+
+			return object;
 		}
 	}
 }
@@ -72,71 +239,24 @@ sandbox::wavefront sandbox::load_wavefront(gsl::czstring name)
 	object_file.seekg(object_file.beg);
 	object_file.read(content.data(), content.size());
 
-	auto content_iterator = content.begin();
-	const auto content_end = content.end();
-
-	auto non_triangles = 0;
-	std::vector<vector3> positions {};
-	std::vector<vertex> faces {};
-	std::vector<vector3> normals {};
-	std::vector<vector3> textures {};
-	while (true) {
-		const auto next_line = get_next_token<'\r'>(content_iterator, content_end);
-		if (next_line.empty())
-			break;
-
-		const auto line_end = next_line.end();
-		auto line_iterator = ++next_line.begin();
-		const auto line_type = get_next_token<' '>(line_iterator, line_end);
-		if (line_type == "v") {
-			const auto x = get_next_token<' '>(line_iterator, line_end);
-			const auto y = get_next_token<' '>(line_iterator, line_end);
-			const auto z = get_next_token<' '>(line_iterator, line_end);
-			positions.push_back({convert_from<float>(x), convert_from<float>(y), convert_from<float>(z)});
-		}
-		else if (line_type == "f") {
-			faces.emplace_back(convert_vertex(
-				get_next_token<' '>(line_iterator, line_end),
-				positions.size(),
-				textures.size(),
-				normals.size()));
-
-			faces.emplace_back(convert_vertex(
-				get_next_token<' '>(line_iterator, line_end),
-				positions.size(),
-				textures.size(),
-				normals.size()));
-
-			faces.emplace_back(convert_vertex(
-				get_next_token<' '>(line_iterator, line_end),
-				positions.size(),
-				textures.size(),
-				normals.size()));
-
-			if (!get_next_token<' '>(line_iterator, line_end).empty())
-				++non_triangles;
-		}
-		else if (line_type == "vn") {
-			const auto x = get_next_token<' '>(line_iterator, line_end);
-			const auto y = get_next_token<' '>(line_iterator, line_end);
-			const auto z = get_next_token<' '>(line_iterator, line_end);
-			normals.push_back({convert_from<float>(x), convert_from<float>(y), convert_from<float>(z)});
-		}
-		else if (line_type == "vt") {
-			const auto x = get_next_token<' '>(line_iterator, line_end);
-			const auto y = get_next_token<' '>(line_iterator, line_end);
-			const auto z = get_next_token<' '>(line_iterator, line_end);
-			textures.push_back({convert_from<float>(x), convert_from<float>(y), convert_from<float>(z)});
-		}
-	}
+	auto chunk = parse_chunk({content.data(), content.size()});
+	report_warnings(chunk.non_triangles, chunk.malformed_values);
+
+	return std::move(chunk.object);
+}
 
-	if (non_triangles)
-		std::cout << "warning: " << non_triangles << " faces were not triangles\n";
+GSL_SUPPRESS(type .1) // The scanner works on characters, which the mapped bytes are
+sandbox::wavefront sandbox::load_wavefront_mapped(gsl::czstring name, job_system& jobs)
+{
+	const mapped_file object_file {name};
+	const auto content = object_file.content();
+	const std::string_view text {reinterpret_cast<const char*>(content.data()), content.size()};
+	const auto chunk_views = split_content(text, jobs.thread_count());
 
+	std::vector<wavefront_chunk> chunks(chunk_views.size());
+	jobs.parallel_for(chunk_views.size(), chunk_views.size(), [&](std::size_t i, std::size_t, std::size_t) {
+		chunks.at(i) = parse_chunk(chunk_views.at(i));
+	});
 
-	return {
-		.positions {std::move(positions)},
-		.textures {std::move(textures)},
-		.normals {std::move(normals)},
-		.faces {std::move(faces)}};
+	return merge_chunks(chunks, jobs);
 }
@@ -2,6 +2,7 @@
 
 #include "pch.h"
 
+#include "../runtime/job_system.h"
 #include "../runtime/stream_format.h"
 
 namespace sandbox {
@@ -19,4 +20,7 @@ namespace sandbox {
 	};
 
 	wavefront load_wavefront(gsl::czstring name);
+
+	// Maps the file and parses newline-aligned chunks of it concurrently; the result is identical to load_wavefront()
+	wavefront load_wavefront_mapped(gsl::czstring name, job_system& jobs);
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// Runs `load` on a pool of worker threads for every requested path, and queues the results for the owning thread
+	// to drain at its leisure. Nothing here touches the GPU; whatever `load` produces is simply handed over.
+	//
+	// `load` must report failure through the asset it returns rather than by throwing. On destruction, requests that
+	// no worker has started are abandoned, and assets still being loaded are finished and then discarded.
+	template <typename asset_type>
+	class asset_loader {
+	public:
+		using load_function = std::function<asset_type(const std::filesystem::path&)>;
+
+		asset_loader(unsigned int worker_count, load_function load) :
+			m_load {std::move(load)},
+			m_mutex {},
+			m_requests_available {},
+			m_requests {},
+			m_completed {},
+			m_outstanding {},
+			m_workers {}
+		{
+			for (unsigned int i {}; i < worker_count; ++i)
+				m_workers.emplace_back([this](std::stop_token stop) { run_worker(stop); });
+		}
+
+		~asset_loader() noexcept = default;
+
+		asset_loader(const asset_loader&) = delete;
+		asset_loader& operator=(const asset_loader&) = delete;
+		asset_loader(asset_loader&&) = delete;
+		asset_loader& operator=(asset_loader&&) = delete;
+
+		void request(std::filesystem::path path)
+		{
+			{
+				const std::lock_guard lock {m_mutex};
+				m_requests.emplace_back(std::move(path));
+				++m_outstanding;
+			}
+
+			m_requests_available.notify_one();
+		}
+
+		// Calls `consume` on every asset completed since the last drain, in order of completion, without holding the
+		// lock, so that `consume` may take as long as it likes
+		template <typename function_type>
+		void drain(const function_type& consume)
+		{
+			std::vector<asset_type> completed {};
+			{
+				const std::lock_guard lock {m_mutex};
+				completed.swap(m_completed);
+				m_outstanding -= completed.size();
+			}
+
+			for (auto& asset : completed)
+				consume(std::move(asset));
+		}
+
+		// Requests that have not yet been drained
+		std::size_t outstanding() const
+		{
+			const std::lock_guard lock {m_mutex};
+			return m_outstanding;
+		}
+
+	private:
+		const load_function m_load;
+		mutable std::mutex m_mutex;
+		std::condition_variable_any m_requests_available;
+		std::deque<std::filesystem::path> m_requests;
+		std::vector<asset_type> m_completed;
+		std::size_t m_outstanding;
+
+		// Declared last, so that the workers are stopped and joined before anything they use is destroyed
+		std::vector<std::jthread> m_workers;
+
+		void run_worker(std::stop_token stop)
+		{
+			while (true) {
+				std::filesystem::path path {};
+				{
+					std::unique_lock lock {m_mutex};
+					m_requests_available.wait(lock, stop, [this] { return !m_requests.empty(); });
+					if (stop.stop_requested())
+						return;
+
+					path = std::move(m_requests.front());
+					m_requests.pop_front();
+				}
+
+				auto asset = m_load(path);
+				const std::lock_guard lock {m_mutex};
+				m_completed.emplace_back(std::move(asset));
+			}
+		}
+	};
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include "buddy_allocator.h"
+
+double sandbox::get_external_fragmentation(const buddy_statistics& statistics) noexcept
+{
+	const auto free_bytes = statistics.capacity - statistics.allocated;
+	if (free_bytes == 0)
+		return 0.0;
+
+	return 1.0 - static_cast<double>(statistics.largest_free_block) / static_cast<double>(free_bytes);
+}
+
+sandbox::buddy_allocator::buddy_allocator(std::size_t capacity, std::size_t minimum_block_size) :
+	m_minimum_block_size {minimum_block_size},
+	m_order_count {},
+	m_free_heads {},
+	m_next {},
+	m_previous {},
+	m_free_order {},
+	m_allocated_order {},
+	m_requested {},
+	m_statistics {.capacity {capacity}, .free_block_count {1}, .largest_free_block {capacity}}
+{
+	if (!std::has_single_bit(capacity) || !std::has_single_bit(minimum_block_size) || capacity < minimum_block_size)
+		throw std::invalid_argument {"buddy allocator sizes must be powers of two"};
+
+	const auto block_count = capacity / minimum_block_size;
+	if (block_count > no_block)
+		throw std::invalid_argument {"buddy allocator has too many minimum-size blocks"};
+
+	m_order_count = gsl::narrow<std::uint8_t>(std::countr_zero(block_count) + 1);
+	m_free_heads.resize(m_order_count, no_block);
+	m_next.resize(block_count, no_block);
+	m_previous.resize(block_count, no_block);
+	m_free_order.resize(block_count, not_a_block);
+	m_allocated_order.resize(block_count, not_a_block);
+	m_requested.resize(block_count);
+	push_free(0, gsl::narrow_cast<std::uint8_t>(m_order_count - 1));
+}
+
+std::optional<std::size_t> sandbox::buddy_allocator::allocate(std::size_t size, std::size_t alignment)
+{
+	const auto block_size = std::bit_ceil(std::max({size, alignment, m_minimum_block_size}));
+	if (block_size > m_statistics.capacity)
+		return {};
+
+	const auto order = gsl::narrow_cast<std::uint8_t>(std::countr_zero(block_size / m_minimum_block_size));
+	auto source_order = order;
+	while (source_order < m_order_count && m_free_heads.at(source_order) == no_block)
+		++source_order;
+
+	if (source_order == m_order_count)
+		return {};
+
+	const auto index = m_free_heads.at(source_order);
+	remove_free(index);
+
+	// The upper halves of the source block are left free, one of each order down to the one requested
+	while (source_order > order) {
+		--source_order;
+		push_free(index + (std::uint32_t {1} << source_order), source_order);
+		++m_statistics.free_block_count;
+	}
+
+	--m_statistics.free_block_count;
+	m_allocated_order.at(index) = order;
+	m_requested.at(index) = size;
+	m_statistics.allocated += block_size;
+	m_statistics.requested += size;
+	update_largest_free_block();
+
+	return index * m_minimum_block_size;
+}
+
+void sandbox::buddy_allocator::free(std::size_t offset) noexcept
+{
+	auto index = gsl::narrow_cast<std::uint32_t>(offset / m_minimum_block_size);
+	auto order = std::exchange(m_allocated_order[index], not_a_block);
+	m_statistics.allocated -= m_minimum_block_size << order;
+	m_statistics.requested -= std::exchange(m_requested[index], 0);
+
+	// Merging stops at the first buddy that is in use, or has itself been split
+	while (order + 1 < m_order_count) {
+		const auto buddy = index ^ (std::uint32_t {1} << order);
+		if (m_free_order[buddy] != order)
+			break;
+
+		remove_free(buddy);
+		--m_statistics.free_block_count;
+		index = std::min(index, buddy);
+		++order;
+	}
+
+	push_free(index, order);
+	++m_statistics.free_block_count;
+	update_largest_free_block();
+}
+
+const sandbox::buddy_statistics& sandbox::buddy_allocator::statistics() const noexcept { return m_statistics; }
+
+void sandbox::buddy_allocator::push_free(std::uint32_t index, std::uint8_t order) noexcept
+{
+	auto& head = m_free_heads[order];
+	m_next[index] = head;
+	m_previous[index] = no_block;
+	if (head != no_block)
+		m_previous[head] = index;
+
+	head = index;
+	m_free_order[index] = order;
+}
+
+void sandbox::buddy_allocator::remove_free(std::uint32_t index) noexcept
+{
+	const auto order = std::exchange(m_free_order[index], not_a_block);
+	const auto next = m_next[index];
+	const auto previous = m_previous[index];
+	if (previous == no_block)
+		m_free_heads[order] = next;
+	else
+		m_next[previous] = next;
+
+	if (next != no_block)
+		m_previous[next] = previous;
+}
+
+void sandbox::buddy_allocator::update_largest_free_block() noexcept
+{
+	m_statistics.largest_free_block = 0;
+	for (auto order = m_order_count; order > 0; --order) {
+		if (m_free_heads[order - 1] != no_block) {
+			m_statistics.largest_free_block = m_minimum_block_size << (order - 1);
+			break;
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	struct buddy_statistics {
+		std::size_t capacity;
+		std::size_t allocated; // In whole blocks
+		std::size_t requested; // As asked for; the difference from `allocated` is internal fragmentation
+		std::size_t free_block_count;
+		std::size_t largest_free_block;
+	};
+
+	// The share of free space that cannot be handed out as a single block, from 0 (none) to 1
+	double get_external_fragmentation(const buddy_statistics& statistics) noexcept;
+
+	// Splits a power-of-two range into power-of-two blocks no smaller than a minimum size, and merges freed blocks
+	// with their buddies again. Every block is aligned to its own size, so alignments up to the block size come for
+	// free. No GPU state is involved; offsets are relative to whatever memory the allocator is laid over.
+	class buddy_allocator {
+	public:
+		// Both sizes must be powers of two, with `capacity` no smaller than `minimum_block_size`
+		buddy_allocator(std::size_t capacity, std::size_t minimum_block_size);
+
+		// Returns the offset of a block of at least `size` bytes aligned to `alignment` (a power of two), or nothing if
+		// no free block is large enough
+		std::optional<std::size_t> allocate(std::size_t size, std::size_t alignment);
+
+		// `offset` must have been returned by allocate() and not freed since
+		void free(std::size_t offset) noexcept;
+
+		const buddy_statistics& statistics() const noexcept;
+
+	private:
+		static constexpr std::uint32_t no_block {~std::uint32_t {}};
+		static constexpr std::uint8_t not_a_block {0xff};
+
+		std::size_t m_minimum_block_size;
+		std::uint8_t m_order_count;
+
+		// Free blocks of each order form doubly linked lists threaded through these, indexed in minimum-size blocks
+		std::vector<std::uint32_t> m_free_heads;
+		std::vector<std::uint32_t> m_next;
+		std::vector<std::uint32_t> m_previous;
+		std::vector<std::uint8_t> m_free_order;
+		std::vector<std::uint8_t> m_allocated_order;
+		std::vector<std::size_t> m_requested;
+
+		buddy_statistics m_statistics;
+
+		void push_free(std::uint32_t index, std::uint8_t order) noexcept;
+		void remove_free(std::uint32_t index) noexcept;
+		void update_largest_free_block() noexcept;
+	};
+}
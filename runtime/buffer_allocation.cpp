@@ -0,0 +1,208 @@
+#include "pch.h"
+
+#include "buffer_allocation.h"
+
+namespace sandbox {
+	namespace {
+		constexpr D3D12_RESOURCE_DESC
+		describe_buffer(std::uint64_t size, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE) noexcept
+		{
+			return {
+				.Dimension {D3D12_RESOURCE_DIMENSION_BUFFER},
+				.Width {size},
+				.Height {1},
+				.DepthOrArraySize {1},
+				.MipLevels {1},
+				.SampleDesc {.Count {1}},
+				.Layout {D3D12_TEXTURE_LAYOUT_ROW_MAJOR},
+				.Flags {flags},
+			};
+		}
+
+		auto create_heap(ID3D12Device& device, D3D12_HEAP_TYPE type, std::size_t size)
+		{
+			// Buffer-only heaps can be used on resource heap tier 1 hardware
+			const D3D12_HEAP_DESC description {
+				.SizeInBytes {size},
+				.Properties {.Type {type}},
+				.Alignment {D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT},
+				.Flags {D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS},
+			};
+
+			return winrt::capture<ID3D12Heap>(&device, &ID3D12Device::CreateHeap, &description);
+		}
+	}
+}
+
+winrt::com_ptr<ID3D12Resource> sandbox::create_committed_buffer(
+	ID3D12Device& device,
+	std::uint64_t size,
+	D3D12_HEAP_TYPE heap_type,
+	D3D12_RESOURCE_STATES initial_state,
+	D3D12_RESOURCE_FLAGS flags)
+{
+	const D3D12_HEAP_PROPERTIES heap_properties {.Type {heap_type}};
+	const auto description = describe_buffer(size, flags);
+	return winrt::capture<ID3D12Resource>(
+		&device,
+		&ID3D12Device::CreateCommittedResource,
+		&heap_properties,
+		D3D12_HEAP_FLAG_NONE,
+		&description,
+		initial_state,
+		nullptr);
+}
+
+std::byte* sandbox::map(ID3D12Resource& resource)
+{
+	const D3D12_RANGE range {};
+	void* pointer;
+	winrt::check_hresult(resource.Map(0, &range, &pointer));
+	return static_cast<std::byte*>(pointer);
+}
+
+void sandbox::unmap(ID3D12Resource& resource)
+{
+	const D3D12_RANGE range {};
+	resource.Unmap(0, &range);
+}
+
+sandbox::placed_buffer::placed_buffer() noexcept : m_resource {}, m_heap {}, m_block {}, m_offset {} {}
+
+sandbox::placed_buffer::placed_buffer(
+	winrt::com_ptr<ID3D12Resource> resource,
+	buffer_heap& heap,
+	std::size_t block,
+	std::size_t offset) noexcept :
+	m_resource {std::move(resource)},
+	m_heap {&heap},
+	m_block {block},
+	m_offset {offset}
+{
+}
+
+sandbox::placed_buffer::~placed_buffer() noexcept { release(); }
+
+sandbox::placed_buffer::placed_buffer(placed_buffer&& other) noexcept :
+	m_resource {std::move(other.m_resource)},
+	m_heap {std::exchange(other.m_heap, nullptr)},
+	m_block {other.m_block},
+	m_offset {other.m_offset}
+{
+}
+
+sandbox::placed_buffer& sandbox::placed_buffer::operator=(placed_buffer&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		m_resource = std::move(other.m_resource);
+		m_heap = std::exchange(other.m_heap, nullptr);
+		m_block = other.m_block;
+		m_offset = other.m_offset;
+	}
+
+	return *this;
+}
+
+ID3D12Resource* sandbox::placed_buffer::get() const noexcept { return m_resource.get(); }
+
+ID3D12Resource* sandbox::placed_buffer::operator->() const noexcept { return m_resource.get(); }
+
+sandbox::placed_buffer::operator bool() const noexcept { return static_cast<bool>(m_resource); }
+
+void sandbox::placed_buffer::release() noexcept
+{
+	// The resource must be gone before its range can be placed over again
+	m_resource = nullptr;
+	if (m_heap)
+		std::exchange(m_heap, nullptr)->free(m_block, m_offset);
+}
+
+sandbox::buffer_heap::buffer_heap(ID3D12Device& device, D3D12_HEAP_TYPE type, std::size_t block_size) :
+	m_device {device},
+	m_type {type},
+	m_block_size {block_size},
+	m_mutex {},
+	m_blocks {}
+{
+}
+
+sandbox::placed_buffer sandbox::buffer_heap::create_buffer(std::uint64_t size, D3D12_RESOURCE_STATES initial_state)
+{
+	const auto description = describe_buffer(size);
+	const auto [allocation_size, alignment] = m_device.GetResourceAllocationInfo(0, 1, &description);
+	const auto range_size = gsl::narrow<std::size_t>(allocation_size);
+	const auto range_alignment = gsl::narrow<std::size_t>(alignment);
+
+	std::size_t block {};
+	std::size_t offset {};
+	winrt::com_ptr<ID3D12Heap> heap {};
+	{
+		const std::scoped_lock lock {m_mutex};
+		auto allocated = false;
+		for (; block < m_blocks.size(); ++block) {
+			if (const auto block_offset = m_blocks[block].allocator.allocate(range_size, range_alignment)) {
+				offset = *block_offset;
+				allocated = true;
+				break;
+			}
+		}
+
+		if (!allocated) {
+			const auto new_block_size = std::max(m_block_size, std::bit_ceil(range_size));
+			m_blocks.emplace_back(heap_block {
+				.heap {create_heap(m_device, m_type, new_block_size)},
+				.allocator {new_block_size, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT},
+			});
+
+			offset = *m_blocks.back().allocator.allocate(range_size, range_alignment);
+
+			std::wstringstream message {};
+			message << "Created buffer heap block " << block << " (" << (new_block_size >> 20) << " MiB)\n";
+			OutputDebugStringW(message.str().c_str());
+		}
+
+		// Other threads may add blocks as soon as the lock is released
+		heap = m_blocks[block].heap;
+	}
+
+	try {
+		auto resource = winrt::capture<ID3D12Resource>(
+			&m_device,
+			&ID3D12Device::CreatePlacedResource,
+			heap.get(),
+			offset,
+			&description,
+			initial_state,
+			nullptr);
+
+		return {std::move(resource), *this, block, offset};
+	}
+	catch (...) {
+		free(block, offset);
+		throw;
+	}
+}
+
+sandbox::buffer_heap_statistics sandbox::buffer_heap::statistics() const
+{
+	const std::scoped_lock lock {m_mutex};
+	buffer_heap_statistics statistics {.block_count {m_blocks.size()}, .memory {}};
+	auto& memory = statistics.memory;
+	for (const auto& block : m_blocks) {
+		const auto& block_statistics = block.allocator.statistics();
+		memory.capacity += block_statistics.capacity;
+		memory.allocated += block_statistics.allocated;
+		memory.requested += block_statistics.requested;
+		memory.free_block_count += block_statistics.free_block_count;
+		memory.largest_free_block = std::max(memory.largest_free_block, block_statistics.largest_free_block);
+	}
+
+	return statistics;
+}
+
+void sandbox::buffer_heap::free(std::size_t block, std::size_t offset) noexcept
+{
+	const std::scoped_lock lock {m_mutex};
+	m_blocks[block].allocator.free(offset);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "pch.h"
+
+#include "buddy_allocator.h"
+
+namespace sandbox {
+	winrt::com_ptr<ID3D12Resource> create_committed_buffer(
+		ID3D12Device& device,
+		std::uint64_t size,
+		D3D12_HEAP_TYPE heap_type,
+		D3D12_RESOURCE_STATES initial_state,
+		D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE);
+
+	// Mapping and unmapping declare that the CPU reads nothing back
+	std::byte* map(ID3D12Resource& resource);
+	void unmap(ID3D12Resource& resource);
+
+	class buffer_heap;
+
+	// A buffer placed in one of a buffer_heap's blocks, whose range is returned to the heap when it is destroyed; the
+	// GPU must be done with it by then
+	class placed_buffer {
+	public:
+		placed_buffer() noexcept;
+		placed_buffer(
+			winrt::com_ptr<ID3D12Resource> resource,
+			buffer_heap& heap,
+			std::size_t block,
+			std::size_t offset) noexcept;
+
+		~placed_buffer() noexcept;
+
+		placed_buffer(placed_buffer&& other) noexcept;
+		placed_buffer& operator=(placed_buffer&& other) noexcept;
+		placed_buffer(const placed_buffer&) = delete;
+		placed_buffer& operator=(const placed_buffer&) = delete;
+
+		ID3D12Resource* get() const noexcept;
+		ID3D12Resource* operator->() const noexcept;
+		explicit operator bool() const noexcept;
+
+	private:
+		winrt::com_ptr<ID3D12Resource> m_resource;
+		buffer_heap* m_heap;
+		std::size_t m_block;
+		std::size_t m_offset;
+
+		void release() noexcept;
+	};
+
+	struct buffer_heap_statistics {
+		std::size_t block_count;
+		buddy_statistics memory; // Summed over every block, except for the largest free block
+	};
+
+	// Carves placed buffers out of large heaps instead of paying for a heap per buffer, creating another block
+	// whenever none has room; buffers larger than a block get a block of their own. Safe to use from any thread.
+	class buffer_heap {
+	public:
+		buffer_heap(ID3D12Device& device, D3D12_HEAP_TYPE type, std::size_t block_size);
+
+		buffer_heap(const buffer_heap&) = delete;
+		buffer_heap& operator=(const buffer_heap&) = delete;
+		buffer_heap(const buffer_heap&&) = delete;
+		buffer_heap& operator=(const buffer_heap&&) = delete;
+
+		placed_buffer create_buffer(std::uint64_t size, D3D12_RESOURCE_STATES initial_state);
+		buffer_heap_statistics statistics() const;
+
+	private:
+		friend class placed_buffer;
+
+		struct heap_block {
+			winrt::com_ptr<ID3D12Heap> heap;
+			buddy_allocator allocator;
+		};
+
+		ID3D12Device& m_device;
+		const D3D12_HEAP_TYPE m_type;
+		const std::size_t m_block_size;
+
+		mutable std::mutex m_mutex;
+		std::vector<heap_block> m_blocks;
+
+		void free(std::size_t block, std::size_t offset) noexcept;
+	};
+}
@@ -0,0 +1,9 @@
+#include "culling.hlsli"
+
+[numthreads(CULL_GROUP_SIZE, 1, 1)]
+void main(uint3 group : SV_GroupID, uint3 instance : SV_DispatchThreadID, uint index : SV_GroupIndex)
+{
+	scan_group(index, is_instance_visible(instance.x) ? 1 : 0);
+	if (index == 0)
+		group_offsets[group.x] = scan_sums[CULL_GROUP_SIZE - 1];
+}
@@ -0,0 +1,27 @@
+#include "culling.hlsli"
+
+// Dispatched as a single group, which walks the groups of the other passes a chunk at a time
+[numthreads(CULL_GROUP_SIZE, 1, 1)]
+void main(uint index : SV_GroupIndex)
+{
+	const uint group_count = (instance_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+	uint total = 0;
+	for (uint first = 0; first < group_count; first += CULL_GROUP_SIZE) {
+		const uint group = first + index;
+		const uint count = group < group_count ? group_offsets[group] : 0;
+		const uint sum = scan_group(index, count);
+		if (group < group_count)
+			group_offsets[group] = total + sum - count;
+
+		total += scan_sums[CULL_GROUP_SIZE - 1];
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	// Every instance draws every object
+	for (uint draw = index; draw < draw_count; draw += CULL_GROUP_SIZE) {
+		const uint address = draw * draw_arguments_size;
+		const uint4 arguments = draw_templates.Load4(address);
+		draw_arguments.Store4(address, uint4(arguments.x, total, arguments.zw));
+		draw_arguments.Store(address + 16, draw_templates.Load(address + 16));
+	}
+}
@@ -0,0 +1,12 @@
+#include "culling.hlsli"
+
+// Visible instances are written in ascending order, since each group's offset counts those in the groups before it
+// and each thread's rank those before it in the group
+[numthreads(CULL_GROUP_SIZE, 1, 1)]
+void main(uint3 group : SV_GroupID, uint3 instance : SV_DispatchThreadID, uint index : SV_GroupIndex)
+{
+	const bool visible = is_instance_visible(instance.x);
+	const uint rank = scan_group(index, visible ? 1 : 0);
+	if (visible)
+		visible_indices[group_offsets[group.x] + rank - 1] = instance.x;
+}
@@ -0,0 +1,64 @@
+#include "instance_transforms.hlsli"
+
+// See cull_group_size in indirect_culling.h
+#define CULL_GROUP_SIZE 64
+
+cbuffer culling : register(b0)
+{
+	float4 planes[6]; // See frustum in frustum_culling.h
+	float4 object_bounds; // The center and radius of a sphere around every object
+	uint instance_count;
+	uint transform_encoding;
+	uint draw_count;
+};
+
+// Laid out as draw_indexed_arguments in indirect_culling.h, as is draw_arguments
+ByteAddressBuffer draw_templates : register(t1);
+
+RWStructuredBuffer<uint> group_offsets : register(u0); // Each group's visible count, then the sum of those before it
+RWStructuredBuffer<uint> visible_indices : register(u1);
+RWByteAddressBuffer draw_arguments : register(u2);
+
+static const uint draw_arguments_size = 20;
+
+// Mirrored by is_visible() in indirect_culling.cpp, and summed in the same order as is_visible() in
+// frustum_culling.cpp; instances past the count are never visible
+bool is_instance_visible(uint instance)
+{
+	if (instance >= instance_count)
+		return false;
+
+	const float3x4 transform = load_instance_transform(instance, transform_encoding);
+	const float3 center = mul(transform, float4(object_bounds.xyz, 1.0));
+	const float scale = max(
+		length(transform._m00_m10_m20),
+		max(length(transform._m01_m11_m21), length(transform._m02_m12_m22)));
+
+	const float radius = object_bounds.w * scale;
+	bool visible = true;
+	for (uint i = 0; i < 6; ++i) {
+		const float4 plane = planes[i];
+		const float distance = radius + plane.w + plane.x * center.x + plane.y * center.y + plane.z * center.z;
+		visible = visible && distance >= 0.0;
+	}
+
+	return visible;
+}
+
+groupshared uint scan_sums[CULL_GROUP_SIZE];
+
+// Returns the sum of `value` over threads [0, index] of the group, and must be called by every thread of it; the
+// group's total is left in scan_sums[CULL_GROUP_SIZE - 1] until the group syncs again
+uint scan_group(uint index, uint value)
+{
+	scan_sums[index] = value;
+	GroupMemoryBarrierWithGroupSync();
+	for (uint stride = 1; stride < CULL_GROUP_SIZE; stride *= 2) {
+		const uint addend = index >= stride ? scan_sums[index - stride] : 0;
+		GroupMemoryBarrierWithGroupSync();
+		scan_sums[index] += addend;
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	return scan_sums[index];
+}
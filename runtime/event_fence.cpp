@@ -0,0 +1,18 @@
+#include "pch.h"
+
+#include "event_fence.h"
+
+sandbox::event_fence::event_fence(ID3D12Fence& fence) :
+	m_fence {fence},
+	m_event {winrt::check_pointer(CreateEventW(nullptr, false, false, nullptr))}
+{
+}
+
+std::uint64_t sandbox::event_fence::completed_value() const { return m_fence.GetCompletedValue(); }
+
+void sandbox::event_fence::block_until(std::uint64_t value)
+{
+	winrt::check_hresult(m_fence.SetEventOnCompletion(value, m_event.get()));
+	if (WaitForSingleObject(m_event.get(), INFINITE) != WAIT_OBJECT_0)
+		winrt::throw_last_error();
+}
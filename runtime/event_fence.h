@@ -0,0 +1,20 @@
+#pragma once
+
+#include "pch.h"
+
+#include "frame_pacing.h"
+
+namespace sandbox {
+	// Blocks on an event that the fence sets on completion, rather than polling it
+	class event_fence final : public awaitable_fence {
+	public:
+		explicit event_fence(ID3D12Fence& fence);
+
+		std::uint64_t completed_value() const override;
+		void block_until(std::uint64_t value) override;
+
+	private:
+		ID3D12Fence& m_fence;
+		const winrt::handle m_event;
+	};
+}
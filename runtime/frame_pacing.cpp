@@ -0,0 +1,30 @@
+#include "pch.h"
+
+#include "frame_pacing.h"
+
+sandbox::frame_pacer::frame_pacer(const wait_policy& policy) noexcept : m_policy {policy}, m_statistics {} {}
+
+void sandbox::frame_pacer::wait(awaitable_fence& fence, std::uint64_t value)
+{
+	using clock = std::chrono::steady_clock;
+	const auto start = clock::now();
+	auto blocked = false;
+	while (fence.completed_value() < value) {
+		if (clock::now() - start >= m_policy.spin_duration) {
+			fence.block_until(value);
+			blocked = true;
+			break;
+		}
+
+		_mm_pause();
+	}
+
+	const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+	++m_statistics.wait_count;
+	m_statistics.blocked_count += blocked ? 1 : 0;
+	m_statistics.total_wait += duration;
+	m_statistics.longest_wait = std::max(m_statistics.longest_wait, duration);
+	m_statistics.last_wait = duration;
+}
+
+const sandbox::wait_statistics& sandbox::frame_pacer::statistics() const noexcept { return m_statistics; }
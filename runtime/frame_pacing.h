@@ -0,0 +1,49 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// The view of a GPU fence that waiting needs, so that wait strategies can be exercised without a GPU
+	class awaitable_fence {
+	public:
+		virtual ~awaitable_fence() noexcept = default;
+
+		virtual std::uint64_t completed_value() const = 0;
+
+		// Blocks the calling thread until the fence reaches `value`
+		virtual void block_until(std::uint64_t value) = 0;
+
+	protected:
+		awaitable_fence() noexcept = default;
+		awaitable_fence(const awaitable_fence&) = default;
+		awaitable_fence& operator=(const awaitable_fence&) = default;
+		awaitable_fence(awaitable_fence&&) = default;
+		awaitable_fence& operator=(awaitable_fence&&) = default;
+	};
+
+	// Waits shorter than the spin duration are caught without the latency of a wake-up; longer ones give the core
+	// back. A zero duration always blocks, while duration::max() spins indefinitely.
+	struct wait_policy {
+		std::chrono::nanoseconds spin_duration;
+	};
+
+	struct wait_statistics {
+		std::uint64_t wait_count;
+		std::uint64_t blocked_count; // Waits that outlasted the spin and had to block
+		std::chrono::nanoseconds total_wait;
+		std::chrono::nanoseconds longest_wait;
+		std::chrono::nanoseconds last_wait;
+	};
+
+	class frame_pacer {
+	public:
+		explicit frame_pacer(const wait_policy& policy) noexcept;
+
+		void wait(awaitable_fence& fence, std::uint64_t value);
+		const wait_statistics& statistics() const noexcept;
+
+	private:
+		wait_policy m_policy;
+		wait_statistics m_statistics;
+	};
+}
@@ -0,0 +1,27 @@
+#include "pch.h"
+
+#include "frame_ring.h"
+
+sandbox::frame_ring::frame_ring(std::size_t frame_count) :
+	m_fence_values(frame_count),
+	m_current_index {},
+	m_last_submitted {}
+{
+	if (frame_count < 1 || frame_count > max_frames_in_flight)
+		throw std::invalid_argument {"frames in flight must be between 1 and 4"};
+}
+
+std::size_t sandbox::frame_ring::size() const noexcept { return m_fence_values.size(); }
+
+std::size_t sandbox::frame_ring::current_index() const noexcept { return m_current_index; }
+
+std::uint64_t sandbox::frame_ring::reusable_after() const noexcept { return m_fence_values[m_current_index]; }
+
+std::uint64_t sandbox::frame_ring::submit() noexcept
+{
+	m_fence_values[m_current_index] = ++m_last_submitted;
+	m_current_index = (m_current_index + 1) % m_fence_values.size();
+	return m_last_submitted;
+}
+
+std::uint64_t sandbox::frame_ring::last_submitted() const noexcept { return m_last_submitted; }
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// Tracks the fence value each frame slot was last submitted with, so that a slot's resources are only reused once
+	// the GPU is done with them; with N slots the CPU may run up to N frames ahead of the GPU. No GPU state is
+	// involved, and fence values start from zero.
+	class frame_ring {
+	public:
+		static constexpr std::size_t max_frames_in_flight {4};
+
+		// Throws std::invalid_argument unless 1 <= frame_count <= max_frames_in_flight
+		explicit frame_ring(std::size_t frame_count);
+
+		std::size_t size() const noexcept;
+		std::size_t current_index() const noexcept;
+
+		// The fence value to wait for before reusing the current slot
+		std::uint64_t reusable_after() const noexcept;
+
+		// Claims the next fence value for the current slot and moves on to the next slot; the caller must signal it
+		std::uint64_t submit() noexcept;
+		std::uint64_t last_submitted() const noexcept;
+
+	private:
+		std::vector<std::uint64_t> m_fence_values;
+		std::size_t m_current_index;
+		std::uint64_t m_last_submitted;
+	};
+}
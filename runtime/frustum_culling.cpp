@@ -0,0 +1,58 @@
+#include "pch.h"
+
+#include "frustum_culling.h"
+
+namespace sandbox {
+	namespace {
+		plane add(const plane& left, const plane& right) noexcept
+		{
+			return {left.a + right.a, left.b + right.b, left.c + right.c, left.d + right.d};
+		}
+
+		plane subtract(const plane& left, const plane& right) noexcept
+		{
+			return {left.a - right.a, left.b - right.b, left.c - right.c, left.d - right.d};
+		}
+
+		plane normalize(const plane& unnormalized) noexcept
+		{
+			const auto& [a, b, c, d] = unnormalized;
+			const auto scale = 1.0f / std::sqrt(a * a + b * b + c * c);
+			return {a * scale, b * scale, c * scale, d * scale};
+		}
+
+		bool is_visible(const frustum& planes, float x, float y, float z, float radius) noexcept
+		{
+			for (const auto& [a, b, c, d] : planes) {
+				// Summed in the same order as the culling shaders and the tests' vector kernels, so that all agree
+				// exactly
+				if (radius + d + a * x + b * y + c * z < 0.0f)
+					return false;
+			}
+
+			return true;
+		}
+	}
+}
+
+bool sandbox::is_sphere_visible(const frustum& planes, const vector3& center, float radius) noexcept
+{
+	return is_visible(planes, center.x, center.y, center.z, radius);
+}
+
+sandbox::frustum sandbox::extract_frustum(const matrix4x4& view_projection) noexcept
+{
+	// Clip coordinates are the dot products of a point with the matrix's columns
+	const auto& m = view_projection.rows;
+	const plane x {m[0][0], m[1][0], m[2][0], m[3][0]};
+	const plane y {m[0][1], m[1][1], m[2][1], m[3][1]};
+	const plane z {m[0][2], m[1][2], m[2][2], m[3][2]};
+	const plane w {m[0][3], m[1][3], m[2][3], m[3][3]};
+	return {
+		normalize(add(w, x)),
+		normalize(subtract(w, x)),
+		normalize(add(w, y)),
+		normalize(subtract(w, y)),
+		normalize(z),
+		normalize(subtract(w, z))};
+}
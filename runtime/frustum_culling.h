@@ -0,0 +1,29 @@
+#pragma once
+
+#include "pch.h"
+
+#include "stream_format.h"
+
+namespace sandbox {
+	// Points with a * x + b * y + c * z + d >= 0 lie inside; (a, b, c) is unit length, so the left-hand side is a
+	// distance
+	struct plane {
+		float a;
+		float b;
+		float c;
+		float d;
+	};
+
+	using frustum = std::array<plane, 6>;
+
+	// Laid out as DirectX::XMFLOAT4X4, so that one can be std::bit_cast to the other
+	struct matrix4x4 {
+		std::array<std::array<float, 4>, 4> rows;
+	};
+
+	// Conservative: spheres just outside a frustum corner may pass. The culling shaders test spheres the same way.
+	bool is_sphere_visible(const frustum& planes, const vector3& center, float radius) noexcept;
+
+	// The clip volume of a row-vector view-projection matrix with depth in [0, 1], in the space it transforms from
+	frustum extract_frustum(const matrix4x4& view_projection) noexcept;
+}
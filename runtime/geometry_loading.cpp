@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include "geometry_loading.h"
+
+#include "stream_validation.h"
+#include "xxhash64.h"
+
+namespace sandbox {
+	namespace {
+		// Checksums are verified here, on the loader's thread, which also faults the sections' pages in before the
+		// uploader copies them out
+		gsl::span<const std::byte> get_section(gsl::span<const std::byte> file, const stream_section& section)
+		{
+			const auto content = file.subspan(gsl::narrow<std::size_t>(section.offset), get_section_size(section));
+			xxhash64 hash {};
+			hash.update(content);
+			if (hash.digest() != section.checksum)
+				throw stream_error {"section checksum mismatch"};
+
+			return content;
+		}
+
+		// The view need not be aligned for `type`, so objects are copied out of it
+		template <typename type>
+		void read_raw(gsl::span<const std::byte> file, std::size_t offset, gsl::span<type> objects)
+		{
+			const auto source = file.subspan(offset, objects.size_bytes());
+			std::copy(source.begin(), source.end(), gsl::as_writable_bytes(objects).begin());
+		}
+
+		// Compact streams carry the bounds their positions are relative to, but full ones must be measured
+		position_bounds measure_bounds(gsl::span<const std::byte> vertices, std::size_t stride)
+		{
+			const auto vertex_count = vertices.size() / stride;
+			if (vertex_count == 0)
+				return {};
+
+			constexpr auto infinity = std::numeric_limits<float>::infinity();
+			vector3 minimum {infinity, infinity, infinity};
+			vector3 maximum {-infinity, -infinity, -infinity};
+			for (std::size_t i {}; i < vertex_count; ++i) {
+				vector3 position {};
+				std::memcpy(&position, &vertices[i * stride], sizeof(position));
+				minimum.x = std::min(minimum.x, position.x);
+				minimum.y = std::min(minimum.y, position.y);
+				minimum.z = std::min(minimum.z, position.z);
+				maximum.x = std::max(maximum.x, position.x);
+				maximum.y = std::max(maximum.y, position.y);
+				maximum.z = std::max(maximum.z, position.z);
+			}
+
+			return {.minimum {minimum}, .extent {maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z}};
+		}
+
+		staged_geometry read_geometry(buffer_heap& heap, const std::filesystem::path& path)
+		{
+			auto file = std::make_unique<const mapped_file>(path);
+			const auto content = file->content();
+			if (content.size() < sizeof(stream_header))
+				throw stream_error {"truncated stream file"};
+
+			stream_header header {};
+			read_raw(content, 0, gsl::span {&header, 1});
+			validate_stream_header(header, content.size());
+
+			std::vector<stream_section> sections(header.section_count);
+			read_raw(content, sizeof(header), gsl::span {sections});
+			const auto layout = locate_sections(header, sections);
+
+			// Submeshes stay on the CPU, so they are the only section copied out of the view
+			std::vector<submesh> submeshes(layout.submeshes.element_count);
+			read_raw(get_section(content, layout.submeshes), 0, gsl::span {submeshes});
+			validate_submeshes(submeshes, layout);
+
+			const auto indices = get_section(content, layout.indices);
+			const auto vertices = get_section(content, layout.vertices);
+			validate_submesh_indices(submeshes, indices, layout);
+
+			// Vertex buffer views must be 4-byte aligned, which an odd number of 16-bit indices would break
+			const auto index_bytes = indices.size();
+			const auto vertex_bytes = vertices.size();
+			const auto vertex_offset = (index_bytes + 3) & ~std::size_t {3};
+
+			// Buffers decay to the common state after each use, from which both the copy and direct queues can promote
+			// them implicitly
+			auto buffer = heap.create_buffer(vertex_offset + vertex_bytes, D3D12_RESOURCE_STATE_COMMON);
+			const auto address = buffer->GetGPUVirtualAddress();
+
+			const auto format = vertex_format {layout.vertices.format};
+			const auto vertex_stride = gsl::narrow<std::size_t>(layout.vertices.element_size);
+			const auto bounds = format == vertex_format::full
+				? measure_bounds(vertices, vertex_stride)
+				: layout.bounds;
+
+			const auto is_16_bit = index_format {layout.indices.format} == index_format::uint16;
+			return {
+				.geometry {
+					.buffer {std::move(buffer)},
+					.index_view {
+						.BufferLocation {address},
+						.SizeInBytes {gsl::narrow<unsigned int>(index_bytes)},
+						.Format {is_16_bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT},
+					},
+					.vertex_view {
+						.BufferLocation {address + vertex_offset},
+						.SizeInBytes {gsl::narrow<unsigned int>(vertex_bytes)},
+						.StrideInBytes {gsl::narrow<unsigned int>(layout.vertices.element_size)},
+					},
+					.submeshes {std::move(submeshes)},
+					.format {format},
+					.bounds {bounds},
+				},
+				.file {std::move(file)},
+				.sections {{{.source {indices}, .destination {}}, {.source {vertices}, .destination {vertex_offset}}}},
+			};
+		}
+	}
+}
+
+sandbox::staged_geometry sandbox::load_geometry(buffer_heap& heap, const std::filesystem::path& path)
+{
+	try {
+		return read_geometry(heap, path);
+	}
+	catch (const std::exception& error) {
+		std::wstringstream message {};
+		message << "Rejected " << path << ": " << error.what() << "\n";
+		OutputDebugStringW(message.str().c_str());
+		return {};
+	}
+	catch (const winrt::hresult_error& error) {
+		std::wstringstream message {};
+		message << "Rejected " << path << ": " << error.message().c_str() << "\n";
+		OutputDebugStringW(message.str().c_str());
+		return {};
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pch.h"
+
+#include "buffer_allocation.h"
+#include "mapped_file.h"
+#include "stream_format.h"
+
+namespace sandbox {
+	struct loaded_geometry {
+		placed_buffer buffer;
+		D3D12_INDEX_BUFFER_VIEW index_view;
+		D3D12_VERTEX_BUFFER_VIEW vertex_view;
+		std::vector<submesh> submeshes;
+		vertex_format format;
+		position_bounds bounds; // Of the positions, whatever the vertex format
+	};
+
+	// A section of a stream file, still in the file's mapped view, that belongs `destination` bytes into the buffer
+	struct staged_section {
+		gsl::span<const std::byte> source;
+		std::uint64_t destination;
+	};
+
+	// Geometry whose buffer exists in the default heap but has yet to be filled with its sections, which are copied
+	// straight out of the mapped file; the file stays mapped until they have been
+	struct staged_geometry {
+		loaded_geometry geometry;
+		std::unique_ptr<const mapped_file> file;
+		std::array<staged_section, 2> sections; // The indices, then the vertices
+	};
+
+	// Maps and validates a stream file in place, and places the buffer it will be copied to in `heap`.
+	// Per the no-crash guarantee, a file that cannot be loaded is reported through OutputDebugString() and yields
+	// empty geometry (with no buffer) rather than an error.
+	staged_geometry load_geometry(buffer_heap& heap, const std::filesystem::path& path);
+}
@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include "geometry_uploader.h"
+
+#include "buffer_allocation.h"
+
+namespace sandbox {
+	namespace {
+		auto create_copy_queue(ID3D12Device& device)
+		{
+			const D3D12_COMMAND_QUEUE_DESC description {.Type {D3D12_COMMAND_LIST_TYPE_COPY}};
+			return winrt::capture<ID3D12CommandQueue>(&device, &ID3D12Device::CreateCommandQueue, &description);
+		}
+
+		auto create_copy_allocator(ID3D12Device& device)
+		{
+			return winrt::capture<ID3D12CommandAllocator>(
+				&device,
+				&ID3D12Device::CreateCommandAllocator,
+				D3D12_COMMAND_LIST_TYPE_COPY);
+		}
+	}
+}
+
+sandbox::geometry_uploader::geometry_uploader(ID3D12Device4& device) :
+	m_queue {create_copy_queue(device)},
+	m_allocators {{{create_copy_allocator(device), 0}, {create_copy_allocator(device), 0}}},
+	m_current_allocator {},
+	m_command_list {winrt::capture<ID3D12GraphicsCommandList>(
+		&device,
+		&ID3D12Device4::CreateCommandList1,
+		0,
+		D3D12_COMMAND_LIST_TYPE_COPY,
+		D3D12_COMMAND_LIST_FLAG_NONE)},
+	m_fence_current_value {},
+	m_fence {winrt::capture<ID3D12Fence>(&device, &ID3D12Device::CreateFence, 0, D3D12_FENCE_FLAG_NONE)},
+	m_fence_events {*m_fence},
+	m_pacer {copy_wait_policy},
+	m_ring_buffer {
+		create_committed_buffer(device, ring_capacity, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ)},
+	m_ring_data {map(*m_ring_buffer)},
+	m_ring {ring_capacity},
+	m_pending {},
+	m_finished {}
+{
+}
+
+GSL_SUPPRESS(f .6) // The copy queue must not outlive the buffers it writes to; std::terminate() is acceptable
+sandbox::geometry_uploader::~geometry_uploader() noexcept { m_pacer.wait(m_fence_events, m_fence_current_value); }
+
+void sandbox::geometry_uploader::enqueue(staged_geometry&& geometry)
+{
+	m_pending.emplace_back(pending_upload {.staged {std::move(geometry)}, .section {}, .copied {}});
+}
+
+void sandbox::geometry_uploader::pump(std::size_t budget)
+{
+	m_ring.retire(m_fence->GetCompletedValue());
+	if (m_pending.empty())
+		return;
+
+	auto& [allocator, fence_value] = m_allocators.at(m_current_allocator);
+	m_pacer.wait(m_fence_events, fence_value);
+
+	winrt::check_hresult(allocator->Reset());
+	winrt::check_hresult(m_command_list->Reset(allocator.get(), nullptr));
+
+	// Every copy recorded here completes when the submission below signals this value
+	const auto submission_value = m_fence_current_value + 1;
+	std::size_t recorded {};
+	while (!m_pending.empty() && recorded < budget) {
+		auto& [staged, section, copied] = m_pending.front();
+		const auto& [source, destination] = staged.sections.at(section);
+		const auto size = std::min({source.size() - copied, chunk_size, budget - recorded});
+		if (size != 0) {
+			const auto offset = m_ring.allocate(size, chunk_alignment);
+			if (!offset)
+				break;
+
+			std::memcpy(&m_ring_data.get()[*offset], &source[copied], size);
+			m_command_list->CopyBufferRegion(
+				staged.geometry.buffer.get(),
+				destination + copied,
+				m_ring_buffer.get(),
+				*offset,
+				size);
+
+			copied += size;
+			recorded += size;
+		}
+
+		if (copied == source.size()) {
+			copied = 0;
+			if (++section == staged.sections.size()) {
+				m_finished.emplace_back(
+					finished_upload {.geometry {std::move(staged.geometry)}, .fence_value {submission_value}});
+
+				m_pending.pop_front();
+			}
+		}
+	}
+
+	winrt::check_hresult(m_command_list->Close());
+	if (recorded == 0)
+		return;
+
+	const std::array<ID3D12CommandList*, 1> list_pointers {m_command_list.get()};
+	m_queue->ExecuteCommandLists(gsl::narrow<UINT>(list_pointers.size()), list_pointers.data());
+	winrt::check_hresult(m_queue->Signal(m_fence.get(), ++m_fence_current_value));
+	m_ring.submit(m_fence_current_value);
+	fence_value = m_fence_current_value;
+	m_current_allocator = (m_current_allocator + 1) % m_allocators.size();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pch.h"
+
+#include "event_fence.h"
+#include "frame_pacing.h"
+#include "geometry_loading.h"
+#include "upload_ring.h"
+
+namespace sandbox {
+	// Copies staged geometry from its mapped file into its default-heap buffer on a dedicated copy queue, through a
+	// persistently mapped upload ring; geometry is only handed back once the copy fence shows every one of its copies
+	// has completed
+	class geometry_uploader {
+	public:
+		explicit geometry_uploader(ID3D12Device4& device);
+
+		GSL_SUPPRESS(f .6) // See function definition
+		~geometry_uploader() noexcept;
+
+		geometry_uploader(const geometry_uploader&) = delete;
+		geometry_uploader& operator=(const geometry_uploader&) = delete;
+		geometry_uploader(const geometry_uploader&&) = delete;
+		geometry_uploader& operator=(const geometry_uploader&&) = delete;
+
+		void enqueue(staged_geometry&& geometry);
+
+		// Records and submits at most `budget` bytes of copies, as far as the ring has room for them
+		void pump(std::size_t budget);
+
+		template <typename consumer_type>
+		void collect(const consumer_type& consume)
+		{
+			const auto completed_value = m_fence->GetCompletedValue();
+			while (!m_finished.empty() && m_finished.front().fence_value <= completed_value) {
+				consume(std::move(m_finished.front().geometry));
+				m_finished.pop_front();
+			}
+		}
+
+	private:
+		struct copy_allocator {
+			winrt::com_ptr<ID3D12CommandAllocator> allocator;
+			std::uint64_t fence_value;
+		};
+
+		struct pending_upload {
+			staged_geometry staged;
+			std::size_t section;
+			std::size_t copied; // Of the current section
+		};
+
+		struct finished_upload {
+			loaded_geometry geometry;
+			std::uint64_t fence_value;
+		};
+
+		static constexpr std::size_t ring_capacity {64ull << 20};
+		static constexpr std::size_t chunk_size {4ull << 20}; // Keeps one large mesh from filling the whole ring
+		static constexpr std::size_t chunk_alignment {16};
+
+		// Nothing waits on copies once per frame, so a wake-up's latency goes unnoticed
+		static constexpr wait_policy copy_wait_policy {.spin_duration {}};
+
+		const winrt::com_ptr<ID3D12CommandQueue> m_queue;
+		std::array<copy_allocator, 2> m_allocators;
+		std::size_t m_current_allocator;
+		const winrt::com_ptr<ID3D12GraphicsCommandList> m_command_list;
+
+		std::uint64_t m_fence_current_value;
+		const winrt::com_ptr<ID3D12Fence> m_fence;
+		event_fence m_fence_events;
+		frame_pacer m_pacer;
+
+		const winrt::com_ptr<ID3D12Resource> m_ring_buffer;
+		const gsl::not_null<std::byte*> m_ring_data;
+		upload_ring m_ring;
+
+		std::deque<pending_upload> m_pending;
+		std::deque<finished_upload> m_finished;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include "graphics_engine_state.h"
 
+#include "buffer_allocation.h"
 #include "shader_loading.h"
 #include "stream_format.h"
 
@@ -9,6 +10,9 @@ namespace sandbox {
 	namespace {
 		constexpr auto enable_api_debugging = true;
 
+		// Roughly the cost of a wake-up from a blocking wait
+		constexpr wait_policy frame_wait_policy {.spin_duration {std::chrono::microseconds {50}}};
+
 		auto create_dxgi_factory()
 		{
 			return winrt::capture<IDXGIFactory6>(
@@ -43,14 +47,23 @@ namespace sandbox {
 			return winrt::capture<ID3D12CommandQueue>(&device, &ID3D12Device::CreateCommandQueue, &description);
 		}
 
-		auto create_swap_chain(IDXGIFactory3& factory, ID3D12CommandQueue& presenter_queue, HWND target_window)
+		// Present() blocks less when DXGI's own queue of frames is bounded by the waitable object instead
+		constexpr UINT swap_chain_flags {DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT};
+
+		auto create_swap_chain(
+			IDXGIFactory3& factory,
+			ID3D12CommandQueue& presenter_queue,
+			HWND target_window,
+			unsigned int frames_in_flight)
 		{
+			// One more buffer than there are frames in flight leaves one on screen while the rest are rendered to
 			const DXGI_SWAP_CHAIN_DESC1 description {
 				.Format {DXGI_FORMAT_R8G8B8A8_UNORM},
 				.SampleDesc {.Count {1}},
 				.BufferUsage {DXGI_USAGE_RENDER_TARGET_OUTPUT},
-				.BufferCount {2},
+				.BufferCount {frames_in_flight + 1},
 				.SwapEffect {DXGI_SWAP_EFFECT_FLIP_DISCARD},
+				.Flags {swap_chain_flags},
 			};
 
 			winrt::com_ptr<IDXGISwapChain1> swap_chain {};
@@ -62,7 +75,16 @@ namespace sandbox {
 				nullptr,
 				swap_chain.put()));
 
-			return swap_chain.as<IDXGISwapChain3>();
+			auto swap_chain3 = swap_chain.as<IDXGISwapChain3>();
+			winrt::check_hresult(swap_chain3->SetMaximumFrameLatency(frames_in_flight));
+			return swap_chain3;
+		}
+
+		UINT get_buffer_count(IDXGISwapChain& swap_chain)
+		{
+			DXGI_SWAP_CHAIN_DESC description {};
+			winrt::check_hresult(swap_chain.GetDesc(&description));
+			return description.BufferCount;
 		}
 
 		void present(IDXGISwapChain& swap_chain) { winrt::check_hresult(swap_chain.Present(0, 0)); }
@@ -90,7 +112,7 @@ namespace sandbox {
 
 		void resize(IDXGISwapChain& swap_chain)
 		{
-			winrt::check_hresult(swap_chain.ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0));
+			winrt::check_hresult(swap_chain.ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, swap_chain_flags));
 		}
 
 		auto
@@ -112,6 +134,13 @@ namespace sandbox {
 			};
 		}
 
+		// Orders unordered access writes to the resource before those that follow
+		GSL_SUPPRESS(lifetime) // As for create_transition_barrier()
+		D3D12_RESOURCE_BARRIER create_uav_barrier(ID3D12Resource& resource) noexcept
+		{
+			return {.Type {D3D12_RESOURCE_BARRIER_TYPE_UAV}, .UAV {.pResource {&resource}}};
+		}
+
 		template <typename... list_types>
 		void execute_command_lists(ID3D12CommandQueue& queue, list_types&... command_lists)
 		{
@@ -191,16 +220,48 @@ namespace sandbox {
 				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
 			},
 			D3D12_INPUT_ELEMENT_DESC {
-				.SemanticName {"OFFSET"},
-				.Format {DXGI_FORMAT_R32G32B32_FLOAT},
+				.SemanticName {"INSTANCE"},
+				.Format {DXGI_FORMAT_R32_UINT},
 				.InputSlot {1},
 				.AlignedByteOffset {D3D12_APPEND_ALIGNED_ELEMENT},
 				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA},
 				.InstanceDataStepRate {1}}};
 
-		auto create_object_pipeline_state(ID3D12Device& device, const root_signature_table& root_signatures)
+		// Matches compact_vertex_data; the vertex shader dequantizes positions and decodes normals itself
+		constexpr std::array compact_layout {
+			D3D12_INPUT_ELEMENT_DESC {
+				.SemanticName {"SV_POSITION"},
+				.Format {DXGI_FORMAT_R16G16B16A16_UNORM},
+				.AlignedByteOffset {D3D12_APPEND_ALIGNED_ELEMENT},
+				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
+			},
+			D3D12_INPUT_ELEMENT_DESC {
+				.SemanticName {"TEXTURE"},
+				.Format {DXGI_FORMAT_R16G16_FLOAT},
+				.AlignedByteOffset {D3D12_APPEND_ALIGNED_ELEMENT},
+				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
+			},
+			D3D12_INPUT_ELEMENT_DESC {
+				.SemanticName {"NORMAL"},
+				.Format {DXGI_FORMAT_R16G16_SNORM},
+				.AlignedByteOffset {D3D12_APPEND_ALIGNED_ELEMENT},
+				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA},
+			},
+			D3D12_INPUT_ELEMENT_DESC {
+				.SemanticName {"INSTANCE"},
+				.Format {DXGI_FORMAT_R32_UINT},
+				.InputSlot {1},
+				.AlignedByteOffset {D3D12_APPEND_ALIGNED_ELEMENT},
+				.InputSlotClass {D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA},
+				.InstanceDataStepRate {1}}};
+
+		auto create_object_pipeline_state(
+			ID3D12Device& device,
+			const root_signature_table& root_signatures,
+			gsl::cwzstring vertex_shader_name,
+			gsl::span<const D3D12_INPUT_ELEMENT_DESC> layout)
 		{
-			const auto vertex_shader = load_compiled_shader(L"project.cso");
+			const auto vertex_shader = load_compiled_shader(vertex_shader_name);
 			const auto pixel_shader = load_compiled_shader(L"debug_shading.cso");
 			const D3D12_GRAPHICS_PIPELINE_STATE_DESC description {
 				.pRootSignature {root_signatures.default_signature.get()},
@@ -219,8 +280,8 @@ namespace sandbox {
 					.DepthFunc {D3D12_COMPARISON_FUNC_LESS},
 				},
 				.InputLayout {
-					.pInputElementDescs {common_layout.data()},
-					.NumElements {gsl::narrow_cast<UINT>(common_layout.size())}},
+					.pInputElementDescs {layout.data()},
+					.NumElements {gsl::narrow_cast<UINT>(layout.size())}},
 				.PrimitiveTopologyType {D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE},
 				.NumRenderTargets {1},
 				.RTVFormats {DXGI_FORMAT_R8G8B8A8_UNORM_SRGB},
@@ -234,9 +295,13 @@ namespace sandbox {
 				&description);
 		}
 
-		auto create_wireframe_pipeline_state(ID3D12Device& device, const root_signature_table& root_signatures)
+		auto create_wireframe_pipeline_state(
+			ID3D12Device& device,
+			const root_signature_table& root_signatures,
+			gsl::cwzstring vertex_shader_name,
+			gsl::span<const D3D12_INPUT_ELEMENT_DESC> layout)
 		{
-			const auto vertex_shader = load_compiled_shader(L"project.cso");
+			const auto vertex_shader = load_compiled_shader(vertex_shader_name);
 			const auto pixel_shader = load_compiled_shader(L"debug_shading.cso");
 			const D3D12_GRAPHICS_PIPELINE_STATE_DESC description {
 				.pRootSignature {root_signatures.default_signature.get()},
@@ -255,8 +320,8 @@ namespace sandbox {
 					.DepthFunc {D3D12_COMPARISON_FUNC_LESS},
 				},
 				.InputLayout {
-					.pInputElementDescs {common_layout.data()},
-					.NumElements {gsl::narrow_cast<UINT>(common_layout.size())}},
+					.pInputElementDescs {layout.data()},
+					.NumElements {gsl::narrow_cast<UINT>(layout.size())}},
 				.PrimitiveTopologyType {D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE},
 				.NumRenderTargets {1},
 				.RTVFormats {DXGI_FORMAT_R8G8B8A8_UNORM_SRGB},
@@ -270,17 +335,15 @@ namespace sandbox {
 				&description);
 		}
 
-		auto create_root_signature(ID3D12Device& device)
+		auto create_root_signature(
+			ID3D12Device& device,
+			gsl::span<const D3D12_ROOT_PARAMETER> parameters,
+			D3D12_ROOT_SIGNATURE_FLAGS flags)
 		{
-			const D3D12_ROOT_PARAMETER constants {
-				.ParameterType {D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS},
-				.Constants {.Num32BitValues {4 * 4 * 2}},
-			};
-
 			const D3D12_ROOT_SIGNATURE_DESC info {
-				.NumParameters {1},
-				.pParameters {&constants},
-				.Flags {D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT},
+				.NumParameters {gsl::narrow_cast<UINT>(parameters.size())},
+				.pParameters {parameters.data()},
+				.Flags {flags},
 			};
 
 			winrt::com_ptr<ID3DBlob> result {};
@@ -296,6 +359,93 @@ namespace sandbox {
 				result->GetBufferSize());
 		}
 
+		auto create_default_root_signature(ID3D12Device& device)
+		{
+			const std::array parameters {
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS},
+					.Constants {.Num32BitValues {4 * 4 * 2 + 4 * 2 + 1}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_SRV},
+					.Descriptor {.ShaderRegister {0}},
+					.ShaderVisibility {D3D12_SHADER_VISIBILITY_VERTEX},
+				}};
+
+			constexpr auto flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
+			return create_root_signature(device, parameters, flags);
+		}
+
+		// Laid out as culling.hlsli expects
+		auto create_culling_root_signature(ID3D12Device& device)
+		{
+			const std::array parameters {
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS},
+					.Constants {.Num32BitValues {4 * 6 + 4 + 3}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_SRV},
+					.Descriptor {.ShaderRegister {0}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_SRV},
+					.Descriptor {.ShaderRegister {1}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_UAV},
+					.Descriptor {.ShaderRegister {0}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_UAV},
+					.Descriptor {.ShaderRegister {1}},
+				},
+				D3D12_ROOT_PARAMETER {
+					.ParameterType {D3D12_ROOT_PARAMETER_TYPE_UAV},
+					.Descriptor {.ShaderRegister {2}},
+				}};
+
+			return create_root_signature(device, parameters, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+		}
+
+		auto create_culling_pipeline_state(
+			ID3D12Device& device,
+			const root_signature_table& root_signatures,
+			gsl::cwzstring shader_name)
+		{
+			const auto shader = load_compiled_shader(shader_name);
+			const D3D12_COMPUTE_PIPELINE_STATE_DESC description {
+				.pRootSignature {root_signatures.culling_signature.get()},
+				.CS {.pShaderBytecode {shader.data()}, .BytecodeLength {shader.size()}},
+			};
+
+			return winrt::capture<ID3D12PipelineState>(
+				&device,
+				&ID3D12Device::CreateComputePipelineState,
+				&description);
+		}
+
+		static_assert(sizeof(draw_indexed_arguments) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS));
+		static_assert(
+			offsetof(draw_indexed_arguments, instance_count) == offsetof(D3D12_DRAW_INDEXED_ARGUMENTS, InstanceCount));
+
+		// Each command is a single draw; nothing else changes between them
+		auto create_draw_signature(ID3D12Device& device)
+		{
+			const D3D12_INDIRECT_ARGUMENT_DESC argument {.Type {D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED}};
+			const D3D12_COMMAND_SIGNATURE_DESC description {
+				.ByteStride {sizeof(draw_indexed_arguments)},
+				.NumArgumentDescs {1},
+				.pArgumentDescs {&argument},
+			};
+
+			return winrt::capture<ID3D12CommandSignature>(
+				&device,
+				&ID3D12Device::CreateCommandSignature,
+				&description,
+				nullptr);
+		}
+
 		void maximize_rasterizer(ID3D12GraphicsCommandList& list, ID3D12Resource& target)
 		{
 			const auto info = target.GetDesc();
@@ -350,15 +500,34 @@ namespace sandbox {
 
 		root_signature_table create_root_signatures(ID3D12Device& device)
 		{
-			return {.default_signature {create_root_signature(device)}};
+			return {
+				.default_signature {create_default_root_signature(device)},
+				.culling_signature {create_culling_root_signature(device)}};
 		}
 
 		pipeline_state_table create_pipeline_states(ID3D12Device& device, const root_signature_table& root_signatures)
 		{
 			return {
 				.debug_grid_pipeline {create_debug_grid_pipeline_state(device, root_signatures)},
-				.object_pipeline {create_object_pipeline_state(device, root_signatures)},
-				.wireframe_pipeline {create_wireframe_pipeline_state(device, root_signatures)}};
+				.object_pipeline {create_object_pipeline_state(device, root_signatures, L"project.cso", common_layout)},
+				.wireframe_pipeline {
+					create_wireframe_pipeline_state(device, root_signatures, L"project.cso", common_layout)},
+				.compact_object_pipeline {
+					create_object_pipeline_state(device, root_signatures, L"project_compact.cso", compact_layout)},
+				.compact_wireframe_pipeline {
+					create_wireframe_pipeline_state(device, root_signatures, L"project_compact.cso", compact_layout)},
+				.cull_count_pipeline {create_culling_pipeline_state(device, root_signatures, L"cull_count.cso")},
+				.cull_scan_pipeline {create_culling_pipeline_state(device, root_signatures, L"cull_scan.cso")},
+				.cull_scatter_pipeline {create_culling_pipeline_state(device, root_signatures, L"cull_scatter.cso")}};
+		}
+
+		ID3D12PipelineState*
+		select_object_pipeline(const pipeline_state_table& pipelines, const loaded_geometry& object, bool wireframe)
+		{
+			if (object.format == vertex_format::compact)
+				return wireframe ? pipelines.compact_wireframe_pipeline.get() : pipelines.compact_object_pipeline.get();
+
+			return wireframe ? pipelines.wireframe_pipeline.get() : pipelines.object_pipeline.get();
 		}
 
 		DirectX::XMMATRIX compute_projection(IDXGISwapChain& swap_chain)
@@ -384,152 +553,220 @@ namespace sandbox {
 			device.CreateRenderTargetView(&backbuffer, &description, view_handle);
 		}
 
-		// TODO: not all of these resources need to be recreated every time the size changes
-		auto create_frame_resources(ID3D12Device4& device, ID3D12DescriptorHeap& rtv_heap, IDXGISwapChain& swap_chain)
+		auto create_command_allocator(ID3D12Device& device)
 		{
-			const auto render_handle_size = device.GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-			auto render_view_handle = rtv_heap.GetCPUDescriptorHandleForHeapStart();
-			std::array<per_frame_resources, 2> frame_resources {};
-			for (unsigned int i {}; i < 2; ++i) {
-				auto backbuffer = winrt::capture<ID3D12Resource>(&swap_chain, &IDXGISwapChain::GetBuffer, i);
-				create_backbuffer_view(device, render_view_handle, *backbuffer);
-
-				auto command_allocator = winrt::capture<ID3D12CommandAllocator>(
-					&device,
-					&ID3D12Device::CreateCommandAllocator,
-					D3D12_COMMAND_LIST_TYPE_DIRECT);
-
-				frame_resources.at(i) = per_frame_resources {
-					.allocator {std::move(command_allocator)},
-					.backbuffer_view {render_view_handle},
-					.backbuffer {std::move(backbuffer)}};
+			return winrt::capture<ID3D12CommandAllocator>(
+				&device,
+				&ID3D12Device::CreateCommandAllocator,
+				D3D12_COMMAND_LIST_TYPE_DIRECT);
+		}
 
-				render_view_handle.ptr += render_handle_size;
+		auto create_frame_resources(ID3D12Device& device, std::size_t frame_count, std::size_t part_count)
+		{
+			std::vector<per_frame_resources> frame_resources(frame_count);
+			for (auto& resources : frame_resources) {
+				resources.allocator = create_command_allocator(device);
+				for (std::size_t i {}; i < part_count; ++i)
+					resources.part_allocators.emplace_back(create_command_allocator(device));
 			}
 
 			return frame_resources;
 		}
 
-		auto create_object_buffer(ID3D12Device& device, unsigned int size)
+		instance_buffers
+		create_instance_buffers(ID3D12Device& device, std::size_t capacity, transform_encoding encoding)
 		{
-			const D3D12_HEAP_PROPERTIES heap_properties {.Type {D3D12_HEAP_TYPE_UPLOAD}};
-			const D3D12_RESOURCE_DESC description {
-				.Dimension {D3D12_RESOURCE_DIMENSION_BUFFER},
-				.Width {size},
-				.Height {1},
-				.DepthOrArraySize {1},
-				.MipLevels {1},
-				.SampleDesc {.Count {1}},
-				.Layout {D3D12_TEXTURE_LAYOUT_ROW_MAJOR},
-			};
+			auto transforms = create_committed_buffer(
+				device,
+				capacity * get_encoded_size(encoding),
+				D3D12_HEAP_TYPE_UPLOAD,
+				D3D12_RESOURCE_STATE_GENERIC_READ);
+
+			auto group_offsets = create_committed_buffer(
+				device,
+				get_cull_group_count(capacity) * sizeof(std::uint32_t),
+				D3D12_HEAP_TYPE_DEFAULT,
+				D3D12_RESOURCE_STATE_COMMON,
+				D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+			auto visible_indices = create_committed_buffer(
+				device,
+				capacity * sizeof(std::uint32_t),
+				D3D12_HEAP_TYPE_DEFAULT,
+				D3D12_RESOURCE_STATE_COMMON,
+				D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+			const auto mapped_transforms = map(*transforms);
+			return {
+				.transforms {std::move(transforms)},
+				.group_offsets {std::move(group_offsets)},
+				.visible_indices {std::move(visible_indices)},
+				.mapped_transforms {mapped_transforms},
+				.capacity {capacity}};
+		}
+
+		draw_argument_buffers create_draw_argument_buffers(ID3D12Device& device, std::size_t capacity)
+		{
+			auto templates = create_committed_buffer(
+				device,
+				capacity * sizeof(draw_indexed_arguments),
+				D3D12_HEAP_TYPE_UPLOAD,
+				D3D12_RESOURCE_STATE_GENERIC_READ);
+
+			auto arguments = create_committed_buffer(
+				device,
+				capacity * sizeof(draw_indexed_arguments),
+				D3D12_HEAP_TYPE_DEFAULT,
+				D3D12_RESOURCE_STATE_COMMON,
+				D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+			const auto mapped_templates = map(*templates);
+			return {
+				.templates {std::move(templates)},
+				.arguments {std::move(arguments)},
+				.mapped_templates {mapped_templates},
+				.capacity {capacity}};
+		}
+
+		// Fills a cube lattice in x-major order, five units apart, with neither rotation nor scale; counted in 64 bits,
+		// since the cube of the side overflows 32 bits well before the count does
+		std::vector<instance_transform> create_instance_transforms(unsigned int instance_count)
+		{
+			std::uint64_t side {1};
+			while (side * side * side < instance_count)
+				++side;
+
+			std::vector<instance_transform> transforms {};
+			transforms.reserve(instance_count);
+			for (std::uint64_t i {}; i < instance_count; ++i) {
+				const auto x = gsl::narrow_cast<float>(i / (side * side));
+				const auto y = gsl::narrow_cast<float>(i / side % side);
+				const auto z = gsl::narrow_cast<float>(i % side);
+				transforms.push_back({
+					.rotation {0.0f, 0.0f, 0.0f, 1.0f},
+					.scale {1.0f, 1.0f, 1.0f},
+					.translation {5.0f * x, 5.0f * y, 5.0f * z}});
+			}
 
-			return winrt::capture<ID3D12Resource>(
+			return transforms;
+		}
+
+		// Lists are created closed, and must be reset before their first use
+		auto create_command_list(ID3D12Device4& device)
+		{
+			return winrt::capture<ID3D12GraphicsCommandList>(
 				&device,
-				&ID3D12Device::CreateCommittedResource,
-				&heap_properties,
-				D3D12_HEAP_FLAG_NONE,
-				&description,
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr);
+				&ID3D12Device4::CreateCommandList1,
+				0,
+				D3D12_COMMAND_LIST_TYPE_DIRECT,
+				D3D12_COMMAND_LIST_FLAG_NONE);
 		}
 
-		auto map(ID3D12Resource& resource)
+		auto create_command_lists(ID3D12Device4& device, std::size_t count)
 		{
-			const D3D12_RANGE range {};
-			void* pointer;
-			winrt::check_hresult(resource.Map(0, &range, &pointer));
-			return static_cast<char*>(pointer);
+			std::vector<winrt::com_ptr<ID3D12GraphicsCommandList>> lists {};
+			for (std::size_t i {}; i < count; ++i)
+				lists.emplace_back(create_command_list(device));
+
+			return lists;
 		}
 
-		void unmap(ID3D12Resource& resource)
+		// Upper bound on the work a draw will do on the GPU, which parts are balanced by, given how many instances were
+		// culled
+		std::uint64_t estimate_draw_cost(const loaded_geometry& object, unsigned int instance_count) noexcept
 		{
-			const D3D12_RANGE range {};
-			resource.Unmap(0, &range);
+			std::uint64_t index_count {};
+			for (const auto& mesh : object.submeshes)
+				index_count += mesh.index_count;
+
+			return index_count * instance_count;
 		}
 
-		GSL_SUPPRESS(type) // Required for binary deserialization
-		auto load_geometry(ID3D12Device& device, const std::filesystem::path& path)
+		auto create_swap_chain_buffers(ID3D12Device& device, ID3D12DescriptorHeap& rtv_heap, IDXGISwapChain& swap_chain)
 		{
-			std::ifstream file {path, file.binary};
-			file.exceptions(file.failbit | file.badbit);
-			std::size_t vertex_count {};
-			std::size_t index_count {};
-			file.read(reinterpret_cast<char*>(&index_count), sizeof(index_count));
-			file.read(reinterpret_cast<char*>(&vertex_count), sizeof(vertex_count));
+			const auto render_handle_size = device.GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+			auto render_view_handle = rtv_heap.GetCPUDescriptorHandleForHeapStart();
+			std::vector<swap_chain_buffer> buffers(get_buffer_count(swap_chain));
+			for (unsigned int i {}; i < buffers.size(); ++i) {
+				auto backbuffer = winrt::capture<ID3D12Resource>(&swap_chain, &IDXGISwapChain::GetBuffer, i);
+				create_backbuffer_view(device, render_view_handle, *backbuffer);
+				buffers.at(i) = swap_chain_buffer {.view {render_view_handle}, .backbuffer {std::move(backbuffer)}};
+				render_view_handle.ptr += render_handle_size;
+			}
 
-			const auto vertex_bytes = vertex_count * sizeof(vertex_data);
-			const auto index_bytes = index_count * sizeof(unsigned int);
-			const auto buffer_size = index_bytes + vertex_bytes;
-			const auto buffer = create_object_buffer(device, gsl::narrow<unsigned int>(buffer_size));
-			const auto data_pointer = map(*buffer);
-			file.read(data_pointer, index_bytes);
-			file.read(std::next(data_pointer, index_bytes), vertex_bytes);
-			unmap(*buffer);
-			return loaded_geometry {
-				.buffer {buffer},
-				.index_view {
-					.BufferLocation {buffer->GetGPUVirtualAddress()},
-					.SizeInBytes {gsl::narrow<unsigned int>(index_bytes)},
-					.Format {DXGI_FORMAT_R32_UINT},
-				},
-				.vertex_view {
-					.BufferLocation {buffer->GetGPUVirtualAddress() + index_bytes},
-					.SizeInBytes {gsl::narrow<unsigned int>(vertex_bytes)},
-					.StrideInBytes {sizeof(vertex_data)},
-				},
-				.size {gsl::narrow<unsigned int>(index_count)},
-			};
+			return buffers;
 		}
 	}
 }
 
-sandbox::graphics_engine_state::graphics_engine_state(HWND target_window, const std::filesystem::path& filepath) :
-	graphics_engine_state {*create_dxgi_factory(), target_window, filepath}
+sandbox::graphics_engine_state::graphics_engine_state(
+	HWND target_window,
+	gsl::span<const std::filesystem::path> filepaths,
+	unsigned int frames_in_flight,
+	unsigned int instance_count,
+	transform_encoding encoding) :
+	graphics_engine_state {*create_dxgi_factory(), target_window, filepaths, frames_in_flight, instance_count, encoding}
 {
 }
 
 sandbox::graphics_engine_state::graphics_engine_state(
 	IDXGIFactory6& factory,
 	HWND target_window,
-	const std::filesystem::path& filepath) :
+	gsl::span<const std::filesystem::path> filepaths,
+	unsigned int frames_in_flight,
+	unsigned int instance_count,
+	transform_encoding encoding) :
 	m_device {create_gpu_device(factory)},
 	m_queue {create_command_queue(*m_device)},
-	m_swap_chain {create_swap_chain(factory, *m_queue, target_window)},
-	m_rtv_heap {create_descriptor_heap(*m_device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 2)},
+	m_swap_chain {create_swap_chain(factory, *m_queue, target_window, frames_in_flight)},
+	m_frame_latency_waitable {winrt::check_pointer(m_swap_chain->GetFrameLatencyWaitableObject())},
+	m_rtv_heap {create_descriptor_heap(*m_device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, get_buffer_count(*m_swap_chain))},
 	m_dsv_heap {create_descriptor_heap(*m_device, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1)},
 	m_root_signatures {create_root_signatures(*m_device)},
 	m_pipelines {create_pipeline_states(*m_device, m_root_signatures)},
-	m_command_list {winrt::capture<ID3D12GraphicsCommandList>(
-		m_device,
-		&ID3D12Device4::CreateCommandList1,
-		0,
-		D3D12_COMMAND_LIST_TYPE_DIRECT,
-		D3D12_COMMAND_LIST_FLAG_NONE)},
+	m_draw_signature {create_draw_signature(*m_device)},
+	m_command_list {create_command_list(*m_device)},
+	m_closing_list {create_command_list(*m_device)},
+	m_part_lists {create_command_lists(*m_device, recording_part_count)},
+	m_jobs {recording_part_count - 1},
 	m_depth_buffer_view {m_dsv_heap->GetCPUDescriptorHandleForHeapStart()},
 	m_depth_buffer {create_depth_buffer(*m_device, m_depth_buffer_view, get_extent(*m_swap_chain))},
-	m_frame_resources {create_frame_resources(*m_device, *m_rtv_heap, *m_swap_chain)},
-	m_fence_current_value {1},
-	m_fence {create_fence(*m_device, m_fence_current_value)},
+	m_frame_resources {create_frame_resources(*m_device, frames_in_flight, recording_part_count)},
+	m_swap_chain_buffers {create_swap_chain_buffers(*m_device, *m_rtv_heap, *m_swap_chain)},
+	m_frames {frames_in_flight},
+	m_fence {create_fence(*m_device, 0)},
+	m_fence_events {*m_fence},
+	m_pacer {frame_wait_policy},
 	m_projection_matrix {compute_projection(*m_swap_chain)},
-	m_object {load_geometry(*m_device, filepath)},
-	instance_data {create_object_buffer(*m_device, instance_count * sizeof(vector3))},
-	instance_data_view {
-		.BufferLocation {instance_data->GetGPUVirtualAddress()},
-		.SizeInBytes {instance_count * sizeof(vector3)},
-		.StrideInBytes {sizeof(vector3)}}
+	m_geometry_heap {*m_device, D3D12_HEAP_TYPE_DEFAULT, geometry_heap_block_size},
+	m_objects {},
+	m_instances {frames_in_flight},
+	m_instance_buffers(frames_in_flight),
+	m_transform_encoding {encoding},
+	m_object_center {},
+	m_object_radius {},
+	m_draw_templates {},
+	m_object_draws {},
+	m_draw_argument_buffers(frames_in_flight),
+	m_loader {
+		loader_thread_count,
+		[&heap = m_geometry_heap](const std::filesystem::path& path) { return load_geometry(heap, path); }},
+	m_uploader {*m_device}
 {
-	const gsl::span buffer {map(*instance_data), instance_count * sizeof(vector3)};
-	for (auto x = 0; x < instance_cube_side; ++x) {
-		for (auto y = 0; y < instance_cube_side; ++y) {
-			for (auto z = 0; z < instance_cube_side; ++z) {
-				const vector3 offset {5.0f * x, 5.0f * y, 5.0f * z};
-				const auto index = x * instance_cube_side * instance_cube_side + y * instance_cube_side + z;
-				std::memcpy(&buffer[index * sizeof(vector3)], &offset, sizeof(vector3));
-			}
-		}
-	}
+	for (const auto& path : filepaths)
+		m_loader.request(path);
 
-	unmap(*instance_data);
+	// Per the no-crash guarantee, instances that do not fit in memory are simply not placed
+	try {
+		for (const auto& transform : create_instance_transforms(std::min(instance_count, max_culled_instances)))
+			m_instances.add(transform);
+	}
+	catch (const std::bad_alloc& error) {
+		std::wstringstream message {};
+		message << "Placed only " << m_instances.size() << " of " << instance_count << " instances: ";
+		message << error.what() << "\n";
+		OutputDebugStringW(message.str().c_str());
+	}
 }
 
 GSL_SUPPRESS(f .6) // Wait-for-idle is necessary but D3D12 APIs are not marked noexcept; std::terminate() is acceptable
@@ -537,29 +774,40 @@ sandbox::graphics_engine_state::~graphics_engine_state() noexcept { wait_for_idl
 
 void sandbox::graphics_engine_state::render(render_mode type, const DirectX::XMMATRIX& view_matrix)
 {
+	m_loader.drain([this](staged_geometry&& object) {
+		if (object.geometry.buffer)
+			m_uploader.enqueue(std::move(object));
+	});
+
+	m_uploader.pump(upload_budget);
+	const auto object_count = m_objects.size();
+	m_uploader.collect([this](loaded_geometry&& object) { m_objects.emplace_back(std::move(object)); });
+	if (m_objects.size() != object_count) {
+		update_object_bounds();
+		update_draw_templates();
+	}
+
 	const auto& resources = wait_for_frame();
+	const auto& target = m_swap_chain_buffers.at(m_swap_chain->GetCurrentBackBufferIndex());
 	auto& allocator = *resources.allocator;
 	winrt::check_hresult(resources.allocator->Reset());
 	switch (type) {
 	case render_mode::debug_grid:
 		winrt::check_hresult(m_command_list->Reset(&allocator, m_pipelines.debug_grid_pipeline.get()));
-		record_debug_grid_commands(resources, view_matrix);
+		record_debug_grid_commands(target, view_matrix);
+		winrt::check_hresult(m_command_list->Close());
+		execute_command_lists(*m_queue, *m_command_list);
 		break;
 
 	case render_mode::object_view:
-		winrt::check_hresult(m_command_list->Reset(&allocator, m_pipelines.object_pipeline.get()));
-		record_object_view_commands(resources, view_matrix, m_object);
+		record_object_view_commands(resources, target, view_matrix, false);
 		break;
 
 	case render_mode::wireframe_view:
-		winrt::check_hresult(m_command_list->Reset(&allocator, m_pipelines.wireframe_pipeline.get()));
-		record_object_view_commands(resources, view_matrix, m_object);
+		record_object_view_commands(resources, target, view_matrix, true);
 		break;
 	}
 
-	winrt::check_hresult(m_command_list->Close());
-
-	execute_command_lists(*m_queue, *m_command_list);
 	present(*m_swap_chain);
 	signal_frame_submission();
 }
@@ -567,39 +815,246 @@ void sandbox::graphics_engine_state::render(render_mode type, const DirectX::XMM
 void sandbox::graphics_engine_state::signal_size_change()
 {
 	wait_for_idle();
-	m_frame_resources = {};
+	m_swap_chain_buffers = {};
 	resize(*m_swap_chain);
-	m_frame_resources = create_frame_resources(*m_device, *m_rtv_heap, *m_swap_chain);
+	m_swap_chain_buffers = create_swap_chain_buffers(*m_device, *m_rtv_heap, *m_swap_chain);
 	m_depth_buffer = create_depth_buffer(*m_device, m_depth_buffer_view, get_extent(*m_swap_chain));
 	m_projection_matrix = compute_projection(*m_swap_chain);
 }
 
-void sandbox::graphics_engine_state::wait_for_idle()
+const sandbox::wait_statistics& sandbox::graphics_engine_state::frame_wait_statistics() const noexcept
 {
-	while (m_fence->GetCompletedValue() < m_fence_current_value)
-		_mm_pause();
+	return m_pacer.statistics();
 }
 
-const sandbox::per_frame_resources& sandbox::graphics_engine_state::wait_for_frame()
+sandbox::buffer_heap_statistics sandbox::graphics_engine_state::geometry_heap_statistics() const
+{
+	return m_geometry_heap.statistics();
+}
+
+std::optional<sandbox::instance_handle>
+sandbox::graphics_engine_state::add_instance(const instance_transform& transform)
 {
-	while (m_fence->GetCompletedValue() < m_fence_current_value - 1)
-		_mm_pause();
+	try {
+		return m_instances.add(transform);
+	}
+	catch (const std::bad_alloc&) {
+		return {};
+	}
+	catch (const std::length_error&) {
+		return {};
+	}
+}
 
-	return m_frame_resources.at(m_swap_chain->GetCurrentBackBufferIndex());
+bool sandbox::graphics_engine_state::remove_instance(instance_handle instance)
+{
+	try {
+		return m_instances.remove(instance);
+	}
+	catch (const std::bad_alloc&) {
+		return false;
+	}
+}
+
+bool sandbox::graphics_engine_state::move_instance(instance_handle instance, const instance_transform& transform)
+{
+	try {
+		return m_instances.update(instance, transform);
+	}
+	catch (const std::bad_alloc&) {
+		return false;
+	}
+}
+
+void sandbox::graphics_engine_state::wait_for_presentation()
+{
+	if (WaitForSingleObjectEx(m_frame_latency_waitable.get(), 1000, true) == WAIT_FAILED)
+		winrt::throw_last_error();
+}
+
+void sandbox::graphics_engine_state::wait_for_idle() { m_pacer.wait(m_fence_events, m_frames.last_submitted()); }
+
+const sandbox::per_frame_resources& sandbox::graphics_engine_state::wait_for_frame()
+{
+	m_pacer.wait(m_fence_events, m_frames.reusable_after());
+	return m_frame_resources.at(m_frames.current_index());
 }
 
 void sandbox::graphics_engine_state::signal_frame_submission()
 {
-	winrt::check_hresult(m_queue->Signal(m_fence.get(), ++m_fence_current_value));
+	winrt::check_hresult(m_queue->Signal(m_fence.get(), m_frames.submit()));
+}
+
+void sandbox::graphics_engine_state::update_object_bounds()
+{
+	constexpr auto infinity = std::numeric_limits<float>::infinity();
+	vector3 minimum {infinity, infinity, infinity};
+	vector3 maximum {-infinity, -infinity, -infinity};
+	for (const auto& object : m_objects) {
+		const auto& [low, extent] = object.bounds;
+		minimum.x = std::min(minimum.x, low.x);
+		minimum.y = std::min(minimum.y, low.y);
+		minimum.z = std::min(minimum.z, low.z);
+		maximum.x = std::max(maximum.x, low.x + extent.x);
+		maximum.y = std::max(maximum.y, low.y + extent.y);
+		maximum.z = std::max(maximum.z, low.z + extent.z);
+	}
+
+	m_object_center = {(minimum.x + maximum.x) / 2, (minimum.y + maximum.y) / 2, (minimum.z + maximum.z) / 2};
+	m_object_radius = std::hypot(maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z) / 2;
+}
+
+void sandbox::graphics_engine_state::update_draw_templates()
+{
+	m_draw_templates.clear();
+	m_object_draws.clear();
+	for (const auto& object : m_objects)
+		m_object_draws.push_back(append_draw_arguments(m_draw_templates, object.submeshes));
+}
+
+// Only called once the GPU is done with the frame's copy, which is brought up to date by writing the ranges that
+// changed since it was last used
+void sandbox::graphics_engine_state::update_instance_buffers(instance_buffers& buffers, std::size_t copy)
+{
+	const auto transforms = m_instances.transforms();
+	if (transforms.size() > buffers.capacity) {
+		constexpr std::size_t minimum_capacity {256};
+		const auto capacity = std::bit_ceil(std::max(transforms.size(), minimum_capacity));
+		// Per the no-crash guarantee, the instances that do not fit are simply not drawn
+		std::wstringstream message {};
+		message << "Could not grow instance buffers to " << capacity << " instances: ";
+		try {
+			m_instances.invalidate(copy);
+			buffers = create_instance_buffers(*m_device, capacity, m_transform_encoding);
+		}
+		catch (const winrt::hresult_error& error) {
+			message << error.message().c_str() << "\n";
+			OutputDebugStringW(message.str().c_str());
+		}
+		catch (const std::bad_alloc& error) {
+			message << error.what() << "\n";
+			OutputDebugStringW(message.str().c_str());
+		}
+	}
+
+	// If the ranges cannot be taken, they stay pending, and the copy catches up the next time it is used
+	std::vector<dirty_range> dirty_ranges {};
+	try {
+		dirty_ranges = m_instances.take_dirty_ranges(copy);
+	}
+	catch (const std::bad_alloc&) {
+		return;
+	}
+
+	const auto encoded_size = get_encoded_size(m_transform_encoding);
+	const gsl::span destination {buffers.mapped_transforms, buffers.capacity * encoded_size};
+	for (const auto& [first, count] : dirty_ranges) {
+		const auto fitting_count = std::min(first + count, buffers.capacity) - std::min(first, buffers.capacity);
+		if (fitting_count != 0) {
+			const auto source = transforms.subspan(first, fitting_count);
+			encode_transforms(m_transform_encoding, source, destination.subspan(first * encoded_size));
+		}
+	}
+}
+
+// Only called once the GPU is done with the frame's copy; there are few enough templates to rewrite them every frame
+void sandbox::graphics_engine_state::update_draw_argument_buffers(draw_argument_buffers& buffers)
+{
+	if (m_draw_templates.size() > buffers.capacity) {
+		constexpr std::size_t minimum_capacity {64};
+		const auto capacity = std::bit_ceil(std::max(m_draw_templates.size(), minimum_capacity));
+		try {
+			buffers = create_draw_argument_buffers(*m_device, capacity);
+		}
+		catch (const winrt::hresult_error& error) {
+			// Per the no-crash guarantee, the draws that do not fit are simply skipped
+			std::wstringstream message {};
+			message << "Could not grow draw argument buffers to " << capacity << " draws: ";
+			message << error.message().c_str() << "\n";
+			OutputDebugStringW(message.str().c_str());
+		}
+	}
+
+	const auto fitting_count = std::min(m_draw_templates.size(), buffers.capacity);
+	const gsl::span destination {buffers.mapped_templates, buffers.capacity * sizeof(draw_indexed_arguments)};
+	std::ranges::copy(gsl::as_bytes(gsl::span {m_draw_templates}.first(fitting_count)), destination.begin());
+}
+
+// Records the culling passes, after which the frame's visible indices and draw arguments are ready for its draws
+sandbox::culled_instances
+sandbox::graphics_engine_state::cull_instances(ID3D12GraphicsCommandList& list, const DirectX::XMMATRIX& view)
+{
+	const auto frame = m_frames.current_index();
+	auto& buffers = m_instance_buffers.at(frame);
+	auto& draw_buffers = m_draw_argument_buffers.at(frame);
+	update_instance_buffers(buffers, frame);
+	update_draw_argument_buffers(draw_buffers);
+
+	// Instances past the end of the frame's buffers (if they could not grow) are simply not drawn
+	const auto instance_count = std::min({m_instances.size(), buffers.capacity, std::size_t {max_culled_instances}});
+	const auto draw_count = std::min(m_draw_templates.size(), draw_buffers.capacity);
+	if (instance_count == 0 || draw_count == 0)
+		return {};
+
+	DirectX::XMFLOAT4X4 view_projection {};
+	DirectX::XMStoreFloat4x4(&view_projection, view * m_projection_matrix);
+	const auto planes = extract_frustum(std::bit_cast<matrix4x4>(view_projection));
+	const std::array object_bounds {m_object_center.x, m_object_center.y, m_object_center.z, m_object_radius};
+	const std::array counts {
+		gsl::narrow_cast<UINT>(instance_count),
+		static_cast<UINT>(m_transform_encoding),
+		gsl::narrow<UINT>(draw_count)};
+
+	list.SetComputeRootSignature(m_root_signatures.culling_signature.get());
+	list.SetComputeRoot32BitConstants(0, 4 * 6, planes.data(), 0);
+	list.SetComputeRoot32BitConstants(0, 4, object_bounds.data(), 24);
+	list.SetComputeRoot32BitConstants(0, 3, counts.data(), 28);
+	list.SetComputeRootShaderResourceView(1, buffers.transforms->GetGPUVirtualAddress());
+	list.SetComputeRootShaderResourceView(2, draw_buffers.templates->GetGPUVirtualAddress());
+	list.SetComputeRootUnorderedAccessView(3, buffers.group_offsets->GetGPUVirtualAddress());
+	list.SetComputeRootUnorderedAccessView(4, buffers.visible_indices->GetGPUVirtualAddress());
+	list.SetComputeRootUnorderedAccessView(5, draw_buffers.arguments->GetGPUVirtualAddress());
+
+	// Buffers decay to the common state whenever the GPU finishes a frame's lists, and the passes promote them to
+	// unordered access again
+	const auto group_count = gsl::narrow_cast<UINT>(get_cull_group_count(instance_count));
+	list.SetPipelineState(m_pipelines.cull_count_pipeline.get());
+	list.Dispatch(group_count, 1, 1);
+	submit_resource_barriers(list, create_uav_barrier(*buffers.group_offsets));
+	list.SetPipelineState(m_pipelines.cull_scan_pipeline.get());
+	list.Dispatch(1, 1, 1);
+	submit_resource_barriers(list, create_uav_barrier(*buffers.group_offsets));
+	list.SetPipelineState(m_pipelines.cull_scatter_pipeline.get());
+	list.Dispatch(group_count, 1, 1);
+	submit_resource_barriers(
+		list,
+		create_transition_barrier(
+			*buffers.visible_indices,
+			D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER),
+		create_transition_barrier(
+			*draw_buffers.arguments,
+			D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+			D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT));
+
+	return {
+		.transforms {buffers.transforms->GetGPUVirtualAddress()},
+		.index_view {
+			.BufferLocation {buffers.visible_indices->GetGPUVirtualAddress()},
+			.SizeInBytes {gsl::narrow<UINT>(instance_count * sizeof(std::uint32_t))},
+			.StrideInBytes {sizeof(std::uint32_t)}},
+		.arguments {draw_buffers.arguments.get()},
+		.draw_count {draw_count},
+		.count {gsl::narrow<unsigned int>(instance_count)}};
 }
 
 // TODO: should I be moved in-class?
 void sandbox::graphics_engine_state::record_debug_grid_commands(
-	const per_frame_resources& resources,
+	const swap_chain_buffer& target,
 	const DirectX::XMMATRIX& view)
 {
-	auto& backbuffer = *resources.backbuffer;
-	const auto& backbuffer_view = resources.backbuffer_view;
+	auto& backbuffer = *target.backbuffer;
+	const auto& backbuffer_view = target.view;
 
 	m_command_list->SetGraphicsRootSignature(m_root_signatures.default_signature.get());
 	m_command_list->SetGraphicsRoot32BitConstants(0, 16, &view, 0);
@@ -625,32 +1080,117 @@ void sandbox::graphics_engine_state::record_debug_grid_commands(
 // TODO: should I be moved in-class?
 void sandbox::graphics_engine_state::record_object_view_commands(
 	const per_frame_resources& resources,
+	const swap_chain_buffer& target,
 	const DirectX::XMMATRIX& view,
-	const loaded_geometry& object)
+	bool wireframe)
 {
-	auto& backbuffer = *resources.backbuffer;
-	const auto& backbuffer_view = resources.backbuffer_view;
-
-	m_command_list->SetGraphicsRootSignature(m_root_signatures.default_signature.get());
-	m_command_list->SetGraphicsRoot32BitConstants(0, 16, &view, 0);
-	m_command_list->SetGraphicsRoot32BitConstants(0, 16, &m_projection_matrix, 16);
-
-	m_command_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	m_command_list->IASetIndexBuffer(&object.index_view);
-	const std::array views {object.vertex_view, instance_data_view};
-	m_command_list->IASetVertexBuffers(0, gsl::narrow_cast<UINT>(views.size()), views.data());
-	maximize_rasterizer(*m_command_list, backbuffer);
-	m_command_list->OMSetRenderTargets(1, &backbuffer_view, false, &m_depth_buffer_view);
+	auto& backbuffer = *target.backbuffer;
+	const auto& backbuffer_view = target.view;
 
+	// The frame is opened and closed on this thread, around draws that are recorded in parallel
+	winrt::check_hresult(m_command_list->Reset(resources.allocator.get(), nullptr));
 	m_command_list->ClearDepthStencilView(m_depth_buffer_view, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
-
 	submit_resource_barriers(
 		*m_command_list,
 		create_transition_barrier(backbuffer, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
 	clear_render_target(*m_command_list, backbuffer_view);
-	m_command_list->DrawIndexedInstanced(object.size, instance_count, 0, 0, 0);
+	const auto instances = cull_instances(*m_command_list, view);
+	winrt::check_hresult(m_command_list->Close());
+
+	winrt::check_hresult(m_closing_list->Reset(resources.allocator.get(), nullptr));
 	submit_resource_barriers(
-		*m_command_list,
+		*m_closing_list,
 		create_transition_barrier(backbuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COMMON));
+
+	winrt::check_hresult(m_closing_list->Close());
+
+	std::vector<std::uint64_t> costs {};
+	for (const auto& object : m_objects)
+		costs.emplace_back(estimate_draw_cost(object, instances.count));
+
+	// Each part resets its own allocator and list, so that it can be recorded on any thread
+	struct part_recorder {
+		const graphics_engine_state& engine;
+		const per_frame_resources& resources;
+		const swap_chain_buffer& target;
+		const DirectX::XMMATRIX& view;
+		bool wireframe;
+		const culled_instances& instances;
+
+		void reset(std::size_t part) const
+		{
+			auto& allocator = *resources.part_allocators.at(part);
+			winrt::check_hresult(allocator.Reset());
+			winrt::check_hresult(engine.m_part_lists.at(part)->Reset(&allocator, nullptr));
+		}
+
+		void record(std::size_t part, const draw_range& range) const
+		{
+			engine.record_object_draws(*engine.m_part_lists.at(part), target, view, wireframe, instances, range);
+		}
+
+		void close(std::size_t part) const { winrt::check_hresult(engine.m_part_lists.at(part)->Close()); }
+	};
+
+	part_recorder recorder {*this, resources, target, view, wireframe, instances};
+	record_parts(m_jobs, costs, m_part_lists.size(), recorder);
+
+	// Submitted as one batch, in the order the draws were partitioned in
+	std::vector<ID3D12CommandList*> list_pointers {m_command_list.get()};
+	for (const auto& list : m_part_lists)
+		list_pointers.emplace_back(list.get());
+
+	list_pointers.emplace_back(m_closing_list.get());
+	m_queue->ExecuteCommandLists(gsl::narrow<UINT>(list_pointers.size()), list_pointers.data());
+}
+
+// Called concurrently for different ranges, so must only read the engine's state
+void sandbox::graphics_engine_state::record_object_draws(
+	ID3D12GraphicsCommandList& list,
+	const swap_chain_buffer& target,
+	const DirectX::XMMATRIX& view,
+	bool wireframe,
+	const culled_instances& instances,
+	const draw_range& range) const
+{
+	list.SetGraphicsRootSignature(m_root_signatures.default_signature.get());
+	list.SetGraphicsRoot32BitConstants(0, 16, &view, 0);
+	list.SetGraphicsRoot32BitConstants(0, 16, &m_projection_matrix, 16);
+
+	list.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	maximize_rasterizer(list, *target.backbuffer);
+	list.OMSetRenderTargets(1, &target.view, false, &m_depth_buffer_view);
+
+	// Nothing was culled this frame, so there are no draw arguments to execute
+	if (instances.count == 0)
+		return;
+
+	list.SetGraphicsRootShaderResourceView(1, instances.transforms);
+	list.SetGraphicsRoot32BitConstant(0, static_cast<UINT>(m_transform_encoding), 40);
+
+	for (auto i = range.first; i < range.first + range.count; ++i) {
+		const auto& object = m_objects.at(i);
+		// Objects whose draws did not fit in the frame's arguments are skipped, as are all those after them
+		const auto& [first_draw, draw_count] = m_object_draws.at(i);
+		if (first_draw + draw_count > instances.draw_count)
+			break;
+
+		list.SetPipelineState(select_object_pipeline(m_pipelines, object, wireframe));
+		if (object.format == vertex_format::compact) {
+			list.SetGraphicsRoot32BitConstants(0, 3, &object.bounds.minimum, 32);
+			list.SetGraphicsRoot32BitConstants(0, 3, &object.bounds.extent, 36);
+		}
+
+		list.IASetIndexBuffer(&object.index_view);
+		const std::array views {object.vertex_view, instances.index_view};
+		list.IASetVertexBuffers(0, gsl::narrow_cast<UINT>(views.size()), views.data());
+		list.ExecuteIndirect(
+			m_draw_signature.get(),
+			gsl::narrow<UINT>(draw_count),
+			instances.arguments,
+			first_draw * sizeof(draw_indexed_arguments),
+			nullptr,
+			0);
+	}
 }
@@ -2,40 +2,104 @@
 
 #include "pch.h"
 
+#include "asset_loader.h"
+#include "event_fence.h"
+#include "frame_pacing.h"
+#include "frame_ring.h"
+#include "frustum_culling.h"
+#include "geometry_loading.h"
+#include "geometry_uploader.h"
+#include "indirect_culling.h"
+#include "instance_store.h"
+#include "job_system.h"
+#include "parallel_recording.h"
+
 namespace sandbox {
 	struct per_frame_resources {
 		winrt::com_ptr<ID3D12CommandAllocator> allocator {};
+		std::vector<winrt::com_ptr<ID3D12CommandAllocator>> part_allocators {}; // One per recording part
+	};
 
-		// Swap chain dependent
+	// A frame's copy of the encoded instance transforms, which is mapped for its lifetime, and the buffers its culling
+	// passes write to; all of them grow with the instance store
+	struct instance_buffers {
+		winrt::com_ptr<ID3D12Resource> transforms {};
+		winrt::com_ptr<ID3D12Resource> group_offsets {};
+		winrt::com_ptr<ID3D12Resource> visible_indices {};
+		std::byte* mapped_transforms {};
+		std::size_t capacity {}; // In instances
+	};
+
+	// A frame's copy of the draw templates, which is mapped for its lifetime, and the arguments its culling passes fill
+	// in from them; both grow with the number of submeshes
+	struct draw_argument_buffers {
+		winrt::com_ptr<ID3D12Resource> templates {};
+		winrt::com_ptr<ID3D12Resource> arguments {};
+		std::byte* mapped_templates {};
+		std::size_t capacity {}; // In draws
+	};
 
-		D3D12_CPU_DESCRIPTOR_HANDLE backbuffer_view {};
+	// What a frame's draws need from its culling passes
+	struct culled_instances {
+		D3D12_GPU_VIRTUAL_ADDRESS transforms {}; // Read by the vertex shaders as a byte address buffer
+		D3D12_VERTEX_BUFFER_VIEW index_view {};
+		ID3D12Resource* arguments {}; // Consumed by ExecuteIndirect()
+		std::size_t draw_count {}; // Draws past this many did not fit in the frame's arguments, and are skipped
+		unsigned int count {}; // Of the instances culled, since only the GPU knows how many survived
+	};
+
+	// Recreated whenever the swap chain is resized
+	struct swap_chain_buffer {
+		D3D12_CPU_DESCRIPTOR_HANDLE view {};
 		winrt::com_ptr<ID3D12Resource> backbuffer {};
 	};
 
 	struct root_signature_table {
 		const winrt::com_ptr<ID3D12RootSignature> default_signature; // For lack of a better name
+		const winrt::com_ptr<ID3D12RootSignature> culling_signature;
 	};
 
 	struct pipeline_state_table {
 		const winrt::com_ptr<ID3D12PipelineState> debug_grid_pipeline;
 		const winrt::com_ptr<ID3D12PipelineState> object_pipeline;
 		const winrt::com_ptr<ID3D12PipelineState> wireframe_pipeline;
+		const winrt::com_ptr<ID3D12PipelineState> compact_object_pipeline;
+		const winrt::com_ptr<ID3D12PipelineState> compact_wireframe_pipeline;
+		const winrt::com_ptr<ID3D12PipelineState> cull_count_pipeline;
+		const winrt::com_ptr<ID3D12PipelineState> cull_scan_pipeline;
+		const winrt::com_ptr<ID3D12PipelineState> cull_scatter_pipeline;
 	};
 
 	enum class render_mode { debug_grid, object_view, wireframe_view };
 
-	struct loaded_geometry {
-		winrt::com_ptr<ID3D12Resource> buffer;
-		D3D12_INDEX_BUFFER_VIEW index_view;
-		D3D12_VERTEX_BUFFER_VIEW vertex_view;
-		unsigned int size;
-	};
+	// One dispatch of the culling passes can cover no more than this many; instances past it are never drawn, so no
+	// more than this are placed at startup
+	constexpr unsigned int max_culled_instances {
+		gsl::narrow_cast<unsigned int>(cull_group_size * D3D12_CS_DISPATCH_MAX_THREAD_GROUPS_PER_DIMENSION)};
 
 	class graphics_engine_state {
 	public:
-		graphics_engine_state(HWND target_window, const std::filesystem::path& filepath);
+		graphics_engine_state(
+			HWND target_window,
+			gsl::span<const std::filesystem::path> filepaths,
+			unsigned int frames_in_flight,
+			unsigned int instance_count,
+			transform_encoding encoding);
+
+		// Blocks until DXGI can queue another frame without Present() blocking; input sampled after this call reaches
+		// the screen soonest
+		void wait_for_presentation();
+
 		void render(render_mode type, const DirectX::XMMATRIX& view_matrix);
 		void signal_size_change();
+		const wait_statistics& frame_wait_statistics() const noexcept;
+		buffer_heap_statistics geometry_heap_statistics() const;
+
+		// Stale handles are ignored, and make these return false; per the no-crash guarantee, so does running out of
+		// memory, which makes add_instance() return no handle and leaves the instances as they were
+		std::optional<instance_handle> add_instance(const instance_transform& transform);
+		bool remove_instance(instance_handle instance);
+		bool move_instance(instance_handle instance, const instance_transform& transform);
 
 		GSL_SUPPRESS(f .6) // See function definition
 		~graphics_engine_state() noexcept;
@@ -49,38 +113,87 @@ namespace sandbox {
 		const winrt::com_ptr<ID3D12Device4> m_device;
 		const winrt::com_ptr<ID3D12CommandQueue> m_queue;
 		const winrt::com_ptr<IDXGISwapChain3> m_swap_chain;
+		const winrt::handle m_frame_latency_waitable;
 		const winrt::com_ptr<ID3D12DescriptorHeap> m_rtv_heap;
 		const winrt::com_ptr<ID3D12DescriptorHeap> m_dsv_heap;
 		const root_signature_table m_root_signatures;
 		const pipeline_state_table m_pipelines;
+		const winrt::com_ptr<ID3D12CommandSignature> m_draw_signature;
 		const winrt::com_ptr<ID3D12GraphicsCommandList> m_command_list;
+		const winrt::com_ptr<ID3D12GraphicsCommandList> m_closing_list;
+
+		static constexpr unsigned int recording_part_count {4};
+		const std::vector<winrt::com_ptr<ID3D12GraphicsCommandList>> m_part_lists;
+		job_system m_jobs; // The render thread records a part itself while it waits, so it needs one worker fewer
+
 		const D3D12_CPU_DESCRIPTOR_HANDLE m_depth_buffer_view;
 		winrt::com_ptr<ID3D12Resource> m_depth_buffer;
 
-		std::array<per_frame_resources, 2> m_frame_resources;
+		const std::vector<per_frame_resources> m_frame_resources;
+		std::vector<swap_chain_buffer> m_swap_chain_buffers;
 
-		std::uint64_t m_fence_current_value;
+		frame_ring m_frames;
 		const winrt::com_ptr<ID3D12Fence> m_fence;
+		event_fence m_fence_events;
+		frame_pacer m_pacer;
 
 		DirectX::XMMATRIX m_projection_matrix;
-		const loaded_geometry m_object;
 
-		static constexpr auto instance_cube_side = 3;
-		static constexpr auto instance_count = instance_cube_side * instance_cube_side * instance_cube_side;
-		const winrt::com_ptr<ID3D12Resource> instance_data;
-		const D3D12_VERTEX_BUFFER_VIEW instance_data_view;
-
-		graphics_engine_state(IDXGIFactory6& factory, HWND target_window, const std::filesystem::path& filepath);
+		static constexpr std::size_t geometry_heap_block_size {64ull << 20};
+		buffer_heap m_geometry_heap; // Must outlive everything holding geometry
+		std::vector<loaded_geometry> m_objects;
+
+		// Each copy of the store is a frame's instance buffers
+		instance_store m_instances;
+		std::vector<instance_buffers> m_instance_buffers;
+		const transform_encoding m_transform_encoding;
+
+		// Every instance draws every object, so each is bounded by a sphere around all of them
+		vector3 m_object_center;
+		float m_object_radius;
+
+		// A draw for every submesh of every object, and the range of each object's draws
+		std::vector<draw_indexed_arguments> m_draw_templates;
+		std::vector<draw_range> m_object_draws;
+		std::vector<draw_argument_buffers> m_draw_argument_buffers;
+
+		static constexpr unsigned int loader_thread_count {2};
+		static constexpr std::size_t upload_budget {32ull << 20}; // Bytes copied per frame
+		asset_loader<staged_geometry> m_loader;
+		geometry_uploader m_uploader;
+
+		graphics_engine_state(
+			IDXGIFactory6& factory,
+			HWND target_window,
+			gsl::span<const std::filesystem::path> filepaths,
+			unsigned int frames_in_flight,
+			unsigned int instance_count,
+			transform_encoding encoding);
 
 		void wait_for_idle();
 		const per_frame_resources& wait_for_frame();
 		void signal_frame_submission();
 
-		void record_debug_grid_commands(const per_frame_resources& resources, const DirectX::XMMATRIX& view);
+		void update_object_bounds();
+		void update_draw_templates();
+		void update_instance_buffers(instance_buffers& buffers, std::size_t copy);
+		void update_draw_argument_buffers(draw_argument_buffers& buffers);
+		culled_instances cull_instances(ID3D12GraphicsCommandList& list, const DirectX::XMMATRIX& view);
+
+		void record_debug_grid_commands(const swap_chain_buffer& target, const DirectX::XMMATRIX& view);
 
 		void record_object_view_commands(
 			const per_frame_resources& resources,
+			const swap_chain_buffer& target,
+			const DirectX::XMMATRIX& view,
+			bool wireframe);
+
+		void record_object_draws(
+			ID3D12GraphicsCommandList& list,
+			const swap_chain_buffer& target,
 			const DirectX::XMMATRIX& view,
-			const loaded_geometry& object);
+			bool wireframe,
+			const culled_instances& instances,
+			const draw_range& range) const;
 	};
 }
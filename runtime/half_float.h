@@ -0,0 +1,51 @@
+#pragma once
+
+// Shared with the importer, so it relies on the including project's precompiled header
+
+namespace sandbox {
+	// Rounds to nearest even, exactly as F16C and the hardware conversion to DXGI_FORMAT_R16_FLOAT do; NaNs are
+	// quieted, keeping their sign and the top of their payload
+	inline std::uint16_t to_half(float value) noexcept
+	{
+		const auto bits = std::bit_cast<std::uint32_t>(value);
+		const auto sign = (bits >> 16) & 0x8000u;
+		const auto magnitude = bits & 0x7fff'ffffu;
+		std::uint32_t half {};
+		if (magnitude > 0x7f80'0000u) {
+			half = 0x7e00u | ((magnitude >> 13) & 0x3ffu);
+		}
+		else if (magnitude >= 0x477f'f000u) {
+			// Anything from 65520 up rounds past the largest half, 65504
+			half = 0x7c00u;
+		}
+		else if (magnitude < 0x3880'0000u) {
+			// Below 2^-14 the result is subnormal: a multiple of 2^-24, which scaling by 2^24 turns into an integer
+			half = gsl::narrow_cast<std::uint32_t>(std::nearbyint(std::abs(value) * 0x1p24f));
+		}
+		else {
+			// Rebiases the exponent, then rounds away the low 13 bits of the mantissa
+			const auto rebiased = magnitude - 0x3800'0000u;
+			half = (rebiased + 0xfffu + ((rebiased >> 13) & 1u)) >> 13;
+		}
+
+		return gsl::narrow_cast<std::uint16_t>(sign | half);
+	}
+
+	// Exact, since every half is representable as a float
+	inline float from_half(std::uint16_t half) noexcept
+	{
+		const auto sign = (half & 0x8000u) << 16;
+		const auto exponent = (half >> 10) & 0x1fu;
+		const auto mantissa = half & 0x3ffu;
+		if (exponent == 0x1fu)
+			return std::bit_cast<float>(sign | 0x7f80'0000u | mantissa << 13);
+
+		// Subnormal halves are whole numbers of 2^-24
+		if (exponent == 0) {
+			const auto magnitude = std::ldexp(gsl::narrow_cast<float>(mantissa), -24);
+			return sign != 0 ? -magnitude : magnitude;
+		}
+
+		return std::bit_cast<float>(sign | (exponent + 112) << 23 | mantissa << 13);
+	}
+}
@@ -0,0 +1,135 @@
+#include "pch.h"
+
+#include "indirect_culling.h"
+
+namespace sandbox {
+	namespace {
+		// As is_instance_visible() in culling.hlsli; threads past the instance count see nothing
+		bool is_visible(const culling_scene& scene, std::size_t index)
+		{
+			if (index >= scene.instance_count)
+				return false;
+
+			const auto& [rows] = decode_transform(scene.encoding, scene.transforms, index);
+			const auto& [x, y, z] = scene.object_center;
+			const auto apply = [x, y, z](const std::array<float, 4>& row) {
+				return row[0] * x + row[1] * y + row[2] * z + row[3];
+			};
+
+			const auto get_axis_length = [&rows](std::size_t column) {
+				const auto a = rows[0][column];
+				const auto b = rows[1][column];
+				const auto c = rows[2][column];
+				return std::sqrt(a * a + b * b + c * c);
+			};
+
+			const vector3 center {apply(rows[0]), apply(rows[1]), apply(rows[2])};
+			const auto scale = std::max(get_axis_length(0), std::max(get_axis_length(1), get_axis_length(2)));
+			return is_sphere_visible(scene.planes, center, scene.object_radius * scale);
+		}
+
+		// Exclusive, as scan_group() in culling.hlsli leaves it for each thread once its own value is subtracted
+		void scan_exclusive(gsl::span<std::uint32_t> values) noexcept
+		{
+			std::uint32_t sum {};
+			for (auto& value : values)
+				sum += std::exchange(value, sum);
+		}
+	}
+}
+
+std::size_t sandbox::get_cull_group_count(std::size_t instance_count) noexcept
+{
+	return (instance_count + cull_group_size - 1) / cull_group_size;
+}
+
+sandbox::draw_range
+sandbox::append_draw_arguments(std::vector<draw_indexed_arguments>& arguments, gsl::span<const submesh> submeshes)
+{
+	const draw_range range {.first {arguments.size()}, .count {submeshes.size()}};
+	for (const auto& [first_index, index_count, base_vertex] : submeshes) {
+		arguments.push_back({
+			.index_count_per_instance {index_count},
+			.instance_count {},
+			.start_index_location {first_index},
+			.base_vertex_location {base_vertex},
+			.start_instance_location {}});
+	}
+
+	return range;
+}
+
+void sandbox::count_visible_groups(const culling_scene& scene, gsl::span<std::uint32_t> group_offsets)
+{
+	for (std::size_t group {}; group < get_cull_group_count(scene.instance_count); ++group) {
+		std::uint32_t count {};
+		for (std::size_t i {}; i < cull_group_size; ++i)
+			count += is_visible(scene, group * cull_group_size + i) ? 1 : 0;
+
+		group_offsets[group] = count;
+	}
+}
+
+std::uint32_t sandbox::scan_visible_groups(
+	gsl::span<std::uint32_t> group_offsets,
+	gsl::span<const draw_indexed_arguments> templates,
+	gsl::span<draw_indexed_arguments> arguments)
+{
+	// A chunk of groups per pass of the shader's loop, carrying the sum from one to the next
+	std::uint32_t total {};
+	for (std::size_t first {}; first < group_offsets.size(); first += cull_group_size) {
+		const auto chunk = group_offsets.subspan(first, std::min(cull_group_size, group_offsets.size() - first));
+		const auto chunk_total = std::reduce(chunk.begin(), chunk.end(), std::uint32_t {});
+		scan_exclusive(chunk);
+		for (auto& offset : chunk)
+			offset += total;
+
+		total += chunk_total;
+	}
+
+	// Every instance draws every object
+	for (std::size_t i {}; i < templates.size(); ++i) {
+		arguments[i] = templates[i];
+		arguments[i].instance_count = total;
+	}
+
+	return total;
+}
+
+void sandbox::scatter_visible_groups(
+	const culling_scene& scene,
+	gsl::span<const std::uint32_t> group_offsets,
+	gsl::span<std::uint32_t> visible)
+{
+	for (std::size_t group {}; group < get_cull_group_count(scene.instance_count); ++group) {
+		// Each thread's rank among the group's visible ones is how many come before it
+		auto rank = group_offsets[group];
+		for (std::size_t i {}; i < cull_group_size; ++i) {
+			const auto index = group * cull_group_size + i;
+			if (is_visible(scene, index))
+				visible[rank++] = gsl::narrow_cast<std::uint32_t>(index);
+		}
+	}
+}
+
+std::uint32_t sandbox::cull_indirect(
+	const culling_scene& scene,
+	gsl::span<const draw_indexed_arguments> templates,
+	gsl::span<draw_indexed_arguments> arguments,
+	gsl::span<std::uint32_t> visible)
+{
+	if (scene.transforms.size() / get_encoded_size(scene.encoding) < scene.instance_count)
+		throw std::invalid_argument {"encoded transform buffer is smaller than the instance count"};
+
+	if (arguments.size() < templates.size())
+		throw std::invalid_argument {"draw argument buffer is smaller than the templates"};
+
+	if (visible.size() < scene.instance_count)
+		throw std::invalid_argument {"visible index buffer is smaller than the instance count"};
+
+	std::vector<std::uint32_t> group_offsets(get_cull_group_count(scene.instance_count));
+	count_visible_groups(scene, group_offsets);
+	const auto total = scan_visible_groups(group_offsets, templates, arguments);
+	scatter_visible_groups(scene, group_offsets, visible);
+	return total;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "pch.h"
+
+#include "frustum_culling.h"
+#include "instance_transforms.h"
+#include "parallel_recording.h"
+#include "stream_format.h"
+
+namespace sandbox {
+	// Laid out as D3D12_DRAW_INDEXED_ARGUMENTS, so that ExecuteIndirect() can consume an array of them as is
+	struct draw_indexed_arguments {
+		std::uint32_t index_count_per_instance;
+		std::uint32_t instance_count;
+		std::uint32_t start_index_location;
+		std::int32_t base_vertex_location;
+		std::uint32_t start_instance_location;
+	};
+
+	// Instances tested by each thread group of the culling shaders; see culling.hlsli
+	constexpr std::size_t cull_group_size {64};
+
+	std::size_t get_cull_group_count(std::size_t instance_count) noexcept;
+
+	// Appends the arguments for drawing each submesh once, with no instances yet, and returns where they went; the
+	// scan pass fills in the instance count of every draw
+	draw_range
+	append_draw_arguments(std::vector<draw_indexed_arguments>& arguments, gsl::span<const submesh> submeshes);
+
+	// What the culling shaders read: the instances' transforms as encoded for them, and a sphere around every object
+	// in object space, which each decoded transform carries into world space, scaling the radius by the transform's
+	// longest axis
+	struct culling_scene {
+		frustum planes;
+		vector3 object_center;
+		float object_radius;
+		transform_encoding encoding;
+		gsl::span<const std::byte> transforms;
+		std::size_t instance_count;
+	};
+
+	// The culling shaders' passes, one thread group at a time, as a reference for them. Instances are culled by
+	// their bounding spheres, and those that survive are written out in ascending order.
+
+	// Writes the number of visible instances in each group to `group_offsets`
+	void count_visible_groups(const culling_scene& scene, gsl::span<std::uint32_t> group_offsets);
+
+	// Replaces each group's count with the number of visible instances before it, copies `templates` to `arguments`
+	// with every instance count set to the total, and returns that total
+	std::uint32_t scan_visible_groups(
+		gsl::span<std::uint32_t> group_offsets,
+		gsl::span<const draw_indexed_arguments> templates,
+		gsl::span<draw_indexed_arguments> arguments);
+
+	// Writes each group's visible instances to `visible`, starting at its offset
+	void scatter_visible_groups(
+		const culling_scene& scene,
+		gsl::span<const std::uint32_t> group_offsets,
+		gsl::span<std::uint32_t> visible);
+
+	// All three passes in order; throws std::invalid_argument unless the scene has a transform for every instance,
+	// `arguments` has room for the templates and `visible` for every instance
+	std::uint32_t cull_indirect(
+		const culling_scene& scene,
+		gsl::span<const draw_indexed_arguments> templates,
+		gsl::span<draw_indexed_arguments> arguments,
+		gsl::span<std::uint32_t> visible);
+}
@@ -0,0 +1,171 @@
+#include "pch.h"
+
+#include "instance_store.h"
+
+namespace sandbox {
+	namespace {
+		// Past this many ranges, a copy is cheaper to rewrite whole than piece by piece, and its pending ranges
+		// cannot grow without bound while it goes unused
+		std::size_t get_range_limit(std::size_t element_count) noexcept { return element_count / 8 + 16; }
+
+		// Sorts the ranges, merges overlapping and adjacent ones, and clips them to [0, element_count)
+		void normalize(std::vector<dirty_range>& ranges, std::size_t element_count)
+		{
+			std::ranges::sort(ranges, {}, &dirty_range::first);
+			std::vector<dirty_range> merged {};
+			for (const auto& [first, count] : ranges) {
+				const auto last = std::min(first + count, element_count);
+				if (first >= last)
+					continue;
+
+				if (!merged.empty() && first <= merged.back().first + merged.back().count) {
+					auto& previous = merged.back();
+					previous.count = std::max(previous.first + previous.count, last) - previous.first;
+				}
+				else {
+					merged.push_back({.first {first}, .count {last - first}});
+				}
+			}
+
+			ranges = std::move(merged);
+		}
+	}
+}
+
+sandbox::instance_store::instance_store(std::size_t copy_count) :
+	m_transforms {},
+	m_element_slots {},
+	m_slots {},
+	m_free_slots {},
+	m_dirty_elements {},
+	m_pending_ranges(copy_count)
+{
+}
+
+sandbox::instance_handle sandbox::instance_store::add(const instance_transform& transform)
+{
+	const auto element = gsl::narrow<std::uint32_t>(m_transforms.size());
+	if (element == no_element)
+		throw std::length_error {"too many instances"};
+
+	// Whatever throws is undone, so that a failed add leaves the store as it was; a dirty mark past the end of the
+	// array is harmless, since ranges are clipped to it
+	mark_dirty(element);
+	const auto new_slot = m_free_slots.empty();
+	const auto slot = new_slot ? gsl::narrow<std::uint32_t>(m_slots.size()) : m_free_slots.back();
+	if (new_slot)
+		m_slots.push_back({.element {no_element}, .generation {}});
+
+	try {
+		m_transforms.push_back(transform);
+		m_element_slots.push_back(slot);
+	}
+	catch (...) {
+		m_transforms.resize(element);
+		if (new_slot)
+			m_slots.pop_back();
+
+		throw;
+	}
+
+	if (!new_slot)
+		m_free_slots.pop_back();
+
+	auto& [slot_element, generation] = m_slots.at(slot);
+	slot_element = element;
+	return {.slot {slot}, .generation {generation}};
+}
+
+bool sandbox::instance_store::remove(instance_handle instance)
+{
+	if (!contains(instance))
+		return false;
+
+	// Swapped with the last element, so that the array stays dense; everything that can throw comes first
+	auto& removed = m_slots.at(instance.slot);
+	const auto hole = removed.element;
+	const auto last = gsl::narrow_cast<std::uint32_t>(m_transforms.size() - 1);
+	if (hole != last)
+		mark_dirty(hole);
+
+	m_free_slots.push_back(instance.slot);
+	if (hole != last) {
+		const auto moved_slot = m_element_slots.at(last);
+		m_transforms.at(hole) = m_transforms.at(last);
+		m_element_slots.at(hole) = moved_slot;
+		m_slots.at(moved_slot).element = hole;
+	}
+
+	m_transforms.pop_back();
+	m_element_slots.pop_back();
+	removed.element = no_element;
+	++removed.generation;
+	return true;
+}
+
+bool sandbox::instance_store::update(instance_handle instance, const instance_transform& transform)
+{
+	if (!contains(instance))
+		return false;
+
+	const auto element = m_slots.at(instance.slot).element;
+	mark_dirty(element);
+	m_transforms.at(element) = transform;
+	return true;
+}
+
+bool sandbox::instance_store::contains(instance_handle instance) const noexcept
+{
+	if (instance.slot >= m_slots.size())
+		return false;
+
+	const auto& [element, generation] = m_slots[instance.slot];
+	return element != no_element && generation == instance.generation;
+}
+
+std::vector<sandbox::dirty_range> sandbox::instance_store::take_dirty_ranges(std::size_t copy)
+{
+	// Normalized in place, so that the ranges stay pending if this throws
+	publish_dirty_elements();
+	auto& pending = m_pending_ranges.at(copy);
+	normalize(pending, m_transforms.size());
+	return std::exchange(pending, {});
+}
+
+void sandbox::instance_store::invalidate(std::size_t copy)
+{
+	m_pending_ranges.at(copy) = {{.first {}, .count {m_transforms.size()}}};
+}
+
+void sandbox::instance_store::mark_dirty(std::uint32_t element)
+{
+	// Published early if no copy has been brought up to date in a while, which bounds the list's size
+	m_dirty_elements.push_back(element);
+	if (m_dirty_elements.size() > m_transforms.size() + 64)
+		publish_dirty_elements();
+}
+
+void sandbox::instance_store::publish_dirty_elements()
+{
+	if (m_dirty_elements.empty())
+		return;
+
+	std::ranges::sort(m_dirty_elements);
+	std::vector<dirty_range> ranges {};
+	for (const auto element : m_dirty_elements) {
+		if (ranges.empty() || element > ranges.back().first + ranges.back().count)
+			ranges.push_back({.first {element}, .count {1}});
+		else if (element == ranges.back().first + ranges.back().count)
+			++ranges.back().count;
+	}
+
+	const auto element_count = m_transforms.size();
+	for (auto& pending : m_pending_ranges) {
+		if (pending.size() + ranges.size() > get_range_limit(element_count))
+			pending = {{.first {}, .count {element_count}}};
+		else
+			pending.insert(pending.end(), ranges.begin(), ranges.end());
+	}
+
+	m_dirty_elements.clear();
+}
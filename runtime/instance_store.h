@@ -0,0 +1,68 @@
+#pragma once
+
+#include "pch.h"
+
+#include "instance_transforms.h"
+
+namespace sandbox {
+	// Slots are reused, so the generation tells a handle to a removed instance apart from one added in its place
+	struct instance_handle {
+		std::uint32_t slot;
+		std::uint32_t generation;
+
+		bool operator==(const instance_handle&) const noexcept = default;
+	};
+
+	// Elements [first, first + count) of the instance array
+	struct dirty_range {
+		std::size_t first;
+		std::size_t count;
+
+		bool operator==(const dirty_range&) const noexcept = default;
+	};
+
+	// Keeps instances packed densely, in no particular order, so that the array can be uploaded and indexed as is;
+	// removing an instance moves the last one into its place. Changes are tracked separately for each of `copy_count`
+	// copies of the array, each of which only catches up when it is next brought up to date.
+	class instance_store {
+	public:
+		explicit instance_store(std::size_t copy_count);
+
+		// Stale handles are ignored, and make remove() and update() return false. If any of the three throw, such as
+		// when memory runs out, the instances are left as they were, though more of them may be marked as changed.
+		instance_handle add(const instance_transform& transform);
+		bool remove(instance_handle instance);
+		bool update(instance_handle instance, const instance_transform& transform);
+
+		bool contains(instance_handle instance) const noexcept;
+		std::size_t size() const noexcept { return m_transforms.size(); }
+		gsl::span<const instance_transform> transforms() const noexcept { return m_transforms; }
+
+		// The parts of the array that changed since `copy` was last brought up to date, in ascending order, disjoint,
+		// non-adjacent and within size(); the copy is considered up to date afterwards
+		std::vector<dirty_range> take_dirty_ranges(std::size_t copy);
+
+		// Marks the whole array as changed for `copy`, such as when it has been reallocated
+		void invalidate(std::size_t copy);
+
+	private:
+		static constexpr auto no_element = std::numeric_limits<std::uint32_t>::max();
+
+		struct slot {
+			std::uint32_t element; // no_element while the slot is free
+			std::uint32_t generation;
+		};
+
+		std::vector<instance_transform> m_transforms;
+		std::vector<std::uint32_t> m_element_slots; // Of each element, so that moved elements can update theirs
+		std::vector<slot> m_slots;
+		std::vector<std::uint32_t> m_free_slots;
+
+		// Elements changed since dirty ranges were last taken for any copy, possibly repeated
+		std::vector<std::uint32_t> m_dirty_elements;
+		std::vector<std::vector<dirty_range>> m_pending_ranges; // Of each copy
+
+		void mark_dirty(std::uint32_t element);
+		void publish_dirty_elements();
+	};
+}
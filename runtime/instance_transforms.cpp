@@ -0,0 +1,276 @@
+#include "pch.h"
+
+#include "instance_transforms.h"
+
+#include "half_float.h"
+
+namespace sandbox {
+	namespace {
+		// The kernels below load straight from the members, in declaration order
+		static_assert(sizeof(instance_transform) == 10 * sizeof(float));
+		static_assert(sizeof(affine_transform) == 12 * sizeof(float));
+		static_assert(sizeof(packed_transform) == 28);
+
+		std::int16_t to_snorm16(float value) noexcept
+		{
+			return gsl::narrow_cast<std::int16_t>(std::nearbyint(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		// Computed in the same order as the vector kernel, so that both agree exactly
+		affine_transform get_affine(const instance_transform& transform) noexcept
+		{
+			const auto& [x, y, z, w] = transform.rotation;
+			const auto& [sx, sy, sz] = transform.scale;
+			const auto& [tx, ty, tz] = transform.translation;
+			const auto x2 = x + x;
+			const auto y2 = y + y;
+			const auto z2 = z + z;
+			const auto xx = x * x2;
+			const auto yy = y * y2;
+			const auto zz = z * z2;
+			const auto xy = x * y2;
+			const auto xz = x * z2;
+			const auto yz = y * z2;
+			const auto wx = w * x2;
+			const auto wy = w * y2;
+			const auto wz = w * z2;
+			return {
+				.rows {{
+					{(1.0f - (yy + zz)) * sx, (xy - wz) * sy, (xz + wy) * sz, tx},
+					{(xy + wz) * sx, (1.0f - (xx + zz)) * sy, (yz - wx) * sz, ty},
+					{(xz - wy) * sx, (yz + wx) * sy, (1.0f - (xx + yy)) * sz, tz},
+				}}};
+		}
+
+		packed_transform get_packed(const instance_transform& transform) noexcept
+		{
+			const auto& [x, y, z, w] = transform.rotation;
+			const auto& [sx, sy, sz] = transform.scale;
+			return {
+				.rotation {to_snorm16(x), to_snorm16(y), to_snorm16(z), to_snorm16(w)},
+				.scale {to_half(sx), to_half(sy), to_half(sz), 0},
+				.translation {transform.translation}};
+		}
+
+		// The rotation is renormalized, since quantizing it loses its unit length
+		instance_transform get_unpacked(const packed_transform& packed) noexcept
+		{
+			std::array<float, 4> rotation {};
+			std::ranges::transform(packed.rotation, rotation.begin(), [](std::int16_t value) {
+				return std::max(gsl::narrow_cast<float>(value) / 32767.0f, -1.0f);
+			});
+
+			const auto& [x, y, z, w] = rotation;
+			const auto length = std::sqrt(x * x + y * y + z * z + w * w);
+			const auto& [sx, sy, sz, padding] = packed.scale;
+			return {
+				.rotation {x / length, y / length, z / length, w / length},
+				.scale {from_half(sx), from_half(sy), from_half(sz)},
+				.translation {packed.translation}};
+		}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		constexpr std::size_t block_size {4};
+
+		// Transposed into structure-of-arrays form on the way in, so that each lane computes one transform, and back on
+		// the way out
+		GSL_SUPPRESS(bounds .1)
+		void pack_affine_block(const instance_transform* transforms, affine_transform* packed) noexcept
+		{
+			auto x = _mm_loadu_ps(&transforms[0].rotation.x);
+			auto y = _mm_loadu_ps(&transforms[1].rotation.x);
+			auto z = _mm_loadu_ps(&transforms[2].rotation.x);
+			auto w = _mm_loadu_ps(&transforms[3].rotation.x);
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			// (scale.x, scale.y, scale.z, translation.x), then (scale.z, translation.x, translation.y, translation.z)
+			auto sx = _mm_loadu_ps(&transforms[0].scale.x);
+			auto sy = _mm_loadu_ps(&transforms[1].scale.x);
+			auto sz = _mm_loadu_ps(&transforms[2].scale.x);
+			auto tx = _mm_loadu_ps(&transforms[3].scale.x);
+			_MM_TRANSPOSE4_PS(sx, sy, sz, tx);
+			auto unused_sz = _mm_loadu_ps(&transforms[0].scale.z);
+			auto unused_tx = _mm_loadu_ps(&transforms[1].scale.z);
+			auto ty = _mm_loadu_ps(&transforms[2].scale.z);
+			auto tz = _mm_loadu_ps(&transforms[3].scale.z);
+			_MM_TRANSPOSE4_PS(unused_sz, unused_tx, ty, tz);
+
+			const auto one = _mm_set1_ps(1.0f);
+			const auto x2 = _mm_add_ps(x, x);
+			const auto y2 = _mm_add_ps(y, y);
+			const auto z2 = _mm_add_ps(z, z);
+			const auto xx = _mm_mul_ps(x, x2);
+			const auto yy = _mm_mul_ps(y, y2);
+			const auto zz = _mm_mul_ps(z, z2);
+			const auto xy = _mm_mul_ps(x, y2);
+			const auto xz = _mm_mul_ps(x, z2);
+			const auto yz = _mm_mul_ps(y, z2);
+			const auto wx = _mm_mul_ps(w, x2);
+			const auto wy = _mm_mul_ps(w, y2);
+			const auto wz = _mm_mul_ps(w, z2);
+
+			auto m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+			auto m01 = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+			auto m02 = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+			auto m10 = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+			auto m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+			auto m12 = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+			auto m20 = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+			auto m21 = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+			auto m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+			_MM_TRANSPOSE4_PS(m00, m01, m02, tx);
+			_MM_TRANSPOSE4_PS(m10, m11, m12, ty);
+			_MM_TRANSPOSE4_PS(m20, m21, m22, tz);
+
+			// Each register now holds a row of one transform; stored in order, since the destination may be
+			// write-combined
+			const std::array rows {m00, m10, m20, m01, m11, m21, m02, m12, m22, tx, ty, tz};
+			for (std::size_t i {}; i < rows.size(); ++i)
+				_mm_storeu_ps(packed[i / 3].rows[i % 3].data(), rows[i]);
+		}
+
+		GSL_SUPPRESS(type .1) // The rotation and scale are stored together, as one 16-byte write
+		void pack_quantized_one(const instance_transform& transform, packed_transform& packed) noexcept
+		{
+			const auto unclamped = _mm_loadu_ps(&transform.rotation.x);
+			const auto rotation = _mm_min_ps(_mm_max_ps(unclamped, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+			const auto snorm = _mm_cvtps_epi32(_mm_mul_ps(rotation, _mm_set1_ps(32767.0f)));
+
+			// The fourth lane holds translation.x, and is zeroed as padding
+			const auto scale = _mm_and_ps(
+				_mm_loadu_ps(&transform.scale.x),
+				_mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+			const auto half = _mm_cvtps_ph(scale, _MM_FROUND_TO_NEAREST_INT);
+#else
+			std::array<float, 4> scale_values {};
+			_mm_storeu_ps(scale_values.data(), scale);
+			std::array<std::uint16_t, 8> half_values {};
+			std::ranges::transform(scale_values, half_values.begin(), to_half);
+			const auto half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(half_values.data()));
+#endif
+
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(packed.rotation.data()),
+				_mm_unpacklo_epi64(_mm_packs_epi32(snorm, snorm), half));
+
+			packed.translation = transform.translation;
+		}
+#endif
+	}
+}
+
+std::size_t sandbox::get_encoded_size(transform_encoding encoding)
+{
+	switch (encoding) {
+	case transform_encoding::affine:
+		return sizeof(affine_transform);
+
+	case transform_encoding::packed:
+		return sizeof(packed_transform);
+
+	default:
+		throw std::invalid_argument {"unknown transform encoding"};
+	}
+}
+
+GSL_SUPPRESS(type .1) // The encoded buffer is untyped, typically mapped upload memory
+void sandbox::encode_transforms(
+	transform_encoding encoding,
+	gsl::span<const instance_transform> transforms,
+	gsl::span<std::byte> encoded)
+{
+	if (encoded.size() / get_encoded_size(encoding) < transforms.size())
+		throw std::invalid_argument {"encoded transform buffer is too small"};
+
+	if (encoding == transform_encoding::affine)
+		pack_affine(transforms, {reinterpret_cast<affine_transform*>(encoded.data()), transforms.size()});
+	else
+		pack_quantized(transforms, {reinterpret_cast<packed_transform*>(encoded.data()), transforms.size()});
+}
+
+sandbox::affine_transform
+sandbox::decode_transform(transform_encoding encoding, gsl::span<const std::byte> encoded, std::size_t index)
+{
+	const auto encoded_size = get_encoded_size(encoding);
+	if (index >= encoded.size() / encoded_size)
+		throw std::out_of_range {"encoded transform index out of range"};
+
+	const auto bytes = encoded.subspan(index * encoded_size, encoded_size);
+	if (encoding == transform_encoding::affine) {
+		affine_transform transform {};
+		std::memcpy(&transform, bytes.data(), encoded_size);
+		return transform;
+	}
+
+	packed_transform packed {};
+	std::memcpy(&packed, bytes.data(), encoded_size);
+	return get_affine(get_unpacked(packed));
+}
+
+void sandbox::pack_affine(gsl::span<const instance_transform> transforms, gsl::span<affine_transform> packed)
+{
+	if (packed.size() < transforms.size())
+		throw std::invalid_argument {"packed transform buffer is too small"};
+
+	std::size_t first {};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	for (; first + block_size <= transforms.size(); first += block_size)
+		pack_affine_block(&transforms[first], &packed[first]);
+#endif
+
+	for (; first < transforms.size(); ++first)
+		packed[first] = get_affine(transforms[first]);
+}
+
+void sandbox::pack_quantized(gsl::span<const instance_transform> transforms, gsl::span<packed_transform> packed)
+{
+	if (packed.size() < transforms.size())
+		throw std::invalid_argument {"packed transform buffer is too small"};
+
+	for (std::size_t i {}; i < transforms.size(); ++i) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		pack_quantized_one(transforms[i], packed[i]);
+#else
+		packed[i] = get_packed(transforms[i]);
+#endif
+	}
+}
+
+void sandbox::pack_affine_scalar(gsl::span<const instance_transform> transforms, gsl::span<affine_transform> packed)
+{
+	if (packed.size() < transforms.size())
+		throw std::invalid_argument {"packed transform buffer is too small"};
+
+	for (std::size_t i {}; i < transforms.size(); ++i)
+		packed[i] = get_affine(transforms[i]);
+}
+
+void sandbox::pack_quantized_scalar(
+	gsl::span<const instance_transform> transforms,
+	gsl::span<packed_transform> packed)
+{
+	if (packed.size() < transforms.size())
+		throw std::invalid_argument {"packed transform buffer is too small"};
+
+	for (std::size_t i {}; i < transforms.size(); ++i)
+		packed[i] = get_packed(transforms[i]);
+}
+
+sandbox::vector3 sandbox::transform_point(const instance_transform& transform, const vector3& point) noexcept
+{
+	const auto& [rows] = get_affine(transform);
+	const auto& [x, y, z] = point;
+	const auto apply = [x, y, z](const std::array<float, 4>& row) {
+		return row[0] * x + row[1] * y + row[2] * z + row[3];
+	};
+
+	return {apply(rows[0]), apply(rows[1]), apply(rows[2])};
+}
+
+float sandbox::get_max_scale(const instance_transform& transform) noexcept
+{
+	const auto& [x, y, z] = transform.scale;
+	return std::max({std::abs(x), std::abs(y), std::abs(z)});
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "pch.h"
+
+#include "stream_format.h"
+
+namespace sandbox {
+	struct quaternion {
+		float x;
+		float y;
+		float z;
+		float w;
+	};
+
+	// Scales, then rotates, then translates; the rotation is unit length
+	struct instance_transform {
+		quaternion rotation;
+		vector3 scale;
+		vector3 translation;
+	};
+
+	// The rows of a 3x4 matrix that takes (x, y, z, 1) in object space to world space
+	struct affine_transform {
+		std::array<std::array<float, 4>, 3> rows;
+	};
+
+	// The rotation as 16-bit SNORM and the scale as half-precision floats (the last of which is padding), but the
+	// translation at full precision, since it is what large worlds need the most range in; 28 bytes rather than 48
+	struct packed_transform {
+		std::array<std::int16_t, 4> rotation;
+		std::array<std::uint16_t, 4> scale;
+		vector3 translation;
+	};
+
+	// Shared with the vertex shaders, which decode the instance buffer accordingly
+	enum class transform_encoding : std::uint32_t {
+		affine,
+		packed
+	};
+
+	std::size_t get_encoded_size(transform_encoding encoding);
+
+	// Writes `transforms` to `encoded` in the given encoding, which must have room for all of them; `encoded` may be
+	// write-combined memory, since it is only ever written to in order
+	void encode_transforms(
+		transform_encoding encoding,
+		gsl::span<const instance_transform> transforms,
+		gsl::span<std::byte> encoded);
+
+	// The matrix the shaders build from the `index`th transform in `encoded`, as load_instance_transform() in
+	// instance_transforms.hlsli does, as a reference for it; throws std::out_of_range past the end of `encoded`
+	affine_transform
+	decode_transform(transform_encoding encoding, gsl::span<const std::byte> encoded, std::size_t index);
+
+	void pack_affine(gsl::span<const instance_transform> transforms, gsl::span<affine_transform> packed);
+	void pack_quantized(gsl::span<const instance_transform> transforms, gsl::span<packed_transform> packed);
+
+	// One transform at a time, as references for pack_affine() and pack_quantized()
+	void pack_affine_scalar(gsl::span<const instance_transform> transforms, gsl::span<affine_transform> packed);
+	void pack_quantized_scalar(gsl::span<const instance_transform> transforms, gsl::span<packed_transform> packed);
+
+	vector3 transform_point(const instance_transform& transform, const vector3& point) noexcept;
+
+	// Of the absolute scale factors, so that a transformed sphere can be bounded by scaling its radius
+	float get_max_scale(const instance_transform& transform) noexcept;
+}
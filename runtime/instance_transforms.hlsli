@@ -0,0 +1,53 @@
+// Laid out as affine_transform or packed_transform in instance_transforms.h, according to the transform_encoding
+// constant
+ByteAddressBuffer instance_transforms : register(t0);
+
+// See transform_encoding in instance_transforms.h
+static const uint affine_encoding = 0;
+static const uint packed_encoding = 1;
+
+// The rows of the matrix taking object space to world space
+float3x4 load_instance_transform(uint instance, uint encoding)
+{
+	if (encoding == affine_encoding) {
+		const uint address = instance * 48;
+		return float3x4(
+			asfloat(instance_transforms.Load4(address)),
+			asfloat(instance_transforms.Load4(address + 16)),
+			asfloat(instance_transforms.Load4(address + 32)));
+	}
+
+	// Two 16-bit fields to a word, low half first; shifting up then back down sign-extends the SNORM ones
+	const uint address = instance * 28;
+	const uint4 packed = instance_transforms.Load4(address);
+	const float3 translation = asfloat(instance_transforms.Load3(address + 16));
+	const int4 snorm = int4(packed.x << 16, packed.x, packed.y << 16, packed.y) >> 16;
+	const float4 rotation = normalize(max(float4(snorm) / 32767.0, -1.0));
+	const float3 scale = f16tof32(uint3(packed.z, packed.z >> 16, packed.w));
+
+	// As in get_affine() in instance_transforms.cpp
+	const float3 doubled = rotation.xyz + rotation.xyz;
+	const float xx = rotation.x * doubled.x;
+	const float yy = rotation.y * doubled.y;
+	const float zz = rotation.z * doubled.z;
+	const float xy = rotation.x * doubled.y;
+	const float xz = rotation.x * doubled.z;
+	const float yz = rotation.y * doubled.z;
+	const float wx = rotation.w * doubled.x;
+	const float wy = rotation.w * doubled.y;
+	const float wz = rotation.w * doubled.z;
+	return float3x4(
+		float4((1.0 - (yy + zz)) * scale.x, (xy - wz) * scale.y, (xz + wy) * scale.z, translation.x),
+		float4((xy + wz) * scale.x, (1.0 - (xx + zz)) * scale.y, (yz - wx) * scale.z, translation.y),
+		float4((xz - wy) * scale.x, (yz + wx) * scale.y, (1.0 - (xx + yy)) * scale.z, translation.z));
+}
+
+// By the cofactor matrix, which is the inverse transpose up to scale, so that normals stay perpendicular to their
+// surfaces under non-uniform scale
+float3 transform_normal(float3x4 transform, float3 normal)
+{
+	const float3 x = transform._m00_m10_m20;
+	const float3 y = transform._m01_m11_m21;
+	const float3 z = transform._m02_m12_m22;
+	return normalize(normal.x * cross(y, z) + normal.y * cross(z, x) + normal.z * cross(x, y));
+}
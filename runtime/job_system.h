@@ -0,0 +1,354 @@
+#pragma once
+
+// Shared with the importer, so it relies on the including project's precompiled header
+
+namespace sandbox {
+	// A fixed-capacity Chase-Lev deque: its owner pushes and pops at the bottom, while any thread may steal from the
+	// top. Values are pointers, and the deque never owns what they point to.
+	template <typename value_type, std::size_t capacity>
+	class work_stealing_deque {
+		static_assert(std::has_single_bit(capacity), "capacity must be a power of two");
+
+	public:
+		work_stealing_deque() noexcept = default;
+
+		work_stealing_deque(const work_stealing_deque&) = delete;
+		work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+		work_stealing_deque(work_stealing_deque&&) = delete;
+		work_stealing_deque& operator=(work_stealing_deque&&) = delete;
+
+		// Owner only; fails if the deque is full
+		bool push(value_type* value) noexcept
+		{
+			const auto bottom = m_bottom.load(std::memory_order_relaxed);
+			const auto top = m_top.load(std::memory_order_acquire);
+			if (bottom - top >= std::int64_t {capacity})
+				return false;
+
+			// Sequentially consistent so that a submitter checking for sleeping workers afterwards cannot miss one
+			// that has just found the deque empty
+			slot(bottom).store(value, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_seq_cst);
+			return true;
+		}
+
+		// Owner only; returns the most recently pushed value, or null if the deque is empty
+		value_type* pop() noexcept
+		{
+			// The store and load must not be reordered, or the owner and a thief could both take the last value
+			const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_seq_cst);
+			auto top = m_top.load(std::memory_order_seq_cst);
+			if (top > bottom) {
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			auto value = slot(bottom).load(std::memory_order_relaxed);
+			if (top == bottom) {
+				// Racing thieves for the last value
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					value = nullptr;
+
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+
+			return value;
+		}
+
+		// Any thread; returns the least recently pushed value, or null if the deque is empty or another thread won
+		// the race for it
+		value_type* steal() noexcept
+		{
+			auto top = m_top.load(std::memory_order_seq_cst);
+			const auto bottom = m_bottom.load(std::memory_order_seq_cst);
+			if (top >= bottom)
+				return nullptr;
+
+			const auto value = slot(top).load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+
+			return value;
+		}
+
+		bool empty() const noexcept
+		{
+			return m_bottom.load(std::memory_order_seq_cst) <= m_top.load(std::memory_order_seq_cst);
+		}
+
+	private:
+		static constexpr std::size_t cache_line_size {64};
+
+		alignas(cache_line_size) std::atomic<std::int64_t> m_top {};
+		alignas(cache_line_size) std::atomic<std::int64_t> m_bottom {};
+		alignas(cache_line_size) std::array<std::atomic<value_type*>, capacity> m_slots {};
+
+		std::atomic<value_type*>& slot(std::int64_t index) noexcept
+		{
+			return m_slots[gsl::narrow_cast<std::size_t>(index) & (capacity - 1)];
+		}
+	};
+
+	// Counts the jobs run against it that have yet to finish. A job that depends on others waits on their counter,
+	// helping with other work in the meantime; the counter must outlive every job run against it.
+	class job_counter {
+	public:
+		job_counter() noexcept = default;
+
+		job_counter(const job_counter&) = delete;
+		job_counter& operator=(const job_counter&) = delete;
+		job_counter(job_counter&&) = delete;
+		job_counter& operator=(job_counter&&) = delete;
+
+		bool is_done() const noexcept { return m_pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class job_system;
+
+		std::atomic<std::size_t> m_pending {};
+		std::atomic_flag m_failed {};
+		std::exception_ptr m_error {}; // Of the first job to throw; only read once every job has finished
+	};
+
+	// Runs jobs on a fixed set of worker threads, each with its own deque that idle workers steal from. Threads that
+	// are not workers submit through a shared queue instead, and execute jobs themselves while they wait.
+	//
+	// Jobs must not block on anything but job counters, and every counter must have been waited on before the
+	// system is destroyed. If a worker's deque is full, jobs it submits are run immediately instead of being queued.
+	class job_system {
+	public:
+		using job_function = std::function<void()>;
+
+		explicit job_system(unsigned int worker_count) :
+			m_deques {},
+			m_injection_mutex {},
+			m_injected_jobs {},
+			m_injected_count {},
+			m_sleep_mutex {},
+			m_wake {},
+			m_sleeping_count {},
+			m_wake_epoch {},
+			m_workers {}
+		{
+			for (unsigned int i {}; i < worker_count; ++i)
+				m_deques.emplace_back(std::make_unique<job_deque>());
+
+			for (unsigned int i {}; i < worker_count; ++i)
+				m_workers.emplace_back([this, i](std::stop_token stop) { run_worker(stop, i); });
+		}
+
+		~job_system() noexcept
+		{
+			for (auto& worker : m_workers)
+				worker.request_stop();
+
+			// The workers must not miss the stop request between checking it and going to sleep
+			const std::lock_guard lock {m_sleep_mutex};
+		}
+
+		job_system(const job_system&) = delete;
+		job_system& operator=(const job_system&) = delete;
+		job_system(job_system&&) = delete;
+		job_system& operator=(job_system&&) = delete;
+
+		// Including the thread that waits
+		unsigned int thread_count() const noexcept { return gsl::narrow_cast<unsigned int>(m_workers.size() + 1); }
+
+		void run(job_counter& counter, job_function work)
+		{
+			auto new_job = std::make_unique<job>(std::move(work), &counter);
+			counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+			if (t_current_worker.system == this) {
+				if (!m_deques[t_current_worker.index]->push(new_job.get())) {
+					execute(new_job.release());
+					return;
+				}
+			}
+			else {
+				const std::lock_guard lock {m_injection_mutex};
+				m_injected_jobs.emplace_back(new_job.get());
+				m_injected_count.fetch_add(1, std::memory_order_seq_cst);
+			}
+
+			new_job.release();
+			wake_worker();
+		}
+
+		// Executes other jobs until every job run against `counter` has finished, then rethrows the first exception
+		// any of them threw
+		void wait(job_counter& counter)
+		{
+			while (!counter.is_done()) {
+				if (const auto next_job = find_job())
+					execute(next_job);
+				else
+					std::this_thread::yield();
+			}
+
+			if (counter.m_failed.test()) {
+				counter.m_failed.clear();
+				std::rethrow_exception(std::exchange(counter.m_error, nullptr));
+			}
+		}
+
+		// Calls function(first, last, slice) over `slice_count` contiguous slices of [0, count), running the first
+		// slice on the calling thread
+		template <typename function_type>
+		void parallel_for(std::size_t count, std::size_t slice_count, const function_type& function)
+		{
+			job_counter counter {};
+			for (std::size_t slice {1}; slice < slice_count; ++slice) {
+				const auto first = count * slice / slice_count;
+				const auto last = count * (slice + 1) / slice_count;
+				run(counter, [&function, first, last, slice] { function(first, last, slice); });
+			}
+
+			// The other slices refer to `function`, so they must finish even if this one throws
+			std::exception_ptr error {};
+			try {
+				if (slice_count != 0)
+					function(0, count / slice_count, 0);
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+
+			wait(counter);
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+	private:
+		struct job {
+			job_function work;
+			job_counter* counter;
+		};
+
+		struct worker_identity {
+			const job_system* system;
+			std::size_t index;
+		};
+
+		static constexpr std::size_t deque_capacity {4096};
+		static constexpr unsigned int idle_spin_count {64};
+
+		using job_deque = work_stealing_deque<job, deque_capacity>;
+
+		static inline thread_local worker_identity t_current_worker {};
+
+		std::vector<std::unique_ptr<job_deque>> m_deques;
+
+		std::mutex m_injection_mutex;
+		std::deque<job*> m_injected_jobs;
+		std::atomic<std::size_t> m_injected_count;
+
+		std::mutex m_sleep_mutex;
+		std::condition_variable_any m_wake;
+		std::atomic<unsigned int> m_sleeping_count;
+		std::uint64_t m_wake_epoch;
+
+		// Declared last, so that the workers are stopped and joined before anything they use is destroyed
+		std::vector<std::jthread> m_workers;
+
+		static void execute(job* finished_job) noexcept
+		{
+			const std::unique_ptr<job> owned_job {finished_job};
+			auto& counter = *owned_job->counter;
+			try {
+				owned_job->work();
+			}
+			catch (...) {
+				if (!counter.m_failed.test_and_set())
+					counter.m_error = std::current_exception();
+			}
+
+			counter.m_pending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		job* find_job()
+		{
+			const auto is_worker = t_current_worker.system == this;
+			const auto own_index = is_worker ? t_current_worker.index : 0;
+			if (is_worker) {
+				if (const auto own_job = m_deques[own_index]->pop())
+					return own_job;
+			}
+
+			if (m_injected_count.load(std::memory_order_seq_cst) != 0) {
+				const std::lock_guard lock {m_injection_mutex};
+				if (!m_injected_jobs.empty()) {
+					const auto injected_job = m_injected_jobs.front();
+					m_injected_jobs.pop_front();
+					m_injected_count.fetch_sub(1, std::memory_order_relaxed);
+					return injected_job;
+				}
+			}
+
+			// Victims are visited starting from the next worker along, so that thieves spread out
+			const auto deque_count = m_deques.size();
+			for (std::size_t i {1}; i <= deque_count; ++i) {
+				const auto victim = (own_index + i) % deque_count;
+				if (is_worker && victim == own_index)
+					continue;
+
+				if (const auto stolen_job = m_deques[victim]->steal())
+					return stolen_job;
+			}
+
+			return nullptr;
+		}
+
+		bool has_work() const noexcept
+		{
+			if (m_injected_count.load(std::memory_order_seq_cst) != 0)
+				return true;
+
+			return std::ranges::any_of(m_deques, [](const auto& jobs) { return !jobs->empty(); });
+		}
+
+		void wake_worker()
+		{
+			// Pairs with the sleeping count being raised before a worker's last look for work
+			if (m_sleeping_count.load(std::memory_order_seq_cst) == 0)
+				return;
+
+			{
+				const std::lock_guard lock {m_sleep_mutex};
+				++m_wake_epoch;
+			}
+
+			m_wake.notify_one();
+		}
+
+		void run_worker(std::stop_token stop, std::size_t index)
+		{
+			t_current_worker = {.system {this}, .index {index}};
+			unsigned int idle_count {};
+			while (!stop.stop_requested()) {
+				if (const auto next_job = find_job()) {
+					execute(next_job);
+					idle_count = 0;
+					continue;
+				}
+
+				if (++idle_count < idle_spin_count) {
+					std::this_thread::yield();
+					continue;
+				}
+
+				idle_count = 0;
+				std::unique_lock lock {m_sleep_mutex};
+				m_sleeping_count.fetch_add(1, std::memory_order_seq_cst);
+				const auto epoch = m_wake_epoch;
+				lock.unlock();
+				const auto found_work = has_work();
+				lock.lock();
+				if (!found_work)
+					m_wake.wait(lock, stop, [this, epoch] { return m_wake_epoch != epoch; });
+
+				m_sleeping_count.fetch_sub(1, std::memory_order_seq_cst);
+			}
+		}
+	};
+}
@@ -1,6 +1,8 @@
 ﻿#include "pch.h"
 
 #include "graphics_engine_state.h"
+#include "simulation_clock.h"
+#include "spsc_queue.h"
 
 namespace sandbox {
 	namespace {
@@ -24,45 +26,79 @@ namespace sandbox {
 			input_event_type type;
 			WPARAM w;
 			LPARAM l;
+			std::chrono::steady_clock::time_point time;
 		};
 
-		struct host_client_data {
-			std::vector<input_event> input_events;
-			bool exit_requested;
-			bool size_invalidated;
+		// GetMessageTime() only has the resolution of the system tick, but accounts for time spent in the queue
+		std::chrono::steady_clock::time_point get_message_time() noexcept
+		{
+			const std::chrono::milliseconds queued {GetTickCount() - gsl::narrow_cast<DWORD>(GetMessageTime())};
+			return std::chrono::steady_clock::now() - queued;
+		}
+
+		// From the earliest input handled in a frame to the return of that frame's Present()
+		struct input_latency {
+			std::uint64_t sample_count;
+			std::chrono::steady_clock::duration last;
+			std::chrono::steady_clock::duration longest;
+			std::chrono::steady_clock::duration total;
 		};
 
-		void reset(host_client_data& client_data) noexcept
+		void record(input_latency& latency, std::chrono::steady_clock::duration sample) noexcept
 		{
-			client_data.input_events.clear();
-			client_data.exit_requested = false;
-			client_data.size_invalidated = false;
+			++latency.sample_count;
+			latency.last = sample;
+			latency.longest = std::max(latency.longest, sample);
+			latency.total += sample;
 		}
 
+		// Shared between the UI host thread, which produces events, and the client thread, which consumes them. Exit
+		// requests, size changes and losses of focus are flags, so that they are never lost; input events go through a
+		// ring, and are counted and dropped if the client falls that far behind, which releases every key.
 		class host_atomic_state {
 		public:
 			host_atomic_state() noexcept :
-				m_client_data {},
-				m_for_host {&m_client_data.front()},
-				m_for_client {&m_client_data.back()}
+				m_input_events {},
+				m_dropped_event_count {},
+				m_exit_requested {},
+				m_size_invalidated {},
+				m_keys_released {}
 			{
 			}
 
-			const auto& swap_buffers()
+			void enqueue(const input_event& event) noexcept
 			{
-				std::swap(m_for_host, m_for_client);
-				reset(*m_for_host);
-				return *m_for_client;
+				// A dropped key-up would leave its key held forever, so every key is released instead; the client
+				// resyncs from the events that follow and from auto-repeat
+				if (!m_input_events.try_push(event)) {
+					m_dropped_event_count.fetch_add(1, std::memory_order_relaxed);
+					release_keys();
+				}
 			}
 
-			void enqueue(const input_event& event) { m_for_host->input_events.emplace_back(event); }
-			void request_exit() { m_for_host->exit_requested = true; }
-			void invalidate_size() { m_for_host->size_invalidated = true; }
+			void request_exit() noexcept { m_exit_requested.store(true, std::memory_order_relaxed); }
+			void invalidate_size() noexcept { m_size_invalidated.store(true, std::memory_order_relaxed); }
+			void release_keys() noexcept { m_keys_released.store(true, std::memory_order_relaxed); }
+
+			// Client only
+			std::optional<input_event> dequeue() noexcept { return m_input_events.try_pop(); }
+			bool is_exit_requested() const noexcept { return m_exit_requested.load(std::memory_order_relaxed); }
+			bool consume_size_invalidation() noexcept { return m_size_invalidated.exchange(false); }
+			bool consume_key_release() noexcept { return m_keys_released.exchange(false); }
+
+			std::uint64_t dropped_event_count() const noexcept
+			{
+				return m_dropped_event_count.load(std::memory_order_relaxed);
+			}
 
 		private:
-			std::array<host_client_data, 2> m_client_data;
-			gsl::not_null<host_client_data*> m_for_host;
-			gsl::not_null<host_client_data*> m_for_client;
+			static constexpr std::size_t input_queue_capacity {256};
+
+			spsc_queue<input_event, input_queue_capacity> m_input_events;
+			std::atomic<std::uint64_t> m_dropped_event_count;
+			std::atomic<bool> m_exit_requested;
+			std::atomic<bool> m_size_invalidated;
+			std::atomic<bool> m_keys_released;
 		};
 
 		constexpr DWORD confirm_exit {WM_USER};
@@ -86,11 +122,16 @@ namespace sandbox {
 				return 0;
 
 			case WM_KEYUP:
-				client_data->enqueue({input_event_type::key_released, w, l});
+				client_data->enqueue({input_event_type::key_released, w, l, get_message_time()});
 				return 0;
 
 			case WM_KEYDOWN:
-				client_data->enqueue({input_event_type::key_pressed, w, l});
+				client_data->enqueue({input_event_type::key_pressed, w, l, get_message_time()});
+				return 0;
+
+			// Keys released while another window has focus are never reported, so every key is released here
+			case WM_KILLFOCUS:
+				client_data->release_keys();
 				return 0;
 
 			case WM_DESTROY:
@@ -153,10 +194,11 @@ namespace sandbox {
 				&state));
 		}
 
+		// The motion applied on each tick that `key` is held for
 		DirectX::XMMATRIX map_to_camera_transform(WPARAM key)
 		{
-			static constexpr auto linear_speed = 0.03f;
-			static constexpr auto angular_speed = 0.04f;
+			static constexpr auto linear_speed = 0.9f / simulation_ticks_per_second;
+			static constexpr auto angular_speed = 1.2f / simulation_ticks_per_second;
 			static const auto forward_translate = DirectX::XMMatrixTranslation(0.0f, 0.0f, -linear_speed);
 			static const auto back_translate = DirectX::XMMatrixTranslation(0.0f, 0.0f, linear_speed);
 			static const auto left_rotate = DirectX::XMMatrixRotationY(angular_speed);
@@ -211,37 +253,95 @@ namespace sandbox {
 			}
 		}
 
-		void flush_message_queue() noexcept
+		DirectX::XMMATRIX simulate_camera(DirectX::XMMATRIX view, const key_state& keys)
+		{
+			static constexpr std::array<WPARAM, 12> camera_keys {
+				VK_UP, 'W', VK_DOWN, 'S', VK_LEFT, 'A', VK_RIGHT, 'D', 'R', 'F', 'Q', 'E'};
+
+			for (const auto key : camera_keys) {
+				if (keys.test(key))
+					view *= map_to_camera_transform(key);
+			}
+
+			return view;
+		}
+
+		// Views are rigid transforms, so blending their rotations and translations separately keeps them rigid
+		DirectX::XMMATRIX
+		interpolate_views(const DirectX::XMMATRIX& previous, const DirectX::XMMATRIX& current, float fraction)
+		{
+			DirectX::XMVECTOR scale {};
+			DirectX::XMVECTOR previous_rotation {};
+			DirectX::XMVECTOR previous_translation {};
+			DirectX::XMVECTOR current_rotation {};
+			DirectX::XMVECTOR current_translation {};
+			DirectX::XMMatrixDecompose(&scale, &previous_rotation, &previous_translation, previous);
+			DirectX::XMMatrixDecompose(&scale, &current_rotation, &current_translation, current);
+
+			const auto rotation = DirectX::XMQuaternionSlerp(previous_rotation, current_rotation, fraction);
+			const auto translation = DirectX::XMVectorLerp(previous_translation, current_translation, fraction);
+			return DirectX::XMMatrixRotationQuaternion(rotation) * DirectX::XMMatrixTranslationFromVector(translation);
+		}
+
+		// std::from_chars() has no wide overload
+		std::optional<unsigned int> parse_count(std::wstring_view text) noexcept
 		{
-			MSG message {};
-			while (PeekMessageW(&message, nullptr, 0, 0, PM_REMOVE)) {
-				TranslateMessage(&message);
-				DispatchMessageW(&message);
+			if (text.empty())
+				return {};
+
+			std::uint64_t value {};
+			for (const auto digit : text) {
+				if (digit < L'0' || digit > L'9')
+					return {};
+
+				value = value * 10 + gsl::narrow_cast<std::uint64_t>(digit - L'0');
+				if (value > std::numeric_limits<unsigned int>::max())
+					return {};
 			}
+
+			return gsl::narrow_cast<unsigned int>(value);
 		}
 
-		void do_update_loop(HWND host_window, host_atomic_state& client_data, const std::filesystem::path& filepath)
+		void do_update_loop(
+			HWND host_window,
+			host_atomic_state& client_data,
+			gsl::span<const std::filesystem::path> filepaths,
+			unsigned int frames_in_flight,
+			unsigned int instance_count,
+			transform_encoding encoding)
 		{
 			bool is_first_frame {true};
 			auto view_matrix = DirectX::XMMatrixIdentity();
+			auto previous_view_matrix = view_matrix;
 			render_mode type = render_mode::object_view;
-			graphics_engine_state renderer {host_window, filepath};
+			graphics_engine_state renderer {host_window, filepaths, frames_in_flight, instance_count, encoding};
 			bool snapshot {};
+			input_latency latency {};
+			key_state keys {};
+			simulation_clock simulation {simulation_tick_duration, max_simulation_ticks_per_frame};
+			auto last_advance = std::chrono::steady_clock::now();
 			while (true) {
+				renderer.wait_for_presentation();
+
 				using clock = std::chrono::high_resolution_clock;
 				const auto start = clock::now();
 
-				flush_message_queue();
-				const auto& current_state = client_data.swap_buffers();
-				if (current_state.exit_requested)
+				if (client_data.is_exit_requested())
 					break;
 
-				if (current_state.size_invalidated)
+				if (client_data.consume_size_invalidation())
 					renderer.signal_size_change();
 
-				for (const auto& event : current_state.input_events) {
-					if (event.type == input_event_type::key_pressed) {
-						switch (event.w) {
+				std::optional<std::chrono::steady_clock::time_point> earliest_input {};
+				const auto next_event = [&]() -> std::optional<key_event> {
+					const auto event = client_data.dequeue();
+					if (!event)
+						return {};
+
+					earliest_input = std::min(earliest_input.value_or(event->time), event->time);
+					const auto pressed = event->type == input_event_type::key_pressed;
+					if (pressed) {
+						switch (event->w) {
 						case '1':
 							type = render_mode::debug_grid;
 							break;
@@ -259,13 +359,32 @@ namespace sandbox {
 							break;
 
 						default:
-							view_matrix *= map_to_camera_transform(event.w);
 							break;
 						}
 					}
-				}
 
-				renderer.render(type, view_matrix);
+					return key_event {.key {event->w}, .pressed {pressed}};
+				};
+
+				const auto now = std::chrono::steady_clock::now();
+				const auto ticks = step_simulation(
+					simulation,
+					keys,
+					now - last_advance,
+					next_event,
+					[&client_data] { return client_data.consume_key_release(); },
+					[&](const key_state& held) {
+						previous_view_matrix = view_matrix;
+						view_matrix = simulate_camera(view_matrix, held);
+					});
+
+				last_advance = now;
+				const auto simulation_time = std::chrono::steady_clock::now() - now;
+				const auto fraction = simulation.interpolation();
+				renderer.render(type, interpolate_views(previous_view_matrix, view_matrix, fraction));
+				if (earliest_input)
+					record(latency, std::chrono::steady_clock::now() - *earliest_input);
+
 				if (is_first_frame) {
 					SendMessageW(host_window, client_ready, 0, 0);
 					is_first_frame = false;
@@ -275,6 +394,32 @@ namespace sandbox {
 				if (snapshot) {
 					std::wstringstream debug_message {};
 					debug_message << std::chrono::duration_cast<std::chrono::microseconds>(stop - start) << "\n";
+
+					using std::chrono::duration_cast;
+					using std::chrono::microseconds;
+					const auto& waits = renderer.frame_wait_statistics();
+					debug_message << "Frame waits: " << waits.wait_count << " (" << waits.blocked_count << " blocked)";
+					debug_message << ", last " << duration_cast<microseconds>(waits.last_wait);
+					debug_message << ", longest " << duration_cast<microseconds>(waits.longest_wait) << "\n";
+
+					const auto geometry = renderer.geometry_heap_statistics();
+					const auto& memory = geometry.memory;
+					debug_message << "Geometry heap: " << geometry.block_count << " blocks, ";
+					debug_message << memory.requested << " of " << memory.allocated << " allocated bytes used";
+					debug_message << ", " << memory.capacity - memory.allocated << " free in ";
+					debug_message << memory.free_block_count << " blocks (" << memory.largest_free_block << " largest)";
+					debug_message << ", external fragmentation " << get_external_fragmentation(memory) << "\n";
+					if (latency.sample_count != 0) {
+						debug_message << "Input latency: last " << duration_cast<microseconds>(latency.last);
+						debug_message << ", longest " << duration_cast<microseconds>(latency.longest);
+						debug_message << ", mean " << duration_cast<microseconds>(latency.total) / latency.sample_count;
+						debug_message << "\n";
+					}
+
+					debug_message << "Dropped input events: " << client_data.dropped_event_count() << "\n";
+					debug_message << "Simulation: " << ticks << " ticks";
+					debug_message << " in " << duration_cast<microseconds>(simulation_time);
+					debug_message << ", " << simulation.dropped_tick_count() << " dropped\n";
 					OutputDebugStringW(debug_message.str().c_str());
 					snapshot = false;
 				}
@@ -291,10 +436,48 @@ int wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ LPWSTR command_li
 	if (argc < 1)
 		return 1;
 
+	// --frames-in-flight=<1-4> trades latency for throughput, --instances=<count> sets how many copies of the scene
+	// are placed at startup (up to max_culled_instances), --packed-transforms quantizes their transforms to save
+	// bandwidth, and every other argument is a stream file to load
+	static constexpr std::wstring_view frames_option {L"--frames-in-flight="};
+	static constexpr std::wstring_view instances_option {L"--instances="};
+	static constexpr std::wstring_view packed_transforms_option {L"--packed-transforms"};
+	unsigned int frames_in_flight {2};
+	unsigned int instance_count {27};
+	auto encoding = sandbox::transform_encoding::affine;
+	std::vector<std::filesystem::path> filepaths {};
+	for (const std::wstring_view argument : arguments) {
+		if (argument.starts_with(frames_option)) {
+			const auto value = argument.substr(frames_option.size());
+			if (value.size() != 1 || value.front() < L'1' || value.front() > L'4')
+				return 1;
+
+			frames_in_flight = gsl::narrow_cast<unsigned int>(value.front() - L'0');
+		}
+		else if (argument.starts_with(instances_option)) {
+			const auto count = sandbox::parse_count(argument.substr(instances_option.size()));
+			if (!count || *count > sandbox::max_culled_instances)
+				return 1;
+
+			instance_count = *count;
+		}
+		else if (argument == packed_transforms_option) {
+			encoding = sandbox::transform_encoding::packed;
+		}
+		else {
+			filepaths.emplace_back(argument);
+		}
+	}
+
 	sandbox::host_atomic_state ui_state {};
 	const auto host_window = sandbox::create_host_window(instance, ui_state);
-	sandbox::do_update_loop(host_window, ui_state, arguments[0]);
-	SendMessageW(host_window, sandbox::confirm_exit, 0, 0);
+
+	// The client runs on its own thread, so that the modal loops Windows enters while the window is being moved or
+	// resized do not stall it; the host keeps pumping messages until the client confirms its exit
+	const std::jthread client {[&] {
+		sandbox::do_update_loop(host_window, ui_state, filepaths, frames_in_flight, instance_count, encoding);
+		SendMessageW(host_window, sandbox::confirm_exit, 0, 0);
+	}};
 
 	return sandbox::handle_messages_until_quit();
 }
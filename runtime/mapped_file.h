@@ -0,0 +1,165 @@
+#pragma once
+
+// Shared with the importer, so it relies on the including project's precompiled header
+
+namespace sandbox {
+	// Maps a whole file read-only for the lifetime of the object. Other processes are denied write access while it is
+	// held, since truncating a mapped file would fault on the next read. Failures throw std::system_error.
+	class mapped_file {
+	public:
+#ifdef _WIN32
+		explicit mapped_file(const std::filesystem::path& path) :
+			m_file {open_file(path)},
+			m_mapping {create_mapping(m_file.get(), get_file_size(m_file.get()))},
+			m_view {map_view(m_mapping.get())},
+			m_size {m_view ? get_file_size(m_file.get()) : 0}
+		{
+		}
+#else
+		explicit mapped_file(const std::filesystem::path& path) : m_view {}, m_size {}
+		{
+			const descriptor file {path};
+			const auto size = get_file_size(file.get());
+			m_view = {map_view(file.get(), size), view_deleter {size}};
+			m_size = size;
+		}
+#endif
+
+		gsl::span<const std::byte> content() const noexcept { return {m_view.get(), m_size}; }
+
+	private:
+#ifdef _WIN32
+		struct handle_deleter {
+			void operator()(HANDLE handle) const noexcept { CloseHandle(handle); }
+		};
+#endif
+
+		struct view_deleter {
+#ifndef _WIN32
+			std::size_t size; // munmap() needs the length of the view
+#endif
+			void operator()(const std::byte* view) const noexcept
+			{
+#ifdef _WIN32
+				UnmapViewOfFile(view);
+#else
+				munmap(const_cast<std::byte*>(view), size);
+#endif
+			}
+		};
+
+#ifdef _WIN32
+		std::unique_ptr<void, handle_deleter> m_file;
+		std::unique_ptr<void, handle_deleter> m_mapping;
+#endif
+		std::unique_ptr<const std::byte, view_deleter> m_view;
+		std::size_t m_size;
+
+#ifdef _WIN32
+		[[noreturn]] static void throw_last_error()
+		{
+			throw std::system_error {gsl::narrow_cast<int>(GetLastError()), std::system_category()};
+		}
+
+		static HANDLE open_file(const std::filesystem::path& path)
+		{
+			const auto file = CreateFileW(
+				path.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+				throw_last_error();
+
+			return file;
+		}
+
+		static std::size_t get_file_size(HANDLE file)
+		{
+			LARGE_INTEGER size {};
+			if (!GetFileSizeEx(file, &size))
+				throw_last_error();
+
+			return gsl::narrow<std::size_t>(size.QuadPart);
+		}
+
+		// Empty files cannot be mapped, so they get no mapping object at all
+		static HANDLE create_mapping(HANDLE file, std::size_t size)
+		{
+			if (size == 0)
+				return nullptr;
+
+			const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping)
+				throw_last_error();
+
+			return mapping;
+		}
+
+		GSL_SUPPRESS(type .1) // MapViewOfFile() hands back untyped memory
+		static const std::byte* map_view(HANDLE mapping)
+		{
+			if (!mapping)
+				return nullptr;
+
+			const auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (!view)
+				throw_last_error();
+
+			return static_cast<const std::byte*>(view);
+		}
+#else
+		[[noreturn]] static void throw_errno() { throw std::system_error {errno, std::generic_category()}; }
+
+		// A mapping stays valid once its descriptor is closed, so the descriptor only lives as long as the constructor
+		class descriptor {
+		public:
+			explicit descriptor(const std::filesystem::path& path) :
+				m_descriptor {open(path.c_str(), O_RDONLY | O_CLOEXEC)}
+			{
+				if (m_descriptor < 0)
+					throw_errno();
+			}
+
+			~descriptor() noexcept { close(m_descriptor); }
+
+			descriptor(const descriptor&) = delete;
+			descriptor& operator=(const descriptor&) = delete;
+			descriptor(descriptor&&) = delete;
+			descriptor& operator=(descriptor&&) = delete;
+
+			int get() const noexcept { return m_descriptor; }
+
+		private:
+			int m_descriptor;
+		};
+
+		static std::size_t get_file_size(int file)
+		{
+			struct stat status {};
+			if (fstat(file, &status) != 0)
+				throw_errno();
+
+			return gsl::narrow<std::size_t>(status.st_size);
+		}
+
+		// Empty files cannot be mapped
+		static const std::byte* map_view(int file, std::size_t size)
+		{
+			if (size == 0)
+				return nullptr;
+
+			const auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (view == MAP_FAILED)
+				throw_errno();
+
+			madvise(view, size, MADV_SEQUENTIAL);
+			return static_cast<const std::byte*>(view);
+		}
+#endif
+	};
+}
@@ -0,0 +1,27 @@
+#include "pch.h"
+
+#include "parallel_recording.h"
+
+std::vector<sandbox::draw_range>
+sandbox::partition_draws(gsl::span<const std::uint64_t> costs, std::size_t part_count)
+{
+	std::uint64_t total_cost {};
+	for (const auto cost : costs)
+		total_cost += cost;
+
+	// Each part ends at the first draw that takes the running cost past its share of the total
+	std::vector<draw_range> parts(part_count);
+	std::size_t next_draw {};
+	std::uint64_t running_cost {};
+	for (std::size_t part {}; part < part_count; ++part) {
+		const auto part_end_cost = total_cost * (part + 1) / part_count;
+		auto& [first, count] = parts[part];
+		first = next_draw;
+		while (next_draw < costs.size() && (running_cost < part_end_cost || part + 1 == part_count))
+			running_cost += costs[next_draw++];
+
+		count = next_draw - first;
+	}
+
+	return parts;
+}
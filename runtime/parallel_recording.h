@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pch.h"
+
+#include "job_system.h"
+
+namespace sandbox {
+	struct draw_range {
+		std::size_t first;
+		std::size_t count;
+	};
+
+	// Splits a sequence of draws into `part_count` contiguous ranges of roughly equal total cost, in order; some
+	// ranges may be empty. Deterministic, so the same draws always land in the same parts.
+	std::vector<draw_range> partition_draws(gsl::span<const std::uint64_t> costs, std::size_t part_count);
+
+	// Partitions the draws into `part_count` parts and records each part as a job: the sink's reset(part),
+	// record(part, range) and close(part) are called in that order for every part, even an empty one, so each part's
+	// list can be submitted as it is. Different parts are recorded concurrently; returns once all of them are closed.
+	template <typename sink_type>
+	void record_parts(job_system& jobs, gsl::span<const std::uint64_t> costs, std::size_t part_count, sink_type& sink)
+	{
+		const auto parts = partition_draws(costs, part_count);
+		jobs.parallel_for(parts.size(), parts.size(), [&](std::size_t part, std::size_t, std::size_t) {
+			sink.reset(part);
+			sink.record(part, parts.at(part));
+			sink.close(part);
+		});
+	}
+}
@@ -2,21 +2,42 @@
 
 #define NOMINMAX
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
 #include <charconv>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <numeric>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <stop_token>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <gsl/gsl>
 
+// The engine itself only builds for Windows; elsewhere, just the portable modules build, for the headless tests
+#ifdef _WIN32
 #include <intrin.h>
 
 #include <Windows.h>
@@ -30,3 +51,11 @@
 #include <shellapi.h>
 
 #include <winrt/base.h>
+#else
+#include <immintrin.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
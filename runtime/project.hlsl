@@ -4,10 +4,18 @@ cbuffer matrices : register(b0)
 {
 	row_major float4x4 view;
 	row_major float4x4 projection;
+	float4 bounds_minimum; // Only used by compact vertices
+	float4 bounds_extent;
+	uint transform_encoding;
 };
 
-vertex_data main(vertex_data vertex)
+vertex_data main(full_vertex_data vertex)
 {
-	vertex.position = mul(vertex.position + float4(vertex.offset, 0.0), mul(view, projection));
-	return vertex;
+	const float3x4 transform = load_instance_transform(vertex.instance, transform_encoding);
+	const float3 position = mul(transform, float4(vertex.position.xyz, 1.0));
+	vertex_data output;
+	output.position = mul(float4(position, 1.0), mul(view, projection));
+	output.normal = transform_normal(transform, vertex.normal);
+	output.offset = transform._m03_m13_m23;
+	return output;
 }
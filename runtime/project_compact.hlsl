@@ -0,0 +1,30 @@
+#include "vertex_data.hlsli"
+
+cbuffer matrices : register(b0)
+{
+	row_major float4x4 view;
+	row_major float4x4 projection;
+	float4 bounds_minimum;
+	float4 bounds_extent;
+	uint transform_encoding;
+};
+
+float3 decode_octahedral(float2 encoded)
+{
+	float3 normal = float3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	const float fold = saturate(-normal.z);
+	normal.xy += (normal.xy >= 0.0 ? -fold : fold);
+	return normalize(normal);
+}
+
+vertex_data main(compact_vertex_data vertex)
+{
+	const float3x4 transform = load_instance_transform(vertex.instance, transform_encoding);
+	const float3 local_position = bounds_minimum.xyz + vertex.position.xyz * bounds_extent.xyz;
+	const float3 position = mul(transform, float4(local_position, 1.0));
+	vertex_data output;
+	output.position = mul(float4(position, 1.0), mul(view, projection));
+	output.normal = transform_normal(transform, decode_octahedral(vertex.normal));
+	output.offset = transform._m03_m13_m23;
+	return output;
+}
@@ -0,0 +1,37 @@
+#include "pch.h"
+
+#include "simulation_clock.h"
+
+sandbox::simulation_clock::simulation_clock(
+	std::chrono::nanoseconds tick_duration,
+	unsigned int max_ticks_per_advance) noexcept :
+	m_tick_duration {tick_duration},
+	m_max_ticks_per_advance {max_ticks_per_advance},
+	m_accumulated {},
+	m_tick_count {},
+	m_dropped_tick_count {}
+{
+}
+
+unsigned int sandbox::simulation_clock::advance(std::chrono::nanoseconds elapsed) noexcept
+{
+	m_accumulated += elapsed;
+	const auto due = gsl::narrow_cast<std::uint64_t>(m_accumulated / m_tick_duration);
+	m_accumulated %= m_tick_duration;
+
+	const auto ticks = std::min(due, std::uint64_t {m_max_ticks_per_advance});
+	m_tick_count += ticks;
+	m_dropped_tick_count += due - ticks;
+	return gsl::narrow_cast<unsigned int>(ticks);
+}
+
+float sandbox::simulation_clock::interpolation() const noexcept
+{
+	return std::chrono::duration<float> {m_accumulated} / std::chrono::duration<float> {m_tick_duration};
+}
+
+std::chrono::nanoseconds sandbox::simulation_clock::tick_duration() const noexcept { return m_tick_duration; }
+
+std::uint64_t sandbox::simulation_clock::tick_count() const noexcept { return m_tick_count; }
+
+std::uint64_t sandbox::simulation_clock::dropped_tick_count() const noexcept { return m_dropped_tick_count; }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	constexpr auto simulation_ticks_per_second = 60;
+	constexpr auto simulation_tick_duration =
+		std::chrono::nanoseconds {std::chrono::seconds {1}} / simulation_ticks_per_second;
+	constexpr unsigned int max_simulation_ticks_per_frame {8};
+
+	// Indexed by virtual-key code
+	using key_state = std::bitset<256>;
+
+	struct key_event {
+		std::size_t key; // Virtual-key code
+		bool pressed;
+	};
+
+	// Turns elapsed real time into a whole number of fixed-length simulation ticks, carrying the remainder forward.
+	// Which ticks run depends only on the sequence of elapsed times fed in, so a recorded sequence replays exactly.
+	class simulation_clock {
+	public:
+		// After a long stall, ticks beyond `max_ticks_per_advance` are dropped rather than run back-to-back, so that
+		// the simulation slows down instead of falling ever further behind
+		simulation_clock(std::chrono::nanoseconds tick_duration, unsigned int max_ticks_per_advance) noexcept;
+
+		// Returns the number of ticks that are now due
+		unsigned int advance(std::chrono::nanoseconds elapsed) noexcept;
+
+		// How far real time has progressed past the last tick, from 0 to 1, for blending the last two states
+		float interpolation() const noexcept;
+
+		std::chrono::nanoseconds tick_duration() const noexcept;
+		std::uint64_t tick_count() const noexcept;
+		std::uint64_t dropped_tick_count() const noexcept;
+
+	private:
+		std::chrono::nanoseconds m_tick_duration;
+		unsigned int m_max_ticks_per_advance;
+		std::chrono::nanoseconds m_accumulated;
+		std::uint64_t m_tick_count;
+		std::uint64_t m_dropped_tick_count;
+	};
+
+	// One frame of the client's update loop: every event `next_event()` yields is applied to `keys` (codes past its
+	// end are ignored), then `keys` is cleared if `is_focus_lost()`, then the clock advances by `elapsed` and
+	// `tick(keys)` runs once for each tick that falls due. Returns the number of ticks run.
+	template <typename event_source_type, typename focus_check_type, typename tick_type>
+	unsigned int step_simulation(
+		simulation_clock& clock,
+		key_state& keys,
+		std::chrono::nanoseconds elapsed,
+		const event_source_type& next_event,
+		const focus_check_type& is_focus_lost,
+		const tick_type& tick)
+	{
+		while (const std::optional<key_event> event = next_event()) {
+			if (event->key < keys.size())
+				keys.set(event->key, event->pressed);
+		}
+
+		// After the events are drained, so that no key pressed before focus was lost survives; a key still held once
+		// focus returns is pressed again by the next auto-repeat
+		if (is_focus_lost())
+			keys.reset();
+
+		const auto ticks = clock.advance(elapsed);
+		for (unsigned int i {}; i < ticks; ++i)
+			tick(std::as_const(keys));
+
+		return ticks;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// A bounded ring for exactly one producer thread and one consumer thread. Neither side allocates, locks or waits;
+	// a push onto a full queue fails instead. Each index is written by one side only and sits on its own cache line
+	// alongside that side's cached copy of the other index, so the sides only share a line when the cached copy runs
+	// out.
+	template <typename value_type, std::size_t capacity>
+	class spsc_queue {
+		static_assert(std::has_single_bit(capacity), "capacity must be a power of two");
+		static_assert(std::is_trivially_copyable_v<value_type>, "values are copied in and out of the ring");
+
+	public:
+		spsc_queue() noexcept = default;
+
+		spsc_queue(const spsc_queue&) = delete;
+		spsc_queue& operator=(const spsc_queue&) = delete;
+		spsc_queue(spsc_queue&&) = delete;
+		spsc_queue& operator=(spsc_queue&&) = delete;
+
+		// Producer only
+		bool try_push(const value_type& value) noexcept
+		{
+			const auto tail = m_producer.index.load(std::memory_order_relaxed);
+			if (tail - m_producer.cached_index == capacity) {
+				m_producer.cached_index = m_consumer.index.load(std::memory_order_acquire);
+				if (tail - m_producer.cached_index == capacity)
+					return false;
+			}
+
+			m_values[tail & (capacity - 1)] = value;
+			m_producer.index.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only
+		std::optional<value_type> try_pop() noexcept
+		{
+			const auto head = m_consumer.index.load(std::memory_order_relaxed);
+			if (head == m_consumer.cached_index) {
+				m_consumer.cached_index = m_producer.index.load(std::memory_order_acquire);
+				if (head == m_consumer.cached_index)
+					return {};
+			}
+
+			const auto value = m_values[head & (capacity - 1)];
+			m_consumer.index.store(head + 1, std::memory_order_release);
+			return value;
+		}
+
+	private:
+		static constexpr std::size_t cache_line_size {64};
+
+		// Indices count up without wrapping, and are reduced modulo the capacity only to address the ring
+		struct alignas(cache_line_size) side {
+			std::atomic<std::size_t> index {};
+			std::size_t cached_index {}; // The other side's index, as last seen
+		};
+
+		side m_producer {};
+		side m_consumer {};
+		std::array<value_type, capacity> m_values {};
+	};
+}
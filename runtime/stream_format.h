@@ -12,4 +12,84 @@ namespace sandbox {
 		vector3 texture_coord;
 		vector3 normal;
 	};
+
+	// Positions are 16-bit UNORM relative to the mesh bounds (w is padding), texture coordinates are half-precision,
+	// and normals are octahedral-encoded 16-bit SNORM
+	struct compact_vertex_data {
+		std::array<std::uint16_t, 4> position;
+		std::array<std::uint16_t, 2> texture_coord;
+		std::array<std::int16_t, 2> normal;
+	};
+
+	enum class vertex_format : std::uint32_t { full, compact };
+
+	// position = minimum + extent * quantized position, for compact vertices
+	struct position_bounds {
+		vector3 minimum;
+		vector3 extent;
+	};
+
+	enum class index_format : std::uint32_t { uint16, uint32 };
+
+	// Each submesh is drawn separately; 16-bit indices are relative to its base vertex
+	struct submesh {
+		std::uint32_t first_index;
+		std::uint32_t index_count;
+		std::int32_t base_vertex;
+	};
+
+	inline constexpr std::array stream_magic {'s', 'a', 'n', 'd', 'b', 'o', 'x', '\x1a'};
+	constexpr std::uint32_t stream_version {2};
+
+	// Version 2 added the meshlet sections; since readers skip sections they do not know, version 1 files still load
+	constexpr std::uint32_t oldest_stream_version {1};
+
+	// Every section begins at a multiple of this many bytes from the start of the file, so that a mapped view of the
+	// file can be used in place
+	constexpr std::size_t stream_alignment {64};
+
+	// Clusters of a submesh's triangles for mesh shaders. A meshlet's triangles index its run of meshlet vertices,
+	// which index the vertex section directly (not relative to a base vertex). Each triangle packs its three 8-bit
+	// indices into a std::uint32_t, the first in the lowest byte.
+	struct meshlet {
+		std::uint32_t first_vertex;
+		std::uint32_t vertex_count;
+		std::uint32_t first_triangle;
+		std::uint32_t triangle_count;
+		vector3 center;
+		float radius;
+
+		// Every triangle faces away from a viewer at `eye` if, with d = center - eye,
+		// dot(d, cone_axis) >= cone_cutoff * length(d) + radius * (1 + cone_cutoff); a meshlet that can't be culled
+		// this way has a zero axis and a cutoff of one
+		vector3 cone_axis;
+		float cone_cutoff;
+	};
+
+	enum class section_type : std::uint32_t {
+		submeshes,
+		indices,
+		vertices,
+		meshlets,
+		meshlet_vertices,
+		meshlet_triangles
+	};
+
+	struct stream_section {
+		section_type type;
+		std::uint32_t format; // The index_format or vertex_format of the elements, and zero otherwise
+		std::uint64_t offset; // From the start of the file
+		std::uint64_t element_count;
+		std::uint64_t element_size;
+		std::uint64_t checksum; // XXH64 of the section's bytes, with a seed of zero
+	};
+
+	// Followed immediately by `section_count` sections; sections of unknown type are skipped by readers
+	struct stream_header {
+		std::array<char, 8> magic;
+		std::uint32_t version;
+		std::uint32_t section_count;
+		std::uint64_t file_size;
+		position_bounds bounds; // Only meaningful for compact vertices
+	};
 }
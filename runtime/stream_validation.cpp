@@ -0,0 +1,182 @@
+#include "pch.h"
+
+#include "stream_validation.h"
+
+namespace sandbox {
+	namespace {
+		std::uint64_t get_index_size(std::uint32_t format)
+		{
+			switch (index_format {format}) {
+			case index_format::uint16:
+				return sizeof(std::uint16_t);
+
+			case index_format::uint32:
+				return sizeof(std::uint32_t);
+			}
+
+			throw stream_error {"unknown index format"};
+		}
+
+		std::uint64_t get_vertex_size(std::uint32_t format)
+		{
+			switch (vertex_format {format}) {
+			case vertex_format::full:
+				return sizeof(vertex_data);
+
+			case vertex_format::compact:
+				return sizeof(compact_vertex_data);
+			}
+
+			throw stream_error {"unknown vertex format"};
+		}
+
+		std::uint64_t get_element_size(const stream_section& section)
+		{
+			switch (section.type) {
+			case section_type::submeshes:
+				return sizeof(submesh);
+
+			case section_type::indices:
+				return get_index_size(section.format);
+
+			case section_type::vertices:
+				return get_vertex_size(section.format);
+
+			case section_type::meshlets:
+				return sizeof(meshlet);
+
+			case section_type::meshlet_vertices:
+			case section_type::meshlet_triangles:
+				return sizeof(std::uint32_t);
+			}
+
+			return section.element_size;
+		}
+
+		void validate_section(const stream_section& section, std::uint64_t table_end, std::uint64_t file_size)
+		{
+			if (section.offset % stream_alignment != 0 || section.offset < table_end)
+				throw stream_error {"misplaced section"};
+
+			if (section.element_size != get_element_size(section))
+				throw stream_error {"section element size does not match its format"};
+
+			if (section.offset > file_size)
+				throw stream_error {"section extends past the end of the file"};
+
+			const auto size_limit = file_size - section.offset;
+			if (section.element_size && section.element_count > size_limit / section.element_size)
+				throw stream_error {"section extends past the end of the file"};
+		}
+
+		template <typename index_type>
+		std::uint64_t find_max_index(gsl::span<const std::byte> indices, std::size_t first, std::size_t count) noexcept
+		{
+			std::uint64_t max_index {};
+			for (auto i = first; i < first + count; ++i) {
+				index_type index {};
+				std::memcpy(&index, &indices[i * sizeof(index)], sizeof(index));
+				max_index = std::max<std::uint64_t>(max_index, index);
+			}
+
+			return max_index;
+		}
+
+		void assign_section(std::optional<stream_section>& slot, const stream_section& section)
+		{
+			if (slot)
+				throw stream_error {"duplicate section"};
+
+			slot = section;
+		}
+	}
+}
+
+std::size_t sandbox::get_section_size(const stream_section& section) noexcept
+{
+	return gsl::narrow_cast<std::size_t>(section.element_count * section.element_size);
+}
+
+void sandbox::validate_stream_header(const stream_header& header, std::uint64_t file_size)
+{
+	if (header.magic != stream_magic)
+		throw stream_error {"not a stream file"};
+
+	if (header.version < oldest_stream_version || header.version > stream_version)
+		throw stream_error {"unsupported stream version"};
+
+	if (file_size < sizeof(stream_header) || header.file_size != file_size)
+		throw stream_error {"truncated stream file"};
+
+	if (header.section_count > (file_size - sizeof(stream_header)) / sizeof(stream_section))
+		throw stream_error {"section table extends past the end of the file"};
+}
+
+sandbox::stream_layout sandbox::locate_sections(const stream_header& header, gsl::span<const stream_section> sections)
+{
+	const auto table_end = sizeof(stream_header) + sections.size_bytes();
+	std::optional<stream_section> submeshes {};
+	std::optional<stream_section> indices {};
+	std::optional<stream_section> vertices {};
+	for (const auto& section : sections) {
+		validate_section(section, table_end, header.file_size);
+		switch (section.type) {
+		case section_type::submeshes:
+			assign_section(submeshes, section);
+			break;
+
+		case section_type::indices:
+			assign_section(indices, section);
+			break;
+
+		case section_type::vertices:
+			assign_section(vertices, section);
+			break;
+
+		// Only mesh shaders draw from meshlets, and the runtime does not use them yet
+		case section_type::meshlets:
+		case section_type::meshlet_vertices:
+		case section_type::meshlet_triangles:
+			break;
+		}
+	}
+
+	if (!submeshes || !indices || !vertices)
+		throw stream_error {"missing section"};
+
+	return {.bounds {header.bounds}, .submeshes {*submeshes}, .indices {*indices}, .vertices {*vertices}};
+}
+
+void sandbox::validate_submeshes(gsl::span<const submesh> submeshes, const stream_layout& layout)
+{
+	for (const auto& [first_index, index_count, base_vertex] : submeshes) {
+		if (std::uint64_t {first_index} + index_count > layout.indices.element_count)
+			throw stream_error {"submesh indices out of range"};
+
+		const auto vertex_count = layout.vertices.element_count;
+		if (base_vertex < 0 || (index_count && gsl::narrow_cast<std::uint64_t>(base_vertex) >= vertex_count))
+			throw stream_error {"submesh base vertex out of range"};
+	}
+}
+
+void sandbox::validate_submesh_indices(
+	gsl::span<const submesh> submeshes,
+	gsl::span<const std::byte> indices,
+	const stream_layout& layout)
+{
+	const auto is_16_bit = index_format {layout.indices.format} == index_format::uint16;
+	if (indices.size() != get_section_size(layout.indices))
+		throw stream_error {"index section size mismatch"};
+
+	for (const auto& [first_index, index_count, base_vertex] : submeshes) {
+		if (index_count == 0)
+			continue;
+
+		const auto max_index = is_16_bit
+			? find_max_index<std::uint16_t>(indices, first_index, index_count)
+			: find_max_index<std::uint32_t>(indices, first_index, index_count);
+
+		if (gsl::narrow_cast<std::uint64_t>(base_vertex) + max_index >= layout.vertices.element_count)
+			throw stream_error {"submesh indices reference vertices out of range"};
+	}
+}
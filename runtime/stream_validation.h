@@ -0,0 +1,41 @@
+#pragma once
+
+#include "pch.h"
+
+#include "stream_format.h"
+
+namespace sandbox {
+	class stream_error : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	// The sections a mesh is drawn from
+	struct stream_layout {
+		position_bounds bounds;
+		stream_section submeshes;
+		stream_section indices;
+		stream_section vertices;
+	};
+
+	// Only valid for sections that have passed locate_sections()
+	std::size_t get_section_size(const stream_section& section) noexcept;
+
+	// Checks the magic, that the version is one this reader understands, and that the section table fits in a file of
+	// `file_size` bytes
+	void validate_stream_header(const stream_header& header, std::uint64_t file_size);
+
+	// Checks that every section is aligned, lies within the file, and has the element size its format implies, then
+	// finds the sections a mesh needs; none of the sections' contents are read
+	stream_layout locate_sections(const stream_header& header, gsl::span<const stream_section> sections);
+
+	// Checks that every submesh draws from within the index section and starts within the vertex section
+	void validate_submeshes(gsl::span<const submesh> submeshes, const stream_layout& layout);
+
+	// Checks that every index a submesh draws, offset by its base vertex, lies within the vertex section; `indices` is
+	// the index section's contents, and the submeshes must have passed validate_submeshes()
+	void validate_submesh_indices(
+		gsl::span<const submesh> submeshes,
+		gsl::span<const std::byte> indices,
+		const stream_layout& layout);
+}
@@ -0,0 +1,93 @@
+#include "pch.h"
+
+#include "upload_ring.h"
+
+namespace sandbox {
+	namespace {
+		std::size_t align_up(std::size_t offset, std::size_t alignment) noexcept
+		{
+			return (offset + alignment - 1) & ~(alignment - 1);
+		}
+	}
+}
+
+sandbox::upload_ring::upload_ring(std::size_t capacity) noexcept :
+	m_capacity {capacity},
+	m_head {},
+	m_tail {},
+	m_used {},
+	m_wasted {},
+	m_open_batch {},
+	m_batches {}
+{
+}
+
+std::optional<std::size_t> sandbox::upload_ring::allocate(std::size_t size, std::size_t alignment) noexcept
+{
+	// With nothing outstanding, the whole ring is one contiguous block again
+	if (m_used == 0)
+		m_head = m_tail = 0;
+
+	const auto aligned = align_up(m_head, alignment);
+	std::optional<std::size_t> offset {};
+	if (m_used == 0 || m_head > m_tail) {
+		// Free space runs from the head to the end of the ring, and from the start of the ring to the tail
+		if (aligned <= m_capacity && size <= m_capacity - aligned)
+			offset = aligned;
+		else if (size <= m_tail)
+			offset = 0;
+	}
+	else if (m_head < m_tail && aligned <= m_tail && size <= m_tail - aligned) {
+		offset = aligned;
+	}
+
+	if (!offset)
+		return {};
+
+	// Wrapping around wastes everything from the head to the end of the ring
+	const auto skipped = *offset >= m_head ? *offset - m_head : m_capacity - m_head + *offset;
+	m_head = *offset + size;
+	m_used += skipped + size;
+	m_wasted += skipped;
+	m_open_batch.size += skipped + size;
+	m_open_batch.wasted += skipped;
+	return offset;
+}
+
+void sandbox::upload_ring::submit(std::uint64_t fence_value)
+{
+	if (m_open_batch.size == 0)
+		return;
+
+	m_open_batch.fence_value = fence_value;
+	m_batches.push_back(std::exchange(m_open_batch, {}));
+}
+
+void sandbox::upload_ring::retire(std::uint64_t completed_value) noexcept
+{
+	while (!m_batches.empty() && m_batches.front().fence_value <= completed_value) {
+		const auto& [fence_value, size, wasted] = m_batches.front();
+		m_tail = (m_tail + size) % m_capacity;
+		m_used -= size;
+		m_wasted -= wasted;
+		m_batches.pop_front();
+	}
+}
+
+std::size_t sandbox::upload_ring::capacity() const noexcept { return m_capacity; }
+
+std::size_t sandbox::upload_ring::used() const noexcept { return m_used; }
+
+std::size_t sandbox::upload_ring::wasted() const noexcept { return m_wasted; }
+
+std::size_t sandbox::upload_ring::largest_free_block() const noexcept
+{
+	if (m_used == 0)
+		return m_capacity;
+
+	if (m_head > m_tail)
+		return std::max(m_capacity - m_head, m_tail);
+
+	// The head has caught up with the tail when the ring is full
+	return m_tail - m_head;
+}
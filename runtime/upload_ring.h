@@ -0,0 +1,45 @@
+#pragma once
+
+#include "pch.h"
+
+namespace sandbox {
+	// Hands out space from a fixed-size ring in allocation order, and reclaims it a batch at a time once the fence
+	// value its batch was submitted with has completed. No GPU state is involved; offsets are relative to whatever
+	// buffer the ring is laid over.
+	class upload_ring {
+	public:
+		explicit upload_ring(std::size_t capacity) noexcept;
+
+		// Returns the offset of `size` free bytes aligned to `alignment` (a power of two), or nothing if they will not
+		// fit until more batches retire; space skipped to wrap around or to align is counted as wasted
+		std::optional<std::size_t> allocate(std::size_t size, std::size_t alignment) noexcept;
+
+		// Closes the batch of allocations made since the last submission; it is reclaimed once `fence_value` completes
+		void submit(std::uint64_t fence_value);
+
+		// Reclaims every batch submitted with a fence value no greater than `completed_value`
+		void retire(std::uint64_t completed_value) noexcept;
+
+		std::size_t capacity() const noexcept;
+		std::size_t used() const noexcept; // Including wasted bytes
+		std::size_t wasted() const noexcept;
+
+		// The largest allocation with byte alignment that would currently succeed
+		std::size_t largest_free_block() const noexcept;
+
+	private:
+		struct batch {
+			std::uint64_t fence_value;
+			std::size_t size;
+			std::size_t wasted;
+		};
+
+		std::size_t m_capacity;
+		std::size_t m_head;
+		std::size_t m_tail;
+		std::size_t m_used;
+		std::size_t m_wasted;
+		batch m_open_batch;
+		std::deque<batch> m_batches;
+	};
+}
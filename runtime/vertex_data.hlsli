@@ -1,5 +1,22 @@
+#include "instance_transforms.hlsli"
+
 struct vertex_data {
 	float4 position : SV_POSITION;
 	float3 normal : NORMAL;
 	float3 offset : OFFSET;
 };
+
+// See vertex_data in stream_format.h
+struct full_vertex_data {
+	float4 position : SV_POSITION;
+	float3 normal : NORMAL;
+	uint instance : INSTANCE; // Of an instance that survived culling, which indexes instance_transforms
+};
+
+// See compact_vertex_data in stream_format.h
+struct compact_vertex_data {
+	float4 position : SV_POSITION;
+	float2 texture_coord : TEXTURE;
+	float2 normal : NORMAL;
+	uint instance : INSTANCE;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+namespace sandbox {
+	// Streaming implementation of Yann Collet's XXH64; feeding the input in any number of pieces yields the same digest
+	// as hashing it in one go
+	class xxhash64 {
+	public:
+		explicit xxhash64(std::uint64_t seed = 0) noexcept :
+			m_accumulators {seed + prime1 + prime2, seed + prime2, seed, seed - prime1},
+			m_pending {},
+			m_pending_size {},
+			m_total_size {},
+			m_seed {seed}
+		{
+		}
+
+		GSL_SUPPRESS(bounds .1)
+		void update(gsl::span<const std::byte> data) noexcept
+		{
+			m_total_size += data.size();
+			auto first = data.data();
+			const auto last = std::next(first, data.size());
+			if (m_pending_size) {
+				const auto taken = std::min<std::size_t>(stripe_size - m_pending_size, last - first);
+				std::memcpy(&m_pending.at(m_pending_size), first, taken);
+				m_pending_size += taken;
+				first += taken;
+				if (m_pending_size < stripe_size)
+					return;
+
+				consume_stripe(m_pending.data());
+				m_pending_size = 0;
+			}
+
+			for (; last - first >= stripe_size; first += stripe_size)
+				consume_stripe(first);
+
+			m_pending_size = last - first;
+			std::memcpy(m_pending.data(), first, m_pending_size);
+		}
+
+		GSL_SUPPRESS(bounds .1)
+		std::uint64_t digest() const noexcept
+		{
+			std::uint64_t hash {};
+			if (m_total_size >= stripe_size) {
+				const auto& [a, b, c, d] = m_accumulators;
+				hash = std::rotl(a, 1) + std::rotl(b, 7) + std::rotl(c, 12) + std::rotl(d, 18);
+				for (const auto accumulator : m_accumulators)
+					hash = (hash ^ round(0, accumulator)) * prime1 + prime4;
+			}
+			else {
+				hash = m_seed + prime5;
+			}
+
+			hash += m_total_size;
+
+			auto first = m_pending.data();
+			const auto last = std::next(first, m_pending_size);
+			for (; last - first >= 8; first += 8)
+				hash = std::rotl(hash ^ round(0, load<std::uint64_t>(first)), 27) * prime1 + prime4;
+
+			if (last - first >= 4) {
+				hash = std::rotl(hash ^ (load<std::uint32_t>(first) * prime1), 23) * prime2 + prime3;
+				first += 4;
+			}
+
+			for (; first != last; ++first)
+				hash = std::rotl(hash ^ (std::to_integer<std::uint64_t>(*first) * prime5), 11) * prime1;
+
+			hash ^= hash >> 33;
+			hash *= prime2;
+			hash ^= hash >> 29;
+			hash *= prime3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+
+	private:
+		static constexpr std::uint64_t prime1 {0x9e3779b185ebca87};
+		static constexpr std::uint64_t prime2 {0xc2b2ae3d27d4eb4f};
+		static constexpr std::uint64_t prime3 {0x165667b19e3779f9};
+		static constexpr std::uint64_t prime4 {0x85ebca77c2b2ae63};
+		static constexpr std::uint64_t prime5 {0x27d4eb2f165667c5};
+		static constexpr std::ptrdiff_t stripe_size {32};
+
+		std::array<std::uint64_t, 4> m_accumulators;
+		std::array<std::byte, stripe_size> m_pending;
+		std::size_t m_pending_size;
+		std::uint64_t m_total_size;
+		std::uint64_t m_seed;
+
+		// Little-endian, as on every platform we target
+		template <typename type>
+		static type load(const std::byte* bytes) noexcept
+		{
+			type value {};
+			std::memcpy(&value, bytes, sizeof(value));
+			return value;
+		}
+
+		static std::uint64_t round(std::uint64_t accumulator, std::uint64_t lane) noexcept
+		{
+			return std::rotl(accumulator + lane * prime2, 31) * prime1;
+		}
+
+		GSL_SUPPRESS(bounds .1)
+		void consume_stripe(const std::byte* stripe) noexcept
+		{
+			for (auto& accumulator : m_accumulators) {
+				accumulator = round(accumulator, load<std::uint64_t>(stripe));
+				stripe += 8;
+			}
+		}
+	};
+}
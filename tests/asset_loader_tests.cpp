@@ -0,0 +1,201 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/asset_loader.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		using namespace std::chrono_literals;
+
+		// Drains until `count` assets have arrived, or gives up after a generous timeout so a lost asset fails rather
+		// than hangs
+		template <typename asset_type>
+		std::vector<asset_type> drain_until(asset_loader<asset_type>& loader, std::size_t count)
+		{
+			std::vector<asset_type> assets {};
+			const auto deadline = std::chrono::steady_clock::now() + 10s;
+			while (assets.size() < count && std::chrono::steady_clock::now() < deadline) {
+				loader.drain([&assets](asset_type asset) { assets.push_back(std::move(asset)); });
+				std::this_thread::yield();
+			}
+
+			return assets;
+		}
+
+		// Counts how many instances are alive, to check that the loader neither leaks nor double-frees assets
+		class counted_asset {
+		public:
+			explicit counted_asset(std::atomic_int& live_count) noexcept : m_live_count {&live_count}
+			{
+				++*m_live_count;
+			}
+
+			counted_asset(counted_asset&& other) noexcept : m_live_count {std::exchange(other.m_live_count, nullptr)}
+			{
+			}
+
+			counted_asset& operator=(counted_asset&& other) noexcept
+			{
+				release();
+				m_live_count = std::exchange(other.m_live_count, nullptr);
+				return *this;
+			}
+
+			counted_asset(const counted_asset&) = delete;
+			counted_asset& operator=(const counted_asset&) = delete;
+
+			~counted_asset() noexcept { release(); }
+
+		private:
+			std::atomic_int* m_live_count;
+
+			void release() noexcept
+			{
+				if (m_live_count)
+					--*m_live_count;
+			}
+		};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(every_request_is_completed_exactly_once)
+{
+	asset_loader<std::string> loader {4, [](const std::filesystem::path& path) { return path.string(); }};
+	constexpr std::size_t request_count {200};
+	for (std::size_t i {}; i < request_count; ++i)
+		loader.request(std::to_string(i));
+
+	auto assets = drain_until(loader, request_count);
+	CHECK(assets.size() == request_count);
+	CHECK(loader.outstanding() == 0);
+
+	std::vector<std::string> expected {};
+	for (std::size_t i {}; i < request_count; ++i)
+		expected.push_back(std::to_string(i));
+
+	std::sort(assets.begin(), assets.end());
+	std::sort(expected.begin(), expected.end());
+	CHECK(assets == expected);
+}
+
+SANDBOX_TEST(a_single_worker_completes_requests_in_order)
+{
+	asset_loader<std::string> loader {1, [](const std::filesystem::path& path) { return path.string(); }};
+	const std::vector<std::string> paths {"a", "b", "c", "d", "e"};
+	for (const auto& path : paths)
+		loader.request(path);
+
+	CHECK(drain_until(loader, paths.size()) == paths);
+}
+
+SANDBOX_TEST(outstanding_counts_requests_until_they_are_drained)
+{
+	std::atomic_bool release {};
+	std::atomic_int load_count {};
+	const auto load = [&](const std::filesystem::path&) {
+		while (!release)
+			std::this_thread::yield();
+
+		return ++load_count;
+	};
+
+	asset_loader<int> loader {2, load};
+
+	loader.request("a");
+	loader.request("b");
+	CHECK(loader.outstanding() == 2);
+	release = true;
+
+	// Completed but undrained assets are still outstanding
+	while (load_count < 2)
+		std::this_thread::yield();
+
+	CHECK(loader.outstanding() == 2);
+	CHECK(drain_until(loader, 2).size() == 2);
+	CHECK(loader.outstanding() == 0);
+}
+
+SANDBOX_TEST(assets_can_be_requested_while_draining)
+{
+	asset_loader<std::string> loader {2, [](const std::filesystem::path& path) { return path.string(); }};
+	loader.request("first");
+	std::vector<std::string> assets {};
+	const auto deadline = std::chrono::steady_clock::now() + 10s;
+	while (assets.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+		loader.drain([&](std::string asset) {
+			if (asset == "first")
+				loader.request("second");
+
+			assets.push_back(std::move(asset));
+		});
+	}
+
+	CHECK((assets == std::vector<std::string> {"first", "second"}));
+}
+
+SANDBOX_TEST(without_workers_requests_wait_and_are_abandoned)
+{
+	std::atomic_int load_count {};
+	{
+		asset_loader<int> loader {0, [&load_count](const std::filesystem::path&) { return ++load_count; }};
+		loader.request("a");
+		loader.request("b");
+		CHECK(drain_until(loader, 0).empty());
+		CHECK(loader.outstanding() == 2);
+	}
+
+	CHECK(load_count == 0);
+}
+
+SANDBOX_TEST(destruction_finishes_and_discards_assets_in_flight)
+{
+	std::atomic_int live_count {};
+	std::atomic_bool started {};
+	std::atomic_int load_count {};
+	{
+		const auto load = [&](const std::filesystem::path&) {
+			started = true;
+			std::this_thread::sleep_for(50ms);
+			++load_count;
+			return counted_asset {live_count};
+		};
+
+		asset_loader<counted_asset> loader {1, load};
+
+		for (int i {}; i < 8; ++i)
+			loader.request("slow");
+
+		while (!started)
+			std::this_thread::yield();
+	}
+
+	// The load in flight ran to completion, the requests no worker had started were abandoned, and every asset that
+	// was produced has been destroyed
+	CHECK(load_count >= 1);
+	CHECK(load_count < 8);
+	CHECK(live_count == 0);
+}
+
+SANDBOX_TEST(drained_assets_belong_to_the_consumer)
+{
+	std::atomic_int live_count {};
+	std::vector<counted_asset> kept {};
+	{
+		asset_loader<counted_asset> loader {
+			2,
+			[&live_count](const std::filesystem::path&) { return counted_asset {live_count}; }};
+
+		for (int i {}; i < 16; ++i)
+			loader.request("asset");
+
+		kept = drain_until(loader, 16);
+	}
+
+	CHECK(kept.size() == 16);
+	CHECK(live_count == 16);
+	kept.clear();
+	CHECK(live_count == 0);
+}
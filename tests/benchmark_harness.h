@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace sandbox::benchmarking {
+	// Keeps the compiler from discarding a result that is otherwise unused
+	template <typename value_type>
+	void keep(const value_type& value) noexcept
+	{
+		asm volatile("" : : "r"(&value) : "memory");
+	}
+
+	// The fastest of `repeat_count` runs, in seconds, which is the least disturbed by the rest of the machine
+	template <typename function_type>
+	double time_fastest(std::size_t repeat_count, const function_type& function)
+	{
+		auto fastest = std::numeric_limits<double>::max();
+		for (std::size_t i {}; i < repeat_count; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+			fastest = std::min(fastest, elapsed.count());
+		}
+
+		return fastest;
+	}
+
+	// Prints the time per item and the rate, in items of `unit` per second
+	inline void report(std::string_view name, double seconds, double item_count, std::string_view unit)
+	{
+		std::cout << name << ": " << seconds * 1e3 << " ms, " << seconds * 1e9 / item_count << " ns per " << unit
+				  << ", " << item_count / seconds / 1e6 << " M" << unit << "/s\n";
+	}
+
+	// The `index`th command-line argument as a count, or `fallback` if there is none; benchmarks take their problem
+	// sizes this way, so that they can be scaled down for a quick run
+	inline std::size_t get_count_argument(int argc, char** argv, int index, std::size_t fallback)
+	{
+		if (argc <= index)
+			return fallback;
+
+		const std::string_view text {argv[index]};
+		std::size_t value {};
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return error == std::errc {} && end == text.data() + text.size() ? value : fallback;
+	}
+}
@@ -0,0 +1,142 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/buddy_allocator.h"
+#include "test_harness.h"
+
+#include <random>
+
+using namespace sandbox;
+
+SANDBOX_TEST(sizes_that_are_not_powers_of_two_are_rejected)
+{
+	CHECK_THROWS(buddy_allocator(1000, 64), std::invalid_argument);
+	CHECK_THROWS(buddy_allocator(1024, 48), std::invalid_argument);
+	CHECK_THROWS(buddy_allocator(64, 128), std::invalid_argument);
+}
+
+SANDBOX_TEST(blocks_are_rounded_up_to_powers_of_two)
+{
+	buddy_allocator allocator {1 << 20, 256};
+	CHECK(allocator.allocate(1000, 1) == 0);
+	CHECK(allocator.allocate(1, 1) == 1024);
+	const auto& statistics = allocator.statistics();
+	CHECK(statistics.allocated == 1024 + 256);
+	CHECK(statistics.requested == 1001);
+}
+
+SANDBOX_TEST(blocks_are_aligned_as_requested)
+{
+	buddy_allocator allocator {1 << 20, 256};
+	CHECK(allocator.allocate(256, 1) == 0);
+	const auto offset = allocator.allocate(256, 65536);
+	CHECK(offset && *offset % 65536 == 0);
+	CHECK(allocator.statistics().allocated == 256 + 65536);
+}
+
+SANDBOX_TEST(allocations_fail_once_no_block_is_large_enough)
+{
+	buddy_allocator allocator {4096, 256};
+	CHECK(!allocator.allocate(4097, 1));
+	CHECK(!allocator.allocate(1, 8192));
+	CHECK(allocator.allocate(2048, 1) == 0);
+	CHECK(allocator.allocate(2048, 1) == 2048);
+	CHECK(!allocator.allocate(1, 1));
+	CHECK(allocator.statistics().free_block_count == 0);
+	CHECK(allocator.statistics().largest_free_block == 0);
+}
+
+SANDBOX_TEST(freed_buddies_merge_back_into_one_block)
+{
+	buddy_allocator allocator {4096, 256};
+	std::vector<std::size_t> offsets {};
+	for (int i {}; i < 16; ++i)
+		offsets.push_back(allocator.allocate(256, 1).value());
+
+	CHECK(!allocator.allocate(1, 1));
+	for (const auto offset : offsets)
+		allocator.free(offset);
+
+	const auto& statistics = allocator.statistics();
+	CHECK(statistics.allocated == 0);
+	CHECK(statistics.requested == 0);
+	CHECK(statistics.free_block_count == 1);
+	CHECK(statistics.largest_free_block == 4096);
+	CHECK(allocator.allocate(4096, 1) == 0);
+}
+
+SANDBOX_TEST(fragmentation_counts_free_space_outside_the_largest_block)
+{
+	buddy_allocator allocator {4096, 256};
+	std::vector<std::size_t> quarters {};
+	for (int i {}; i < 4; ++i)
+		quarters.push_back(allocator.allocate(1024, 1).value());
+
+	CHECK(get_external_fragmentation(allocator.statistics()) == 0.0);
+
+	// Two free quarters that are not buddies cannot be merged into a half
+	allocator.free(quarters[0]);
+	allocator.free(quarters[2]);
+	CHECK(allocator.statistics().free_block_count == 2);
+	CHECK(allocator.statistics().largest_free_block == 1024);
+	CHECK(get_external_fragmentation(allocator.statistics()) == 0.5);
+	CHECK(!allocator.allocate(2048, 1));
+
+	allocator.free(quarters[1]);
+	CHECK(allocator.statistics().largest_free_block == 2048);
+	CHECK(get_external_fragmentation(allocator.statistics()) == 1.0 - 2048.0 / 3072.0);
+}
+
+SANDBOX_TEST(random_traffic_never_hands_out_overlapping_blocks)
+{
+	struct live_block {
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	constexpr std::size_t capacity {1 << 24};
+	constexpr std::size_t minimum_block_size {256};
+	buddy_allocator allocator {capacity, minimum_block_size};
+	std::vector<live_block> live {};
+	std::mt19937 engine {11};
+	std::uniform_int_distribution<int> size_log2 {0, 18};
+	std::uniform_int_distribution<int> alignment_log2 {0, 16};
+	for (int step {}; step < 200'000; ++step) {
+		if (live.empty() || std::bernoulli_distribution {0.55}(engine)) {
+			const auto size_limit = std::size_t {1} << size_log2(engine);
+			const auto size = std::uniform_int_distribution<std::size_t> {1, size_limit}(engine);
+			const auto alignment = std::size_t {1} << alignment_log2(engine);
+			const auto offset = allocator.allocate(size, alignment);
+			const auto block_size = std::bit_ceil(std::max({size, alignment, minimum_block_size}));
+			if (!offset) {
+				CHECK(block_size > allocator.statistics().largest_free_block);
+				continue;
+			}
+
+			CHECK(*offset % block_size == 0);
+			CHECK(*offset + block_size <= capacity);
+			live.push_back({*offset, block_size});
+		}
+		else {
+			const auto victim = std::uniform_int_distribution<std::size_t> {0, live.size() - 1}(engine);
+			allocator.free(live[victim].offset);
+			live[victim] = live.back();
+			live.pop_back();
+		}
+	}
+
+	std::sort(live.begin(), live.end(), [](const live_block& a, const live_block& b) { return a.offset < b.offset; });
+	std::size_t allocated {};
+	for (std::size_t i {}; i < live.size(); ++i) {
+		if (i + 1 < live.size())
+			CHECK(live[i].offset + live[i].size <= live[i + 1].offset);
+
+		allocated += live[i].size;
+	}
+
+	CHECK(allocator.statistics().allocated == allocated);
+	for (const auto& block : live)
+		allocator.free(block.offset);
+
+	CHECK(allocator.statistics().free_block_count == 1);
+	CHECK(allocator.statistics().largest_free_block == capacity);
+}
@@ -0,0 +1,148 @@
+#include "../import/pch.h"
+
+#include "../import/float_parser.h"
+#include "test_harness.h"
+
+#include <random>
+#include <string>
+
+namespace sandbox::testing {
+	namespace {
+		float parse_reference(std::string_view text)
+		{
+			auto value = 0.0f;
+			std::from_chars(text.data(), std::next(text.data(), text.size()), value);
+			return value;
+		}
+
+		// Bitwise, so that signed zeroes are told apart
+		bool matches_reference(std::string_view text)
+		{
+			std::array<float, 1> value {};
+			if (parse_float_record(text, value, 1) != 0)
+				return false;
+
+			return std::bit_cast<std::uint32_t>(value[0]) == std::bit_cast<std::uint32_t>(parse_reference(text));
+		}
+
+		std::size_t count_malformed(std::string_view text, std::size_t required)
+		{
+			std::array<float, 3> values {};
+			return parse_float_record(text, values, required);
+		}
+	}
+
+	// The fast path takes mantissas up to 2^24 and up to ten fraction digits; either side of each limit must agree
+	SANDBOX_TEST(decimals_at_the_exact_limits_match_from_chars)
+	{
+		for (const auto text :
+			 {"16777215",
+			  "16777216",
+			  "16777217",
+			  "-16777217",
+			  "1677721.6",
+			  "1677721.7",
+			  "0.16777216",
+			  "0.16777217",
+			  "0.0000000001",
+			  "0.0000016777",
+			  "0.0000167772",
+			  "0.00000000001",
+			  "0.00000123456",
+			  "9999999999",
+			  "12345678901",
+			  "-0",
+			  "-0.0",
+			  "0.1",
+			  "0.3",
+			  "3.",
+			  "100.25",
+			  "00001.5000"})
+			CHECK(matches_reference(text));
+	}
+
+	SANDBOX_TEST(random_decimals_match_from_chars)
+	{
+		std::mt19937 generator {0x5eed};
+		std::uniform_int_distribution<int> digit_count {0, 12};
+		std::uniform_int_distribution<int> digit {0, 9};
+		std::size_t mismatches {};
+		for (std::size_t i {}; i < 200000; ++i) {
+			std::string text {generator() % 2 ? "-" : ""};
+			const auto integer_digits = std::max(digit_count(generator), 1);
+			for (auto j = 0; j < integer_digits; ++j)
+				text += static_cast<char>('0' + digit(generator));
+
+			const auto fraction_digits = digit_count(generator);
+			if (fraction_digits > 0) {
+				text += '.';
+				for (auto j = 0; j < fraction_digits; ++j)
+					text += static_cast<char>('0' + digit(generator));
+			}
+
+			mismatches += matches_reference(text) ? 0 : 1;
+		}
+
+		CHECK(mismatches == 0);
+	}
+
+	SANDBOX_TEST(exponents_and_special_values_match_from_chars)
+	{
+		for (const auto text : {"1e3", "1.5e-3", "-2.5E-2", "3.4e38", "1e-45", "inf", "-inf", "infinity"})
+			CHECK(matches_reference(text));
+
+		std::array<float, 1> value {};
+		CHECK(parse_float_record("nan", value, 1) == 0);
+		CHECK(std::isnan(value[0]));
+
+		// Out of range for a float, which std::from_chars() reports as an error
+		CHECK(count_malformed("1e39", 1) == 1);
+	}
+
+	SANDBOX_TEST(record_reads_every_component)
+	{
+		std::array<float, 3> values {};
+		CHECK(parse_float_record("  1.5   -2 3e1 ", values, 3) == 0);
+		CHECK(values[0] == 1.5f);
+		CHECK(values[1] == -2.0f);
+		CHECK(values[2] == 30.0f);
+
+		// Anything past the last component is ignored
+		CHECK(parse_float_record("4 5 6 7", values, 3) == 0);
+		CHECK(values[2] == 6.0f);
+	}
+
+	SANDBOX_TEST(missing_components_count_only_when_required)
+	{
+		CHECK(count_malformed("1 2", 3) == 1);
+		CHECK(count_malformed("1", 3) == 2);
+		CHECK(count_malformed("", 3) == 3);
+		CHECK(count_malformed("   ", 1) == 1);
+		CHECK(count_malformed("1", 1) == 0);
+		CHECK(count_malformed("1 2", 2) == 0);
+
+		std::array<float, 3> values {7.0f, 7.0f, 7.0f};
+		parse_float_record("1", values, 1);
+		CHECK(values[1] == 0.0f);
+		CHECK(values[2] == 0.0f);
+	}
+
+	SANDBOX_TEST(trailing_junk_is_malformed)
+	{
+		CHECK(count_malformed("1.5x 2 3", 3) == 1);
+		CHECK(count_malformed("1 2.0.0 3", 3) == 1);
+		CHECK(count_malformed("1 2 3e", 3) == 1);
+		CHECK(count_malformed("1,2 3 4", 3) == 1);
+	}
+
+	SANDBOX_TEST(unparseable_components_are_malformed_and_zeroed)
+	{
+		std::array<float, 3> values {7.0f, 7.0f, 7.0f};
+		CHECK(parse_float_record("abc 2 -", values, 3) == 2);
+		CHECK(values[0] == 0.0f);
+		CHECK(values[1] == 2.0f);
+		CHECK(values[2] == 0.0f);
+
+		CHECK(count_malformed("- . e5", 1) == 3);
+	}
+}
@@ -0,0 +1,204 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/frame_pacing.h"
+#include "test_harness.h"
+
+#include <latch>
+
+namespace sandbox::testing {
+	namespace {
+		using namespace std::chrono_literals;
+
+		// Completes after it has been polled `polls_to_complete` times, or as soon as something blocks on it; records
+		// how it was waited on
+		class fake_fence final : public awaitable_fence {
+		public:
+			explicit fake_fence(std::uint64_t polls_to_complete, std::uint64_t value = 0) noexcept :
+				m_polls_to_complete {polls_to_complete},
+				m_value {value},
+				m_target {},
+				m_poll_count {},
+				m_blocked_values {}
+			{
+			}
+
+			std::uint64_t completed_value() const override
+			{
+				if (++m_poll_count >= m_polls_to_complete)
+					m_value = std::max(m_value, m_target);
+
+				return m_value;
+			}
+
+			void block_until(std::uint64_t value) override
+			{
+				m_blocked_values.push_back(value);
+				m_value = std::max(m_value, value);
+			}
+
+			void signal_on_poll(std::uint64_t target) noexcept { m_target = target; }
+
+			std::uint64_t poll_count() const noexcept { return m_poll_count; }
+			const std::vector<std::uint64_t>& blocked_values() const noexcept { return m_blocked_values; }
+
+		private:
+			std::uint64_t m_polls_to_complete;
+			mutable std::uint64_t m_value;
+			std::uint64_t m_target;
+			mutable std::uint64_t m_poll_count;
+			std::vector<std::uint64_t> m_blocked_values;
+		};
+
+		// Only ever completes when another thread signals it, like a GPU fence. The signalling thread waits on
+		// `waited_on()` before starting its work, so that the pacer's clock is always running by the time it does.
+		class threaded_fence final : public awaitable_fence {
+		public:
+			enum class release {
+				on_first_poll,
+				on_first_block
+			};
+
+			explicit threaded_fence(release release_on) noexcept :
+				m_release_on {release_on},
+				m_value {},
+				m_block_count {},
+				m_released {},
+				m_waiter {1}
+			{
+			}
+
+			std::uint64_t completed_value() const override
+			{
+				if (m_release_on == release::on_first_poll)
+					release_waiter();
+
+				return m_value.load();
+			}
+
+			void block_until(std::uint64_t value) override
+			{
+				++m_block_count;
+				release_waiter();
+				while (m_value.load() < value)
+					std::this_thread::sleep_for(100us);
+			}
+
+			void waited_on() const noexcept { m_waiter.wait(); }
+			void signal(std::uint64_t value) noexcept { m_value.store(value); }
+			int block_count() const noexcept { return m_block_count.load(); }
+
+		private:
+			release m_release_on;
+			std::atomic_uint64_t m_value;
+			std::atomic_int m_block_count;
+			mutable std::atomic_flag m_released;
+			mutable std::latch m_waiter;
+
+			void release_waiter() const noexcept
+			{
+				if (!m_released.test_and_set())
+					m_waiter.count_down();
+			}
+		};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+using namespace std::chrono_literals;
+
+SANDBOX_TEST(a_completed_fence_is_not_waited_on)
+{
+	frame_pacer pacer {{.spin_duration {0ns}}};
+	fake_fence fence {0, 5};
+	pacer.wait(fence, 5);
+	CHECK(fence.blocked_values().empty());
+	CHECK(pacer.statistics().wait_count == 1);
+	CHECK(pacer.statistics().blocked_count == 0);
+}
+
+SANDBOX_TEST(a_zero_spin_duration_blocks_straight_away)
+{
+	frame_pacer pacer {{.spin_duration {0ns}}};
+	fake_fence fence {std::numeric_limits<std::uint64_t>::max()};
+	pacer.wait(fence, 3);
+	CHECK(fence.blocked_values() == std::vector<std::uint64_t> {3});
+	CHECK(fence.poll_count() == 1);
+	CHECK(pacer.statistics().blocked_count == 1);
+}
+
+SANDBOX_TEST(an_unbounded_spin_never_blocks)
+{
+	frame_pacer pacer {{.spin_duration {std::chrono::nanoseconds::max()}}};
+	fake_fence fence {1000};
+	fence.signal_on_poll(7);
+	pacer.wait(fence, 7);
+	CHECK(fence.blocked_values().empty());
+	CHECK(fence.poll_count() == 1000);
+	CHECK(pacer.statistics().blocked_count == 0);
+}
+
+SANDBOX_TEST(a_wait_that_outlasts_the_spin_blocks)
+{
+	frame_pacer pacer {{.spin_duration {2ms}}};
+	fake_fence fence {std::numeric_limits<std::uint64_t>::max()};
+	pacer.wait(fence, 1);
+	CHECK(fence.blocked_values() == std::vector<std::uint64_t> {1});
+	CHECK(fence.poll_count() > 1);
+	CHECK(pacer.statistics().last_wait >= 2ms);
+}
+
+SANDBOX_TEST(a_fence_signalled_during_the_spin_is_caught_without_blocking)
+{
+	frame_pacer pacer {{.spin_duration {10s}}};
+	threaded_fence fence {threaded_fence::release::on_first_poll};
+	std::jthread gpu {[&fence] {
+		fence.waited_on();
+		std::this_thread::sleep_for(5ms);
+		fence.signal(1);
+	}};
+
+	pacer.wait(fence, 1);
+	CHECK(fence.block_count() == 0);
+	CHECK(pacer.statistics().last_wait >= 5ms);
+}
+
+SANDBOX_TEST(a_fence_signalled_after_the_spin_is_blocked_on)
+{
+	frame_pacer pacer {{.spin_duration {1ms}}};
+	threaded_fence fence {threaded_fence::release::on_first_block};
+	std::jthread gpu {[&fence] {
+		fence.waited_on();
+		std::this_thread::sleep_for(20ms);
+		fence.signal(1);
+	}};
+
+	pacer.wait(fence, 1);
+	CHECK(fence.block_count() == 1);
+	CHECK(fence.completed_value() == 1);
+	CHECK(pacer.statistics().blocked_count == 1);
+	CHECK(pacer.statistics().last_wait >= 20ms);
+}
+
+SANDBOX_TEST(wait_statistics_accumulate)
+{
+	frame_pacer pacer {{.spin_duration {0ns}}};
+	for (std::uint64_t value {1}; value <= 3; ++value) {
+		threaded_fence fence {threaded_fence::release::on_first_block};
+		std::jthread gpu {[&fence, value] {
+			fence.waited_on();
+			std::this_thread::sleep_for(std::chrono::milliseconds {value * 2});
+			fence.signal(value);
+		}};
+
+		pacer.wait(fence, value);
+	}
+
+	const auto& statistics = pacer.statistics();
+	CHECK(statistics.wait_count == 3);
+	CHECK(statistics.blocked_count == 3);
+	CHECK(statistics.longest_wait >= statistics.last_wait);
+	CHECK(statistics.last_wait >= 6ms);
+	CHECK(statistics.total_wait >= 12ms);
+	CHECK(statistics.total_wait >= statistics.longest_wait);
+}
@@ -0,0 +1,56 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/frame_ring.h"
+#include "test_harness.h"
+
+using namespace sandbox;
+
+SANDBOX_TEST(frame_counts_outside_one_to_four_are_rejected)
+{
+	CHECK_THROWS(frame_ring {0}, std::invalid_argument);
+	CHECK_THROWS(frame_ring {frame_ring::max_frames_in_flight + 1}, std::invalid_argument);
+	for (std::size_t count {1}; count <= frame_ring::max_frames_in_flight; ++count)
+		CHECK(frame_ring {count}.size() == count);
+}
+
+SANDBOX_TEST(fresh_slots_are_reusable_at_once)
+{
+	frame_ring ring {3};
+	CHECK(ring.current_index() == 0);
+	CHECK(ring.last_submitted() == 0);
+	for (int i {}; i < 3; ++i) {
+		CHECK(ring.reusable_after() == 0);
+		ring.submit();
+	}
+}
+
+SANDBOX_TEST(submissions_claim_consecutive_fence_values)
+{
+	frame_ring ring {2};
+	CHECK(ring.submit() == 1);
+	CHECK(ring.submit() == 2);
+	CHECK(ring.submit() == 3);
+	CHECK(ring.last_submitted() == 3);
+}
+
+SANDBOX_TEST(each_slot_waits_for_the_frame_submitted_n_frames_earlier)
+{
+	for (std::size_t count {1}; count <= frame_ring::max_frames_in_flight; ++count) {
+		frame_ring ring {count};
+		for (std::uint64_t frame {1}; frame <= 20; ++frame) {
+			CHECK(ring.current_index() == (frame - 1) % count);
+
+			// The CPU may run `count` frames ahead: frame f reuses the slot of frame f - count
+			CHECK(ring.reusable_after() == (frame > count ? frame - count : 0));
+			CHECK(ring.submit() == frame);
+		}
+	}
+}
+
+SANDBOX_TEST(a_single_slot_waits_for_the_previous_frame)
+{
+	frame_ring ring {1};
+	ring.submit();
+	CHECK(ring.current_index() == 0);
+	CHECK(ring.reusable_after() == ring.last_submitted());
+}
@@ -0,0 +1,100 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/indirect_culling.h"
+#include "../runtime/instance_transforms.h"
+#include "benchmark_harness.h"
+
+#include <numbers>
+#include <random>
+
+namespace sandbox {
+	namespace {
+		// As DirectX::XMMatrixPerspectiveFovLH() builds it, for a camera at the origin looking along +z
+		matrix4x4 make_projection(float vertical_fov, float aspect_ratio, float near_z, float far_z) noexcept
+		{
+			const auto y_scale = 1.0f / std::tan(vertical_fov / 2.0f);
+			const auto depth_scale = far_z / (far_z - near_z);
+			return {{{
+				{y_scale / aspect_ratio, 0.0f, 0.0f, 0.0f},
+				{0.0f, y_scale, 0.0f, 0.0f},
+				{0.0f, 0.0f, depth_scale, 1.0f},
+				{0.0f, 0.0f, -near_z * depth_scale, 0.0f}}}};
+		}
+
+		// Uniformly random rotations and uneven scales, scattered through a cube centered on the camera, so that most
+		// instances fail on one plane or another
+		std::vector<instance_transform> make_transforms(std::size_t count)
+		{
+			std::mt19937 engine {1};
+			std::normal_distribution<float> component {};
+			std::uniform_real_distribution<float> scale {0.25f, 4.0f};
+			std::uniform_real_distribution<float> position {-500.0f, 500.0f};
+			std::vector<instance_transform> transforms(count);
+			for (auto& [rotation, scales, translation] : transforms) {
+				const quaternion raw {component(engine), component(engine), component(engine), component(engine)};
+				const auto length = std::sqrt(raw.x * raw.x + raw.y * raw.y + raw.z * raw.z + raw.w * raw.w);
+				rotation = {raw.x / length, raw.y / length, raw.z / length, raw.w / length};
+				scales = {scale(engine), scale(engine), scale(engine)};
+				translation = {position(engine), position(engine), position(engine)};
+			}
+
+			return transforms;
+		}
+	}
+}
+
+// Times the reference for the engine's culling shaders over each transform encoding they read, to show what decoding
+// costs next to the plane tests themselves
+// Usage: frustum_culling_benchmark [instance count (default 1M)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto instance_count = get_count_argument(argc, argv, 1, 1'000'000);
+	const auto transforms = make_transforms(instance_count);
+	const auto planes = extract_frustum(make_projection(std::numbers::pi_v<float> / 3.0f, 16.0f / 9.0f, 0.1f, 400.0f));
+	constexpr vector3 object_center {0.0f, 0.0f, 0.0f};
+	constexpr float object_radius {1.0f};
+
+	// The bound every encoding approximates, with the transforms already applied
+	std::vector<vector3> centers(instance_count);
+	std::vector<float> radii(instance_count);
+	for (std::size_t i {}; i < instance_count; ++i) {
+		centers[i] = transform_point(transforms[i], object_center);
+		radii[i] = object_radius * get_max_scale(transforms[i]);
+	}
+
+	std::vector<std::uint32_t> visible(instance_count);
+	std::size_t sphere_count {};
+	constexpr std::size_t repeat_count {10};
+	const auto spheres = time_fastest(repeat_count, [&] {
+		sphere_count = 0;
+		for (std::size_t i {}; i < instance_count; ++i) {
+			if (is_sphere_visible(planes, centers[i], radii[i]))
+				visible[sphere_count++] = gsl::narrow_cast<std::uint32_t>(i);
+		}
+	});
+
+	keep(visible);
+	std::cout << instance_count << " instances, " << sphere_count << " visible\n";
+	report("world-space spheres", spheres, gsl::narrow_cast<double>(instance_count), "instance");
+	for (const auto encoding : {transform_encoding::affine, transform_encoding::packed}) {
+		std::vector<std::byte> encoded(instance_count * get_encoded_size(encoding));
+		encode_transforms(encoding, transforms, encoded);
+		const culling_scene scene {
+			.planes {planes},
+			.object_center {object_center},
+			.object_radius {object_radius},
+			.encoding {encoding},
+			.transforms {encoded},
+			.instance_count {instance_count}};
+
+		std::uint32_t visible_count {};
+		const auto culled = time_fastest(repeat_count, [&] { visible_count = cull_indirect(scene, {}, {}, visible); });
+		keep(visible);
+		const auto name = encoding == transform_encoding::affine ? "affine" : "packed";
+		std::cout << name << ": " << visible_count << " visible\n";
+		report(name, culled, gsl::narrow_cast<double>(instance_count), "instance");
+	}
+}
@@ -0,0 +1,61 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/half_float.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+#ifdef __F16C__
+		std::uint16_t to_half_f16c(float value) noexcept
+		{
+			return gsl::narrow_cast<std::uint16_t>(
+				_mm_extract_epi16(_mm_cvtps_ph(_mm_set_ss(value), _MM_FROUND_TO_NEAREST_INT), 0));
+		}
+#endif
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(every_half_round_trips)
+{
+	for (std::uint32_t bits {}; bits <= 0xffffu; ++bits) {
+		const auto half = gsl::narrow_cast<std::uint16_t>(bits);
+		const auto value = from_half(half);
+		// Signalling NaNs come back quieted
+		CHECK(to_half(value) == (std::isnan(value) ? half | 0x0200u : half));
+	}
+}
+
+SANDBOX_TEST(rounding_matches_the_hardware)
+{
+#ifdef __F16C__
+	// Every float whose low 12 mantissa bits are 0x000, 0x001, 0x7ff, 0x800 (an exact tie) or 0xfff, which covers each
+	// half's neighbourhood and every rounding boundary, in both signs and across the subnormal and overflow ranges
+	constexpr std::array<std::uint32_t, 5> low_bits {0x000u, 0x001u, 0x7ffu, 0x800u, 0xfffu};
+	std::size_t mismatches {};
+	for (std::uint32_t high {}; high < (1u << 20); ++high) {
+		for (const auto low : low_bits) {
+			const auto value = std::bit_cast<float>(high << 12 | low);
+			mismatches += to_half(value) == to_half_f16c(value) ? 0 : 1;
+		}
+	}
+
+	CHECK(mismatches == 0);
+#endif
+}
+
+SANDBOX_TEST(special_values_convert)
+{
+	CHECK(to_half(0.0f) == 0x0000u);
+	CHECK(to_half(-0.0f) == 0x8000u);
+	CHECK(to_half(1.0f) == 0x3c00u);
+	CHECK(to_half(65504.0f) == 0x7bffu);
+	CHECK(to_half(65520.0f) == 0x7c00u);
+	CHECK(to_half(std::numeric_limits<float>::infinity()) == 0x7c00u);
+	CHECK(to_half(0x1p-24f) == 0x0001u);
+	CHECK(to_half(0x1p-25f) == 0x0000u);
+	CHECK(from_half(0x0001u) == 0x1p-24f);
+	CHECK(from_half(0xfc00u) == -std::numeric_limits<float>::infinity());
+}
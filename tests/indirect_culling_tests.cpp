@@ -0,0 +1,261 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/indirect_culling.h"
+#include "../runtime/instance_transforms.h"
+#include "test_harness.h"
+
+#include <numbers>
+#include <random>
+
+namespace sandbox::testing {
+	namespace {
+		constexpr vector3 object_center {0.5f, -1.0f, 2.0f};
+		constexpr float object_radius {1.5f};
+
+		// As DirectX::XMMatrixPerspectiveFovLH() builds it, for a camera at the origin looking along +z
+		frustum make_frustum()
+		{
+			const auto y_scale = 1.0f / std::tan(std::numbers::pi_v<float> / 6.0f);
+			constexpr auto near_z = 0.1f;
+			constexpr auto far_z = 200.0f;
+			constexpr auto depth_scale = far_z / (far_z - near_z);
+			return extract_frustum({{{
+				{y_scale, 0.0f, 0.0f, 0.0f},
+				{0.0f, y_scale, 0.0f, 0.0f},
+				{0.0f, 0.0f, depth_scale, 1.0f},
+				{0.0f, 0.0f, -near_z * depth_scale, 0.0f}}}});
+		}
+
+		// Around the frustum, so that some instances are culled by every plane and many are kept
+		vector3 make_translation(std::mt19937& engine)
+		{
+			std::uniform_real_distribution<float> across {-150.0f, 150.0f};
+			std::uniform_real_distribution<float> along {-20.0f, 220.0f};
+			return {across(engine), across(engine), along(engine)};
+		}
+
+		// Half-turns about each axis and scales in eighths, all of which survive either encoding exactly, so that
+		// the shader's decoding and the CPU's transforms agree to the bit
+		std::vector<instance_transform> make_axis_aligned_transforms(std::size_t count)
+		{
+			constexpr std::array<quaternion, 4> rotations {{
+				{0.0f, 0.0f, 0.0f, 1.0f},
+				{1.0f, 0.0f, 0.0f, 0.0f},
+				{0.0f, 1.0f, 0.0f, 0.0f},
+				{0.0f, 0.0f, -1.0f, 0.0f}}};
+
+			std::mt19937 engine {1};
+			std::uniform_int_distribution<std::size_t> rotation {0, rotations.size() - 1};
+			std::uniform_int_distribution<int> eighths {2, 32};
+			const auto scale = [&] { return static_cast<float>(eighths(engine)) / 8.0f; };
+			std::vector<instance_transform> transforms {};
+			for (std::size_t i {}; i < count; ++i) {
+				transforms.push_back(
+					{.rotation {rotations.at(rotation(engine))},
+					 .scale {scale(), scale(), scale()},
+					 .translation {make_translation(engine)}});
+			}
+
+			return transforms;
+		}
+
+		std::vector<instance_transform> make_rotated_transforms(std::size_t count)
+		{
+			std::mt19937 engine {2};
+			std::normal_distribution<float> component {};
+			std::uniform_real_distribution<float> scale {0.25f, 4.0f};
+			std::vector<instance_transform> transforms {};
+			for (std::size_t i {}; i < count; ++i) {
+				const std::array raw {component(engine), component(engine), component(engine), component(engine)};
+				const auto length = std::sqrt(raw[0] * raw[0] + raw[1] * raw[1] + raw[2] * raw[2] + raw[3] * raw[3]);
+				transforms.push_back(
+					{.rotation {raw[0] / length, raw[1] / length, raw[2] / length, raw[3] / length},
+					 .scale {scale(engine), scale(engine), scale(engine)},
+					 .translation {make_translation(engine)}});
+			}
+
+			return transforms;
+		}
+
+		std::vector<std::byte> encode(transform_encoding encoding, const std::vector<instance_transform>& transforms)
+		{
+			std::vector<std::byte> encoded(transforms.size() * get_encoded_size(encoding));
+			encode_transforms(encoding, transforms, encoded);
+			return encoded;
+		}
+
+		struct sphere {
+			vector3 center;
+			float radius;
+		};
+
+		// Each instance's sphere as the CPU computes it from the unencoded transform
+		std::vector<sphere> get_bounding_spheres(const std::vector<instance_transform>& transforms)
+		{
+			std::vector<sphere> spheres {};
+			for (const auto& transform : transforms)
+				spheres.push_back({transform_point(transform, object_center), object_radius * get_max_scale(transform)});
+
+			return spheres;
+		}
+
+		std::vector<std::uint32_t> cull_on_cpu(const frustum& planes, const std::vector<instance_transform>& transforms)
+		{
+			const auto spheres = get_bounding_spheres(transforms);
+			std::vector<std::uint32_t> visible {};
+			for (std::size_t i {}; i < spheres.size(); ++i) {
+				if (is_sphere_visible(planes, spheres[i].center, spheres[i].radius))
+					visible.push_back(gsl::narrow_cast<std::uint32_t>(i));
+			}
+
+			return visible;
+		}
+
+		std::vector<std::uint32_t> cull_on_reference(const culling_scene& scene)
+		{
+			std::vector<draw_indexed_arguments> arguments {};
+			std::vector<std::uint32_t> visible(scene.instance_count);
+			visible.resize(cull_indirect(scene, {}, arguments, visible));
+			return visible;
+		}
+
+		culling_scene make_scene(const frustum& planes, transform_encoding encoding, gsl::span<const std::byte> encoded)
+		{
+			return {
+				.planes {planes},
+				.object_center {object_center},
+				.object_radius {object_radius},
+				.encoding {encoding},
+				.transforms {encoded},
+				.instance_count {encoded.size() / get_encoded_size(encoding)}};
+		}
+
+		constexpr std::array encodings {transform_encoding::affine, transform_encoding::packed};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(reference_matches_cpu_culling_of_exactly_encoded_instances)
+{
+	const auto planes = make_frustum();
+	for (const auto count : {0, 1, 63, 64, 65, 129, 5000}) {
+		const auto transforms = make_axis_aligned_transforms(gsl::narrow_cast<std::size_t>(count));
+		const auto expected = cull_on_cpu(planes, transforms);
+		if (count == 5000)
+			CHECK(!expected.empty() && expected.size() < transforms.size() / 2);
+
+		for (const auto encoding : encodings) {
+			const auto encoded = encode(encoding, transforms);
+			CHECK(cull_on_reference(make_scene(planes, encoding, encoded)) == expected);
+		}
+	}
+}
+
+// Rounding differs between the two paths once rotations are arbitrary, and the packed encoding quantizes them, so
+// only instances clearly inside or clearly outside are compared
+SANDBOX_TEST(reference_decodes_rotated_instances_within_rounding)
+{
+	constexpr auto margin = 0.1f;
+	const auto planes = make_frustum();
+	const auto transforms = make_rotated_transforms(5000);
+	const auto spheres = get_bounding_spheres(transforms);
+	for (const auto encoding : encodings) {
+		const auto encoded = encode(encoding, transforms);
+		const auto visible = cull_on_reference(make_scene(planes, encoding, encoded));
+		CHECK(std::ranges::is_sorted(visible));
+		std::size_t compared_count {};
+		for (std::size_t i {}; i < transforms.size(); ++i) {
+			const auto& [center, radius] = spheres[i];
+			const auto is_kept = std::ranges::binary_search(visible, gsl::narrow_cast<std::uint32_t>(i));
+			if (is_sphere_visible(planes, center, radius - margin)) {
+				CHECK(is_kept);
+				++compared_count;
+			}
+			else if (!is_sphere_visible(planes, center, radius + margin)) {
+				CHECK(!is_kept);
+				++compared_count;
+			}
+		}
+
+		CHECK(compared_count > transforms.size() * 9 / 10);
+	}
+}
+
+SANDBOX_TEST(decoded_transforms_match_the_cpu_matrices)
+{
+	const auto transforms = make_axis_aligned_transforms(100);
+	for (const auto encoding : encodings) {
+		const auto encoded = encode(encoding, transforms);
+		for (std::size_t i {}; i < transforms.size(); ++i) {
+			const auto& [rows] = decode_transform(encoding, encoded, i);
+			const auto& [x, y, z] = transform_point(transforms[i], object_center);
+			const auto apply = [](const std::array<float, 4>& row) {
+				return row[0] * object_center.x + row[1] * object_center.y + row[2] * object_center.z + row[3];
+			};
+
+			CHECK(apply(rows[0]) == x && apply(rows[1]) == y && apply(rows[2]) == z);
+		}
+
+		CHECK_THROWS(decode_transform(encoding, encoded, transforms.size()), std::out_of_range);
+	}
+}
+
+SANDBOX_TEST(every_draw_takes_the_visible_total)
+{
+	const auto transforms = make_axis_aligned_transforms(1000);
+	const auto encoded = encode(transform_encoding::affine, transforms);
+	const std::array submeshes {
+		submesh {.first_index {0}, .index_count {36}, .base_vertex {0}},
+		submesh {.first_index {36}, .index_count {12}, .base_vertex {24}}};
+
+	std::vector<draw_indexed_arguments> templates {};
+	append_draw_arguments(templates, submeshes);
+	std::vector<draw_indexed_arguments> arguments(templates.size());
+	std::vector<std::uint32_t> visible(transforms.size());
+	const auto scene = make_scene(make_frustum(), transform_encoding::affine, encoded);
+	const auto total = cull_indirect(scene, templates, arguments, visible);
+	CHECK(total == cull_on_cpu(scene.planes, transforms).size());
+	for (std::size_t i {}; i < templates.size(); ++i) {
+		CHECK(arguments[i].index_count_per_instance == submeshes.at(i).index_count);
+		CHECK(arguments[i].start_index_location == submeshes.at(i).first_index);
+		CHECK(arguments[i].base_vertex_location == submeshes.at(i).base_vertex);
+		CHECK(arguments[i].start_instance_location == 0);
+		CHECK(arguments[i].instance_count == total);
+	}
+}
+
+// More groups than the scan pass covers at once, so that its running sum carries across chunks
+SANDBOX_TEST(group_offsets_are_exclusive_sums_across_chunks)
+{
+	std::vector<std::uint32_t> counts(cull_group_size * 3 + 5);
+	for (std::size_t i {}; i < counts.size(); ++i)
+		counts[i] = gsl::narrow_cast<std::uint32_t>(i % 7);
+
+	auto offsets = counts;
+	const auto total = scan_visible_groups(offsets, {}, {});
+	std::uint32_t sum {};
+	for (std::size_t i {}; i < counts.size(); ++i) {
+		CHECK(offsets[i] == sum);
+		sum += counts[i];
+	}
+
+	CHECK(total == sum);
+}
+
+SANDBOX_TEST(undersized_buffers_are_rejected)
+{
+	const auto transforms = make_axis_aligned_transforms(10);
+	const auto encoded = encode(transform_encoding::packed, transforms);
+	auto scene = make_scene(make_frustum(), transform_encoding::packed, encoded);
+	std::vector<draw_indexed_arguments> templates(2);
+	std::vector<draw_indexed_arguments> arguments(2);
+	std::vector<std::uint32_t> visible(10);
+	CHECK_THROWS(cull_indirect(scene, templates, gsl::span {arguments}.first(1), visible), std::invalid_argument);
+	CHECK_THROWS(cull_indirect(scene, templates, arguments, gsl::span {visible}.first(9)), std::invalid_argument);
+
+	scene.instance_count = 11;
+	visible.resize(11);
+	CHECK_THROWS(cull_indirect(scene, templates, arguments, visible), std::invalid_argument);
+}
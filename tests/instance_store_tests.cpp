@@ -0,0 +1,182 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/instance_store.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		// Told apart by their x translations
+		instance_transform make_transform(float x) noexcept
+		{
+			return {.rotation {0.0f, 0.0f, 0.0f, 1.0f}, .scale {1.0f, 1.0f, 1.0f}, .translation {x, 0.0f, 0.0f}};
+		}
+
+		std::vector<float> get_x_translations(const instance_store& store)
+		{
+			std::vector<float> translations {};
+			for (const auto& transform : store.transforms())
+				translations.push_back(transform.translation.x);
+
+			return translations;
+		}
+
+		// Adds `count` instances numbered from 0, and takes their dirty ranges for every copy
+		std::vector<instance_handle> fill(instance_store& store, std::size_t copy_count, std::size_t count)
+		{
+			std::vector<instance_handle> handles {};
+			for (std::size_t i {}; i < count; ++i)
+				handles.push_back(store.add(make_transform(static_cast<float>(i))));
+
+			for (std::size_t copy {}; copy < copy_count; ++copy)
+				store.take_dirty_ranges(copy);
+
+			return handles;
+		}
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(handles_refer_to_their_instances)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 3);
+	CHECK(store.size() == 3);
+	for (const auto& handle : handles)
+		CHECK(store.contains(handle));
+
+	CHECK(store.update(handles[1], make_transform(10.0f)));
+	CHECK((get_x_translations(store) == std::vector {0.0f, 10.0f, 2.0f}));
+	CHECK(!store.contains({.slot {3}, .generation {}}));
+}
+
+SANDBOX_TEST(removed_handles_go_stale)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 3);
+	CHECK(store.remove(handles[1]));
+	CHECK(!store.contains(handles[1]));
+	CHECK(!store.remove(handles[1]));
+	CHECK(!store.update(handles[1], make_transform(10.0f)));
+	CHECK(store.size() == 2);
+	CHECK(store.contains(handles[0]));
+	CHECK(store.contains(handles[2]));
+}
+
+SANDBOX_TEST(reused_slots_start_a_new_generation)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 2);
+	store.remove(handles[0]);
+	const auto reused = store.add(make_transform(10.0f));
+	CHECK(reused.slot == handles[0].slot);
+	CHECK(reused.generation == handles[0].generation + 1);
+	CHECK(store.contains(reused));
+	CHECK(!store.contains(handles[0]));
+
+	// The stale handle cannot touch the instance now in its slot
+	CHECK(!store.update(handles[0], make_transform(20.0f)));
+	CHECK(!store.remove(handles[0]));
+	CHECK((get_x_translations(store) == std::vector {1.0f, 10.0f}));
+}
+
+SANDBOX_TEST(removal_moves_the_last_instance_into_the_hole)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 4);
+	store.remove(handles[0]);
+	CHECK((get_x_translations(store) == std::vector {3.0f, 1.0f, 2.0f}));
+
+	// The moved instance's handle follows it
+	CHECK(store.update(handles[3], make_transform(30.0f)));
+	CHECK((get_x_translations(store) == std::vector {30.0f, 1.0f, 2.0f}));
+
+	store.remove(handles[2]);
+	CHECK((get_x_translations(store) == std::vector {30.0f, 1.0f}));
+	store.remove(handles[3]);
+	store.remove(handles[1]);
+	CHECK(store.size() == 0);
+}
+
+SANDBOX_TEST(every_copy_sees_every_change_once)
+{
+	instance_store store {2};
+	for (int i {}; i < 4; ++i)
+		store.add(make_transform(static_cast<float>(i)));
+
+	const std::vector<dirty_range> whole {{.first {}, .count {4}}};
+	CHECK(store.take_dirty_ranges(0) == whole);
+	CHECK(store.take_dirty_ranges(0).empty());
+	CHECK(store.take_dirty_ranges(1) == whole);
+	CHECK(store.take_dirty_ranges(1).empty());
+}
+
+SANDBOX_TEST(dirty_ranges_are_sorted_and_merged)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 100);
+	for (const auto index : {7, 3, 2, 50, 3, 51, 52})
+		store.update(handles.at(index), make_transform(-1.0f));
+
+	const std::vector<dirty_range> expected {
+		{.first {2}, .count {2}},
+		{.first {7}, .count {1}},
+		{.first {50}, .count {3}}};
+
+	CHECK(store.take_dirty_ranges(0) == expected);
+}
+
+SANDBOX_TEST(removal_dirties_the_hole_only)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 10);
+	store.remove(handles[4]);
+	CHECK((store.take_dirty_ranges(0) == std::vector<dirty_range> {{.first {4}, .count {1}}}));
+
+	// Removing the last instance leaves nothing to rewrite, and changes past the new end are dropped
+	store.update(handles[8], make_transform(-1.0f));
+	store.remove(handles[8]);
+	CHECK(store.take_dirty_ranges(0).empty());
+}
+
+SANDBOX_TEST(copies_left_behind_catch_up_across_removals)
+{
+	instance_store store {2};
+	const auto handles = fill(store, 2, 10);
+	store.update(handles[9], make_transform(-1.0f));
+	CHECK((store.take_dirty_ranges(0) == std::vector<dirty_range> {{.first {9}, .count {1}}}));
+
+	// Copy 1 has not caught up with the update, whose element no longer exists
+	store.remove(handles[0]);
+	store.remove(handles[1]);
+	const std::vector<dirty_range> expected {{.first {0}, .count {2}}};
+	CHECK(store.take_dirty_ranges(0) == expected);
+	CHECK(store.take_dirty_ranges(1) == expected);
+}
+
+SANDBOX_TEST(invalidated_copies_are_rewritten_whole)
+{
+	instance_store store {2};
+	fill(store, 2, 10);
+	store.invalidate(1);
+	CHECK(store.take_dirty_ranges(0).empty());
+	CHECK((store.take_dirty_ranges(1) == std::vector<dirty_range> {{.first {}, .count {10}}}));
+}
+
+SANDBOX_TEST(scattered_changes_collapse_into_a_whole_rewrite)
+{
+	instance_store store {1};
+	const auto handles = fill(store, 1, 1000);
+	for (std::size_t i {}; i < handles.size(); i += 2)
+		store.update(handles[i], make_transform(-1.0f));
+
+	CHECK((store.take_dirty_ranges(0) == std::vector<dirty_range> {{.first {}, .count {1000}}}));
+}
+
+SANDBOX_TEST(copy_indices_are_checked)
+{
+	instance_store store {2};
+	CHECK_THROWS(store.take_dirty_ranges(2), std::out_of_range);
+	CHECK_THROWS(store.invalidate(2), std::out_of_range);
+}
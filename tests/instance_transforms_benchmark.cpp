@@ -0,0 +1,75 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/instance_transforms.h"
+#include "benchmark_harness.h"
+
+#include <random>
+
+namespace sandbox {
+	namespace {
+		// Uniformly random rotations, uneven scales and translations spread across a large world
+		std::vector<instance_transform> make_transforms(std::size_t count)
+		{
+			std::mt19937 engine {1};
+			std::normal_distribution<float> component {};
+			std::uniform_real_distribution<float> scale {0.25f, 4.0f};
+			std::uniform_real_distribution<float> position {-10'000.0f, 10'000.0f};
+			std::vector<instance_transform> transforms(count);
+			for (auto& [rotation, scales, translation] : transforms) {
+				const quaternion raw {component(engine), component(engine), component(engine), component(engine)};
+				const auto length = std::sqrt(raw.x * raw.x + raw.y * raw.y + raw.z * raw.z + raw.w * raw.w);
+				rotation = {raw.x / length, raw.y / length, raw.z / length, raw.w / length};
+				scales = {scale(engine), scale(engine), scale(engine)};
+				translation = {position(engine), position(engine), position(engine)};
+			}
+
+			return transforms;
+		}
+
+		template <typename value_type>
+		bool are_bitwise_equal(const std::vector<value_type>& left, const std::vector<value_type>& right) noexcept
+		{
+			const auto size = left.size() * sizeof(value_type);
+			return left.size() == right.size() && std::memcmp(left.data(), right.data(), size) == 0;
+		}
+	}
+}
+
+// Usage: instance_transforms_benchmark [instance count (default 1M)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto instance_count = get_count_argument(argc, argv, 1, 1'000'000);
+	const auto transforms = make_transforms(instance_count);
+	const auto count = gsl::narrow_cast<double>(instance_count);
+	std::cout << instance_count << " instances, " << sizeof(affine_transform) * count / 1e6 << " MB affine, "
+			  << sizeof(packed_transform) * count / 1e6 << " MB packed\n";
+
+	std::vector<affine_transform> scalar_affine(instance_count);
+	std::vector<affine_transform> simd_affine(instance_count);
+	std::vector<packed_transform> scalar_packed(instance_count);
+	std::vector<packed_transform> simd_packed(instance_count);
+	constexpr std::size_t repeat_count {10};
+	const auto affine_scalar = time_fastest(repeat_count, [&] { pack_affine_scalar(transforms, scalar_affine); });
+	const auto affine_simd = time_fastest(repeat_count, [&] { pack_affine(transforms, simd_affine); });
+	const auto packed_scalar = time_fastest(repeat_count, [&] { pack_quantized_scalar(transforms, scalar_packed); });
+	const auto packed_simd = time_fastest(repeat_count, [&] { pack_quantized(transforms, simd_packed); });
+	keep(scalar_affine);
+	keep(simd_affine);
+	keep(scalar_packed);
+	keep(simd_packed);
+
+	report("affine, scalar", affine_scalar, count, "instance");
+	report("affine, SIMD", affine_simd, count, "instance");
+	report("packed, scalar", packed_scalar, count, "instance");
+	report("packed, SIMD", packed_simd, count, "instance");
+	std::cout << "speedup: affine " << affine_scalar / affine_simd << "x, packed " << packed_scalar / packed_simd
+			  << "x\n";
+
+	if (!are_bitwise_equal(scalar_affine, simd_affine) || !are_bitwise_equal(scalar_packed, simd_packed)) {
+		std::cout << "packing kernels disagree\n";
+		return 1;
+	}
+}
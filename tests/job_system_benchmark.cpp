@@ -0,0 +1,87 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/job_system.h"
+#include "benchmark_harness.h"
+
+namespace sandbox {
+	namespace {
+		// Enough arithmetic per item that scaling is limited by the cores rather than by memory
+		std::uint64_t churn(std::uint64_t value) noexcept
+		{
+			for (int i {}; i < 64; ++i)
+				value = value * 6364136223846793005 + 1442695040888963407;
+
+			return value;
+		}
+	}
+}
+
+// Usage: job_system_benchmark [job count (default 1M)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto job_count = get_count_argument(argc, argv, 1, 1'000'000);
+	const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	const auto job_count_double = gsl::narrow_cast<double>(job_count);
+	constexpr std::size_t repeat_count {5};
+	std::cout << hardware_threads << " hardware threads\n";
+
+	// Scheduling overhead: empty jobs, from a thread outside the system (through the injection queue) and from a
+	// worker (through its own deque, where the other workers steal from); on a single hardware thread there are no
+	// workers, so both go through the injection queue
+	{
+		job_system jobs {hardware_threads - 1};
+		const auto injected = time_fastest(repeat_count, [&] {
+			job_counter counter {};
+			for (std::size_t i {}; i < job_count; ++i)
+				jobs.run(counter, [] {});
+
+			jobs.wait(counter);
+		});
+
+		const auto spawned = time_fastest(repeat_count, [&] {
+			job_counter root {};
+			jobs.run(root, [&] {
+				job_counter counter {};
+				for (std::size_t i {}; i < job_count; ++i)
+					jobs.run(counter, [] {});
+
+				jobs.wait(counter);
+			});
+
+			jobs.wait(root);
+		});
+
+		report("empty jobs, submitted from outside", injected, job_count_double, "job");
+		report("empty jobs, submitted from a worker", spawned, job_count_double, "job");
+	}
+
+	// Scaling: the same parallel_for over powers of two threads, and every hardware thread
+	std::vector<unsigned int> thread_counts {};
+	for (unsigned int thread_count {1}; thread_count < hardware_threads; thread_count *= 2)
+		thread_counts.push_back(thread_count);
+
+	thread_counts.push_back(hardware_threads);
+	const auto item_count = job_count * 16;
+	std::vector<std::uint64_t> values(item_count);
+	double single_thread {};
+	for (const auto thread_count : thread_counts) {
+		job_system jobs {thread_count - 1};
+		const auto elapsed = time_fastest(repeat_count, [&] {
+			jobs.parallel_for(item_count, thread_count * 8, [&](std::size_t first, std::size_t last, std::size_t) {
+				for (auto i = first; i < last; ++i)
+					values[i] = churn(i);
+			});
+		});
+
+		keep(values);
+		if (thread_count == 1)
+			single_thread = elapsed;
+
+		std::cout << thread_count << " threads: ";
+		report("parallel_for", elapsed, gsl::narrow_cast<double>(item_count), "item");
+		std::cout << "\tspeedup " << single_thread / elapsed << "x\n";
+	}
+}
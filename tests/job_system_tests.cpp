@@ -0,0 +1,218 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/job_system.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t deque_capacity {1024};
+		using test_deque = work_stealing_deque<int, deque_capacity>;
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(the_owner_pops_newest_first_and_thieves_steal_oldest_first)
+{
+	test_deque deque {};
+	std::array<int, 3> values {0, 1, 2};
+	CHECK(deque.empty());
+	for (auto& value : values)
+		CHECK(deque.push(&value));
+
+	CHECK(deque.steal() == &values[0]);
+	CHECK(deque.pop() == &values[2]);
+	CHECK(deque.pop() == &values[1]);
+	CHECK(deque.pop() == nullptr);
+	CHECK(deque.steal() == nullptr);
+	CHECK(deque.empty());
+}
+
+SANDBOX_TEST(a_full_deque_refuses_pushes)
+{
+	test_deque deque {};
+	int value {};
+	for (std::size_t i {}; i < deque_capacity; ++i)
+		CHECK(deque.push(&value));
+
+	CHECK(!deque.push(&value));
+	CHECK(deque.steal() == &value);
+	CHECK(deque.push(&value));
+}
+
+SANDBOX_TEST(popping_and_stealing_take_every_value_exactly_once)
+{
+	// The owner keeps pushing and popping while thieves steal; the last value in the deque is raced for constantly
+	constexpr int value_count {200'000};
+	constexpr int thief_count {3};
+	std::vector<int> values(value_count);
+	std::vector<std::atomic_int> taken(value_count);
+	test_deque deque {};
+	std::atomic_bool done {};
+
+	const auto take = [&](int* value) {
+		if (value)
+			taken[gsl::narrow_cast<std::size_t>(value - values.data())].fetch_add(1, std::memory_order_relaxed);
+	};
+
+	std::vector<std::jthread> thieves {};
+	for (int i {}; i < thief_count; ++i) {
+		thieves.emplace_back([&] {
+			while (!done.load(std::memory_order_acquire) || !deque.empty())
+				take(deque.steal());
+		});
+	}
+
+	for (int i {}; i < value_count; ++i) {
+		while (!deque.push(&values[i]))
+			take(deque.pop());
+
+		if (i % 3 == 0)
+			take(deque.pop());
+	}
+
+	while (!deque.empty())
+		take(deque.pop());
+
+	done.store(true, std::memory_order_release);
+	thieves.clear();
+	CHECK(std::ranges::all_of(taken, [](const std::atomic_int& count) { return count.load() == 1; }));
+}
+
+SANDBOX_TEST(waiting_without_workers_runs_every_job_on_the_waiting_thread)
+{
+	job_system jobs {0};
+	CHECK(jobs.thread_count() == 1);
+	job_counter counter {};
+	std::vector<std::thread::id> runners {};
+	for (int i {}; i < 10; ++i)
+		jobs.run(counter, [&runners] { runners.push_back(std::this_thread::get_id()); });
+
+	CHECK(!counter.is_done());
+	jobs.wait(counter);
+	CHECK(counter.is_done());
+	CHECK(runners.size() == 10);
+	CHECK(std::ranges::all_of(runners, [](std::thread::id id) { return id == std::this_thread::get_id(); }));
+}
+
+SANDBOX_TEST(jobs_that_wait_on_their_children_help_instead_of_deadlocking)
+{
+	// Every job waits on children of its own, to a depth well beyond the number of workers, so that progress
+	// depends on waiting workers running other jobs
+	job_system jobs {2};
+	std::atomic_int leaf_count {};
+	std::function<void(int)> spawn {};
+	spawn = [&](int depth) {
+		if (depth == 0) {
+			leaf_count.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		job_counter children {};
+		for (int i {}; i < 3; ++i)
+			jobs.run(children, [&spawn, depth] { spawn(depth - 1); });
+
+		jobs.wait(children);
+	};
+
+	job_counter root {};
+	jobs.run(root, [&spawn] { spawn(7); });
+	jobs.wait(root);
+	CHECK(leaf_count == 3 * 3 * 3 * 3 * 3 * 3 * 3);
+}
+
+SANDBOX_TEST(a_worker_with_a_full_deque_runs_jobs_inline)
+{
+	job_system jobs {1};
+	std::atomic_int run_count {};
+	job_counter root {};
+	jobs.run(root, [&] {
+		job_counter children {};
+		for (int i {}; i < 10'000; ++i)
+			jobs.run(children, [&run_count] { run_count.fetch_add(1, std::memory_order_relaxed); });
+
+		jobs.wait(children);
+	});
+
+	jobs.wait(root);
+	CHECK(run_count == 10'000);
+}
+
+SANDBOX_TEST(waiting_rethrows_the_first_exception_and_resets_the_counter)
+{
+	job_system jobs {2};
+	job_counter counter {};
+	std::atomic_int run_count {};
+	for (int i {}; i < 20; ++i) {
+		jobs.run(counter, [&run_count, i] {
+			run_count.fetch_add(1, std::memory_order_relaxed);
+			if (i % 5 == 0)
+				throw std::runtime_error {"job failed"};
+		});
+	}
+
+	CHECK_THROWS(jobs.wait(counter), std::runtime_error);
+	CHECK(run_count == 20);
+
+	// Once rethrown, the failure is cleared, so the counter can be reused
+	jobs.run(counter, [] {});
+	jobs.wait(counter);
+}
+
+SANDBOX_TEST(parallel_for_visits_every_index_exactly_once)
+{
+	job_system jobs {3};
+	for (std::size_t count : {0, 1, 2, 7, 64, 1000}) {
+		for (std::size_t slice_count : {1, 2, 3, 4, 16}) {
+			std::vector<std::atomic_int> visits(count);
+			std::vector<std::atomic_int> slice_visits(slice_count);
+			jobs.parallel_for(count, slice_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+				CHECK(first <= last);
+				CHECK(last <= count);
+				slice_visits.at(slice).fetch_add(1, std::memory_order_relaxed);
+				for (auto i = first; i < last; ++i)
+					visits[i].fetch_add(1, std::memory_order_relaxed);
+			});
+
+			CHECK(std::ranges::all_of(visits, [](const std::atomic_int& visit) { return visit.load() == 1; }));
+			CHECK(std::ranges::all_of(slice_visits, [](const std::atomic_int& visit) { return visit.load() == 1; }));
+		}
+	}
+}
+
+SANDBOX_TEST(parallel_for_slices_are_contiguous_and_ordered)
+{
+	job_system jobs {3};
+	constexpr std::size_t count {1001};
+	constexpr std::size_t slice_count {7};
+	std::array<std::pair<std::size_t, std::size_t>, slice_count> ranges {};
+	jobs.parallel_for(count, slice_count, [&](std::size_t first, std::size_t last, std::size_t slice) {
+		ranges.at(slice) = {first, last};
+	});
+
+	std::size_t next {};
+	for (const auto& [first, last] : ranges) {
+		CHECK(first == next);
+		next = last;
+	}
+
+	CHECK(next == count);
+}
+
+SANDBOX_TEST(parallel_for_finishes_every_slice_before_rethrowing)
+{
+	job_system jobs {2};
+	std::atomic_int finished {};
+	const auto run = [&] {
+		jobs.parallel_for(100, 10, [&](std::size_t, std::size_t, std::size_t slice) {
+			if (slice == 0)
+				throw std::runtime_error {"first slice failed"};
+
+			finished.fetch_add(1, std::memory_order_relaxed);
+		});
+	};
+
+	CHECK_THROWS(run(), std::runtime_error);
+	CHECK(finished == 9);
+}
@@ -0,0 +1,114 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/mapped_file.h"
+#include "../runtime/xxhash64.h"
+#include "benchmark_harness.h"
+
+#include <random>
+
+namespace sandbox {
+	namespace {
+		// The section reader as it was before mapping, as the baseline: each block goes through the stream's buffer and
+		// a bounce buffer, and is hashed there before being copied to the destination
+		constexpr std::size_t section_block_size {1 << 20};
+
+		GSL_SUPPRESS(type)
+		std::uint64_t read_iostream(const std::filesystem::path& path, gsl::span<std::byte> destination)
+		{
+			std::ifstream file {path, file.binary};
+			file.exceptions(file.failbit | file.badbit);
+			std::vector<std::byte> block(std::min(section_block_size, destination.size()));
+			xxhash64 hash {};
+			for (std::size_t offset {}; offset < destination.size(); offset += block.size()) {
+				const auto piece = gsl::span {block}.first(std::min(block.size(), destination.size() - offset));
+				file.read(reinterpret_cast<char*>(piece.data()), gsl::narrow<std::streamsize>(piece.size()));
+				hash.update(piece);
+				std::copy(piece.begin(), piece.end(), destination.subspan(offset).begin());
+			}
+
+			return hash.digest();
+		}
+
+		// As the geometry loader and uploader do it: the view is hashed in place, then copied once to the destination
+		std::uint64_t read_mapped(const std::filesystem::path& path, gsl::span<std::byte> destination)
+		{
+			const mapped_file file {path};
+			const auto content = file.content().first(destination.size());
+			xxhash64 hash {};
+			hash.update(content);
+			std::copy(content.begin(), content.end(), destination.begin());
+			return hash.digest();
+		}
+
+		GSL_SUPPRESS(type)
+		void write_random_file(const std::filesystem::path& path, std::size_t size)
+		{
+			std::ofstream file {path, file.binary};
+			file.exceptions(file.failbit | file.badbit);
+			std::vector<std::uint64_t> block(section_block_size / sizeof(std::uint64_t));
+			std::mt19937_64 engine {1};
+			for (std::size_t written {}; written < size; written += section_block_size) {
+				std::generate(block.begin(), block.end(), engine);
+				const auto piece = std::min(section_block_size, size - written);
+				file.write(reinterpret_cast<const char*>(block.data()), gsl::narrow<std::streamsize>(piece));
+			}
+		}
+
+		// Drops the file from the page cache, so that the next read comes from the device
+		void evict(const std::filesystem::path& path)
+		{
+			const auto file = open(path.c_str(), O_RDONLY);
+			fdatasync(file);
+			posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+			close(file);
+		}
+	}
+}
+
+// Usage: mapped_file_benchmark [file size in MiB (default 4096)] [directory (default the temporary directory)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto size = get_count_argument(argc, argv, 1, 4096) << 20;
+	const auto directory = argc > 2 ? std::filesystem::path {argv[2]} : std::filesystem::temp_directory_path();
+	const auto path = directory / "mapped_file_benchmark.bin";
+	write_random_file(path, size);
+	std::cout << size / 1e9 << " GB file\n";
+
+	// Touched once up front, so that page faults on the destination are not charged to the first reader
+	std::vector<std::byte> destination(size);
+	const auto size_count = gsl::narrow_cast<double>(size);
+	std::uint64_t iostream_digest {};
+	std::uint64_t mapped_digest {};
+	const auto run_all = [&](std::string_view cache, bool cold) {
+		constexpr std::size_t repeat_count {3};
+		const auto prepare = [&] {
+			if (cold)
+				evict(path);
+		};
+
+		const auto iostream = time_fastest(repeat_count, [&] {
+			prepare();
+			iostream_digest = read_iostream(path, destination);
+		});
+
+		const auto mapped = time_fastest(repeat_count, [&] {
+			prepare();
+			mapped_digest = read_mapped(path, destination);
+		});
+
+		std::cout << cache << ":\n";
+		report("\tstd::ifstream", iostream, size_count, "B");
+		report("\tmapped_file", mapped, size_count, "B");
+	};
+
+	run_all("page cache warm", false);
+	run_all("page cache cold", true);
+	std::filesystem::remove(path);
+	if (mapped_digest != iostream_digest) {
+		std::cout << "readers disagree\n";
+		return 1;
+	}
+}
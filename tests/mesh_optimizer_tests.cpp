@@ -0,0 +1,204 @@
+#include "../import/pch.h"
+
+#include "../import/mesh_optimizer.h"
+#include "test_harness.h"
+#include "test_meshes.h"
+
+#include <numeric>
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t grid_side {64};
+		constexpr std::size_t cache_size {32};
+
+		struct indexed_mesh {
+			std::vector<unsigned int> indices;
+			std::vector<vertex_data> vertices;
+		};
+
+		// Two identical grids facing -z, at z = 0 and z = 1, so that from -z the near one hides the far one completely
+		// and every other view sees them edge-on or from behind
+		indexed_mesh make_occluding_planes(bool near_first)
+		{
+			const auto near_vertices = make_grid_vertices(grid_side, 0.0f);
+			const auto far_vertices = make_grid_vertices(grid_side, 1.0f);
+			const auto& first = near_first ? near_vertices : far_vertices;
+			const auto& second = near_first ? far_vertices : near_vertices;
+
+			indexed_mesh mesh {.indices {make_grid_indices(grid_side)}, .vertices {first}};
+			const auto offset = static_cast<unsigned int>(mesh.vertices.size());
+			for (const auto index : make_grid_indices(grid_side))
+				mesh.indices.push_back(index + offset);
+
+			mesh.vertices.insert(mesh.vertices.end(), second.begin(), second.end());
+			return mesh;
+		}
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(vertex_cache_counts_every_first_use_as_a_miss)
+{
+	const std::vector<unsigned int> indices {0, 1, 2, 2, 1, 3};
+	const auto statistics = analyze_vertex_cache(indices, 4, cache_size);
+	CHECK(statistics.acmr == 2.0);
+	CHECK(statistics.atvr == 1.0);
+}
+
+SANDBOX_TEST(vertex_cache_misses_again_once_evicted)
+{
+	// With two entries, vertex 0 has been evicted by 1 and 2 by the time it is used again
+	const std::vector<unsigned int> indices {0, 1, 2, 0, 1, 2};
+	const auto statistics = analyze_vertex_cache(indices, 3, 2);
+	CHECK(statistics.acmr == 3.0);
+	CHECK(statistics.atvr == 2.0);
+}
+
+SANDBOX_TEST(vertex_cache_statistics_of_nothing_are_zero)
+{
+	const auto statistics = analyze_vertex_cache({}, 0, cache_size);
+	CHECK(statistics.acmr == 0.0);
+	CHECK(statistics.atvr == 0.0);
+}
+
+SANDBOX_TEST(vertex_cache_optimization_only_reorders_triangles)
+{
+	auto indices = make_grid_indices(grid_side);
+	shuffle_triangles(indices, 1);
+	const auto original = get_sorted_triangles(indices);
+	optimize_vertex_cache(indices, grid_side * grid_side);
+	CHECK(get_sorted_triangles(indices) == original);
+}
+
+SANDBOX_TEST(vertex_cache_optimization_recovers_locality)
+{
+	auto indices = make_grid_indices(grid_side);
+	shuffle_triangles(indices, 2);
+	const auto vertex_count = grid_side * grid_side;
+	const auto before = analyze_vertex_cache(indices, vertex_count, cache_size);
+	optimize_vertex_cache(indices, vertex_count);
+	const auto after = analyze_vertex_cache(indices, vertex_count, cache_size);
+
+	// A shuffled grid misses on nearly every corner; a well-ordered one approaches one vertex per two triangles
+	CHECK(before.acmr > 2.5);
+	CHECK(after.acmr < 0.8);
+	CHECK(after.atvr < 1.6);
+}
+
+SANDBOX_TEST(vertex_cache_optimization_is_deterministic)
+{
+	auto first = make_grid_indices(grid_side);
+	shuffle_triangles(first, 3);
+	auto second = first;
+	optimize_vertex_cache(first, grid_side * grid_side);
+	optimize_vertex_cache(second, grid_side * grid_side);
+	CHECK(first == second);
+}
+
+SANDBOX_TEST(vertex_cache_optimization_accepts_empty_meshes)
+{
+	std::vector<unsigned int> indices {};
+	optimize_vertex_cache(indices, 0);
+	CHECK(indices.empty());
+}
+
+SANDBOX_TEST(overdraw_is_one_when_the_occluder_is_drawn_first)
+{
+	const auto mesh = make_occluding_planes(true);
+	const auto statistics = analyze_overdraw(mesh.indices, mesh.vertices);
+	CHECK(statistics.overdraw == 1.0);
+}
+
+SANDBOX_TEST(overdraw_is_two_when_the_occludee_is_drawn_first)
+{
+	const auto mesh = make_occluding_planes(false);
+	const auto statistics = analyze_overdraw(mesh.indices, mesh.vertices);
+	CHECK(statistics.overdraw == 2.0);
+}
+
+SANDBOX_TEST(overdraw_culls_back_faces)
+{
+	// Seen from -z the far plane's reversed triangles are back faces, and from +z the near plane's are
+	auto mesh = make_occluding_planes(false);
+	for (std::size_t i {}; i < mesh.indices.size(); i += 3)
+		std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+
+	const auto statistics = analyze_overdraw(mesh.indices, mesh.vertices);
+	CHECK(statistics.overdraw == 1.0);
+}
+
+SANDBOX_TEST(overdraw_optimization_draws_the_occluder_first)
+{
+	auto mesh = make_occluding_planes(false);
+	const auto original = get_sorted_triangles(mesh.indices);
+	optimize_overdraw(mesh.indices, mesh.vertices, 1.05f);
+	CHECK(get_sorted_triangles(mesh.indices) == original);
+	CHECK(analyze_overdraw(mesh.indices, mesh.vertices).overdraw == 1.0);
+}
+
+SANDBOX_TEST(overdraw_optimization_accepts_empty_meshes)
+{
+	std::vector<unsigned int> indices {};
+	optimize_overdraw(indices, {}, 1.05f);
+	CHECK(indices.empty());
+	CHECK(analyze_overdraw({}, {}).overdraw == 0.0);
+}
+
+SANDBOX_TEST(vertex_fetch_counts_each_line_once_while_cached)
+{
+	// Vertices 0 and 1 share the first line, vertex 2 straddles the first two, and vertex 3 is in the second
+	const std::vector<unsigned int> indices {0, 1, 2, 3, 2, 1};
+	const auto statistics = analyze_vertex_fetch(indices, 4, 32, 4);
+	CHECK(statistics.bytes_per_triangle == 64.0);
+	CHECK(statistics.overfetch == 1.0);
+}
+
+SANDBOX_TEST(vertex_fetch_scales_with_the_vertex_stride)
+{
+	const auto indices = make_grid_indices(grid_side);
+	const auto vertex_count = grid_side * grid_side;
+	const auto full = analyze_vertex_fetch(indices, vertex_count, sizeof(vertex_data), 256);
+	const auto compact = analyze_vertex_fetch(indices, vertex_count, sizeof(compact_vertex_data), 256);
+	CHECK(compact.bytes_per_triangle < full.bytes_per_triangle);
+}
+
+SANDBOX_TEST(vertex_fetch_optimization_renumbers_in_order_of_use)
+{
+	auto indices = make_grid_indices(grid_side);
+	auto vertices = make_grid_vertices(grid_side);
+
+	// Scatter the vertex buffer, so that neighbouring triangles fetch from distant lines
+	std::vector<unsigned int> scatter(vertices.size());
+	std::iota(scatter.begin(), scatter.end(), 0u);
+	std::shuffle(scatter.begin(), scatter.end(), std::mt19937 {4});
+	std::vector<vertex_data> scattered(vertices.size());
+	for (std::size_t i {}; i < vertices.size(); ++i)
+		scattered[scatter[i]] = vertices[i];
+
+	for (auto& index : indices)
+		index = scatter[index];
+
+	const auto get_positions = [](const auto& indices, const auto& vertices) {
+		std::vector<std::array<float, 3>> positions {};
+		for (const auto index : indices) {
+			const auto& position = vertices[index].position;
+			positions.push_back({position.x, position.y, position.z});
+		}
+
+		return positions;
+	};
+
+	const auto original = get_positions(indices, scattered);
+	const auto before = analyze_vertex_fetch(indices, scattered.size(), sizeof(vertex_data), 256);
+	optimize_vertex_fetch(indices, scattered);
+	const auto after = analyze_vertex_fetch(indices, scattered.size(), sizeof(vertex_data), 256);
+	CHECK(get_positions(indices, scattered) == original);
+	CHECK(after.overfetch < before.overfetch);
+	CHECK(after.overfetch < 1.1);
+	for (std::size_t i {}, next {}; i < indices.size(); ++i) {
+		CHECK(indices[i] <= next);
+		next = std::max<std::size_t>(next, indices[i] + 1);
+	}
+}
@@ -0,0 +1,238 @@
+#include "../import/pch.h"
+
+#include "../import/meshlet_building.h"
+#include "test_harness.h"
+#include "test_meshes.h"
+
+namespace sandbox::testing {
+	namespace {
+		struct indexed_mesh {
+			std::vector<submesh> submeshes;
+			std::vector<std::uint16_t> indices;
+			std::vector<vector3> positions;
+		};
+
+		// One submesh per grid, each with its own run of vertices; shuffled grids have poor locality, and so force
+		// meshlets that are limited by their vertices rather than their triangles
+		indexed_mesh make_grids(std::initializer_list<std::size_t> sides, bool shuffle)
+		{
+			indexed_mesh mesh {};
+			for (const auto side : sides) {
+				auto grid_indices = make_grid_indices(side);
+				if (shuffle)
+					shuffle_triangles(grid_indices, gsl::narrow_cast<unsigned int>(side));
+
+				mesh.submeshes.push_back(
+					{.first_index {gsl::narrow<std::uint32_t>(mesh.indices.size())},
+					 .index_count {gsl::narrow<std::uint32_t>(grid_indices.size())},
+					 .base_vertex {gsl::narrow<std::int32_t>(mesh.positions.size())}});
+
+				for (const auto index : grid_indices)
+					mesh.indices.push_back(gsl::narrow<std::uint16_t>(index));
+
+				for (const auto& vertex : make_grid_vertices(side, gsl::narrow_cast<float>(mesh.submeshes.size())))
+					mesh.positions.push_back(vertex.position);
+			}
+
+			return mesh;
+		}
+
+		meshlet_mesh build(const indexed_mesh& mesh, const meshlet_limits& limits, unsigned int worker_count = 2)
+		{
+			job_system jobs {worker_count};
+			return build_meshlets(mesh.submeshes, mesh.indices, mesh.positions, limits, jobs);
+		}
+
+		// The submeshes' triangles as vertex indices, in order
+		std::vector<std::uint32_t> get_expected_corners(const indexed_mesh& mesh)
+		{
+			std::vector<std::uint32_t> corners {};
+			for (const auto& [first_index, index_count, base_vertex] : mesh.submeshes) {
+				for (std::size_t i {}; i < index_count; ++i)
+					corners.push_back(gsl::narrow<std::uint32_t>(base_vertex + mesh.indices.at(first_index + i)));
+			}
+
+			return corners;
+		}
+
+		// The meshlets' triangles decoded back to vertex indices, in order; any corner outside its meshlet's run of
+		// vertices is a failure
+		std::vector<std::uint32_t> get_meshlet_corners(const meshlet_mesh& built)
+		{
+			std::vector<std::uint32_t> corners {};
+			for (const auto& current : built.meshlets) {
+				for (std::size_t i {}; i < current.triangle_count; ++i) {
+					const auto triangle = built.triangles.at(current.first_triangle + i);
+					CHECK(triangle >> 24 == 0);
+					for (std::size_t corner {}; corner < 3; ++corner) {
+						const auto local_index = (triangle >> (corner * 8)) & 0xff;
+						CHECK(local_index < current.vertex_count);
+						corners.push_back(built.vertices.at(current.first_vertex + local_index));
+					}
+				}
+			}
+
+			return corners;
+		}
+
+		bool are_within(const meshlet_mesh& built, const meshlet_limits& limits)
+		{
+			return std::ranges::all_of(built.meshlets, [&limits](const meshlet& current) {
+				return current.vertex_count <= limits.max_vertices && current.triangle_count <= limits.max_triangles
+					&& current.triangle_count != 0;
+			});
+		}
+
+		// Every meshlet's runs of vertices and triangles follow on from the last one's, with nothing in between
+		bool are_contiguous(const meshlet_mesh& built)
+		{
+			std::uint32_t next_vertex {};
+			std::uint32_t next_triangle {};
+			for (const auto& current : built.meshlets) {
+				if (current.first_vertex != next_vertex || current.first_triangle != next_triangle)
+					return false;
+
+				next_vertex += current.vertex_count;
+				next_triangle += current.triangle_count;
+			}
+
+			return next_vertex == built.vertices.size() && next_triangle == built.triangles.size();
+		}
+
+		bool are_identical(const vector3& a, const vector3& b) noexcept
+		{
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+
+		bool are_identical(const meshlet& a, const meshlet& b) noexcept
+		{
+			return a.first_vertex == b.first_vertex && a.vertex_count == b.vertex_count
+				&& a.first_triangle == b.first_triangle && a.triangle_count == b.triangle_count
+				&& are_identical(a.center, b.center) && a.radius == b.radius && are_identical(a.cone_axis, b.cone_axis)
+				&& a.cone_cutoff == b.cone_cutoff;
+		}
+
+		float get_distance(const vector3& a, const vector3& b) noexcept
+		{
+			return std::hypot(a.x - b.x, a.y - b.y, a.z - b.z);
+		}
+
+		constexpr std::array<meshlet_limits, 4> limit_choices {{
+			default_meshlet_limits,
+			{.max_vertices {3}, .max_triangles {1}},
+			{.max_vertices {128}, .max_triangles {32}},
+			{.max_vertices {max_meshlet_size}, .max_triangles {max_meshlet_size}}}};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(meshlets_cover_every_triangle_once_in_order)
+{
+	for (const auto shuffle : {false, true}) {
+		const auto mesh = make_grids({2, 33, 150}, shuffle);
+		const auto expected = get_expected_corners(mesh);
+		for (const auto& limits : limit_choices) {
+			const auto built = build(mesh, limits);
+			CHECK(are_contiguous(built));
+			CHECK(get_meshlet_corners(built) == expected);
+		}
+	}
+}
+
+SANDBOX_TEST(meshlets_stay_within_their_limits)
+{
+	const auto mesh = make_grids({33, 150}, true);
+	for (const auto& limits : limit_choices) {
+		const auto built = build(mesh, limits);
+		CHECK(are_within(built, limits));
+
+		// Meshlets reuse vertices rather than duplicating them
+		for (const auto& current : built.meshlets) {
+			const auto vertices = gsl::span {built.vertices}.subspan(current.first_vertex, current.vertex_count);
+			std::vector<std::uint32_t> sorted(vertices.begin(), vertices.end());
+			std::ranges::sort(sorted);
+			CHECK(std::ranges::adjacent_find(sorted) == sorted.end());
+		}
+	}
+
+	// A single triangle per meshlet leaves none to share
+	const auto single = build(mesh, limit_choices[1]);
+	CHECK(single.meshlets.size() == get_expected_corners(mesh).size() / 3);
+}
+
+// Large enough for several runs of triangles per submesh, so that the slicing across threads varies
+SANDBOX_TEST(meshlets_are_the_same_for_any_thread_count)
+{
+	const auto mesh = make_grids({200, 20}, true);
+	const auto reference = build(mesh, default_meshlet_limits, 0);
+	for (const auto worker_count : {1u, 2u, 7u}) {
+		const auto built = build(mesh, default_meshlet_limits, worker_count);
+		CHECK(std::ranges::equal(built.meshlets, reference.meshlets, [](const meshlet& a, const meshlet& b) {
+			return are_identical(a, b);
+		}));
+		CHECK(built.vertices == reference.vertices);
+		CHECK(built.triangles == reference.triangles);
+	}
+}
+
+SANDBOX_TEST(spheres_bound_their_meshlets_vertices)
+{
+	const auto mesh = make_grids({33, 100}, true);
+	const auto built = build(mesh, default_meshlet_limits);
+	for (const auto& current : built.meshlets) {
+		for (std::size_t i {}; i < current.vertex_count; ++i) {
+			const auto& position = mesh.positions.at(built.vertices.at(current.first_vertex + i));
+			CHECK(get_distance(position, current.center) <= current.radius * (1.0f + 1e-6f));
+		}
+	}
+}
+
+// Every grid faces -z, so every meshlet's cone is a single direction
+SANDBOX_TEST(flat_meshlets_get_a_tight_cone_out_of_their_front_faces)
+{
+	const auto built = build(make_grids({33}, false), default_meshlet_limits);
+	for (const auto& current : built.meshlets) {
+		CHECK(std::abs(current.cone_axis.x) < 1e-6f);
+		CHECK(std::abs(current.cone_axis.y) < 1e-6f);
+		CHECK(std::abs(current.cone_axis.z + 1.0f) < 1e-6f);
+		CHECK(current.cone_cutoff < 1e-3f);
+	}
+}
+
+SANDBOX_TEST(meshlets_facing_both_ways_get_no_cone)
+{
+	// The second triangle is the first with its winding reversed
+	const indexed_mesh mesh {
+		.submeshes {{.first_index {}, .index_count {6}, .base_vertex {}}},
+		.indices {0, 1, 2, 0, 2, 1},
+		.positions {{0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}}};
+
+	const auto built = build(mesh, default_meshlet_limits);
+	CHECK(built.meshlets.size() == 1);
+	const auto& only = built.meshlets.front();
+	CHECK(only.cone_cutoff == 1.0f);
+	CHECK(are_identical(only.cone_axis, {}));
+}
+
+SANDBOX_TEST(out_of_range_limits_are_rejected)
+{
+	const auto mesh = make_grids({4}, false);
+	for (const auto& limits : std::initializer_list<meshlet_limits> {
+			 {.max_vertices {2}, .max_triangles {1}},
+			 {.max_vertices {3}, .max_triangles {0}},
+			 {.max_vertices {max_meshlet_size + 1}, .max_triangles {1}},
+			 {.max_vertices {3}, .max_triangles {max_meshlet_size + 1}}})
+		CHECK_THROWS(build(mesh, limits), std::invalid_argument);
+}
+
+SANDBOX_TEST(empty_submeshes_build_no_meshlets)
+{
+	const indexed_mesh mesh {
+		.submeshes {{.first_index {}, .index_count {}, .base_vertex {}}},
+		.indices {},
+		.positions {}};
+	const auto built = build(mesh, default_meshlet_limits);
+	CHECK(built.meshlets.empty() && built.vertices.empty() && built.triangles.empty());
+}
@@ -0,0 +1,190 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/job_system.h"
+#include "../runtime/parallel_recording.h"
+#include "test_harness.h"
+
+#include <random>
+
+namespace sandbox::testing {
+	namespace {
+		// Stands in for a part's command list: records what was drawn into it, and checks that it is used the way a
+		// D3D12 list must be, reset once before recording and closed once after
+		class mock_command_list {
+		public:
+			void reset()
+			{
+				CHECK(!m_is_open);
+				m_is_open = true;
+				++m_reset_count;
+				m_draws.clear();
+			}
+
+			void draw(std::size_t index)
+			{
+				CHECK(m_is_open);
+				m_draws.push_back(index);
+			}
+
+			void close()
+			{
+				CHECK(m_is_open);
+				m_is_open = false;
+			}
+
+			bool is_open() const noexcept { return m_is_open; }
+			int reset_count() const noexcept { return m_reset_count; }
+			const std::vector<std::size_t>& draws() const noexcept { return m_draws; }
+
+		private:
+			bool m_is_open {};
+			int m_reset_count {};
+			std::vector<std::size_t> m_draws {};
+		};
+
+		// Hands each part to its own mock list, as the engine hands each part to its own command list
+		class mock_sink {
+		public:
+			explicit mock_sink(std::vector<mock_command_list>& lists) noexcept : m_lists {lists} {}
+
+			void reset(std::size_t part) { m_lists.at(part).reset(); }
+
+			void record(std::size_t part, const draw_range& range)
+			{
+				const auto& [first, count] = range;
+				for (auto draw = first; draw < first + count; ++draw)
+					m_lists.at(part).draw(draw);
+			}
+
+			void close(std::size_t part) { m_lists.at(part).close(); }
+
+		private:
+			std::vector<mock_command_list>& m_lists;
+		};
+
+		// Records the draws across one list per part through record_parts(), as record_object_view_commands() does,
+		// and returns the draws in submission order
+		std::vector<std::size_t> record(
+			job_system& jobs,
+			gsl::span<const std::uint64_t> costs,
+			std::vector<mock_command_list>& lists)
+		{
+			mock_sink sink {lists};
+			record_parts(jobs, costs, lists.size(), sink);
+
+			std::vector<std::size_t> submitted {};
+			for (const auto& list : lists) {
+				CHECK(!list.is_open());
+				CHECK(list.reset_count() == 1);
+				submitted.insert(submitted.end(), list.draws().begin(), list.draws().end());
+			}
+
+			return submitted;
+		}
+
+		std::vector<std::size_t> get_sequence(std::size_t count)
+		{
+			std::vector<std::size_t> sequence(count);
+			std::iota(sequence.begin(), sequence.end(), std::size_t {});
+			return sequence;
+		}
+
+		// Contiguous, in order, and covering every draw exactly once
+		void check_covers(gsl::span<const draw_range> parts, std::size_t draw_count)
+		{
+			std::size_t next {};
+			for (const auto& [first, count] : parts) {
+				CHECK(first == next);
+				next = first + count;
+			}
+
+			CHECK(next == draw_count);
+		}
+
+		constexpr std::size_t part_count {4};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(no_draws_leave_every_list_empty)
+{
+	job_system jobs {part_count - 1};
+	std::vector<mock_command_list> lists(part_count);
+	CHECK(record(jobs, {}, lists).empty());
+	check_covers(partition_draws({}, part_count), 0);
+}
+
+SANDBOX_TEST(a_single_draw_lands_in_exactly_one_list)
+{
+	job_system jobs {part_count - 1};
+	std::vector<mock_command_list> lists(part_count);
+	const std::array<std::uint64_t, 1> costs {100};
+	CHECK(record(jobs, costs, lists) == get_sequence(1));
+	CHECK(std::ranges::count_if(lists, [](const auto& list) { return !list.draws().empty(); }) == 1);
+}
+
+SANDBOX_TEST(fewer_draws_than_threads_are_all_recorded_once)
+{
+	job_system jobs {part_count - 1};
+	std::vector<mock_command_list> lists(part_count);
+	const std::array<std::uint64_t, 3> costs {5, 1, 9};
+	CHECK(record(jobs, costs, lists) == get_sequence(costs.size()));
+
+	// Some parts are left empty, but their lists are still reset and closed, so they can be submitted as they are
+	const auto parts = partition_draws(costs, part_count);
+	check_covers(parts, costs.size());
+	CHECK(std::ranges::count_if(parts, [](const draw_range& part) { return part.count == 0; }) >= 1);
+}
+
+SANDBOX_TEST(uneven_draw_counts_are_split_in_order)
+{
+	job_system jobs {part_count - 1};
+	for (std::size_t draw_count : {5, 7, 13, 101}) {
+		std::vector<std::uint64_t> costs(draw_count, 10);
+		std::vector<mock_command_list> lists(part_count);
+		CHECK(record(jobs, costs, lists) == get_sequence(draw_count));
+
+		// Equal costs split into counts that differ by at most one
+		const auto parts = partition_draws(costs, part_count);
+		check_covers(parts, draw_count);
+		const auto [smallest, largest] = std::ranges::minmax_element(parts, {}, &draw_range::count);
+		CHECK(largest->count - smallest->count <= 1);
+	}
+}
+
+SANDBOX_TEST(uneven_costs_are_balanced_to_within_one_draw)
+{
+	std::mt19937 engine {5};
+	std::uniform_int_distribution<std::uint64_t> cost {1, 1000};
+	std::vector<std::uint64_t> costs(500);
+	std::ranges::generate(costs, [&] { return cost(engine); });
+	costs[17] = 50'000;
+
+	const auto parts = partition_draws(costs, part_count);
+	check_covers(parts, costs.size());
+	const auto total = std::accumulate(costs.begin(), costs.end(), std::uint64_t {});
+	const auto largest_cost = *std::ranges::max_element(costs);
+	for (const auto& [first, count] : parts) {
+		const auto part_costs = gsl::span {costs}.subspan(first, count);
+		const auto part_cost = std::accumulate(part_costs.begin(), part_costs.end(), std::uint64_t {});
+		CHECK(part_cost <= total / part_count + largest_cost);
+	}
+}
+
+SANDBOX_TEST(recording_is_deterministic_across_thread_counts)
+{
+	std::vector<std::uint64_t> costs(64);
+	std::iota(costs.begin(), costs.end(), std::uint64_t {1});
+	const auto expected = partition_draws(costs, part_count);
+	for (unsigned int worker_count {0}; worker_count < 6; ++worker_count) {
+		job_system jobs {worker_count};
+		std::vector<mock_command_list> lists(part_count);
+		CHECK(record(jobs, costs, lists) == get_sequence(costs.size()));
+		for (std::size_t part {}; part < part_count; ++part) {
+			CHECK(lists[part].draws().size() == expected[part].count);
+			CHECK(lists[part].draws().empty() || lists[part].draws().front() == expected[part].first);
+		}
+	}
+}
@@ -0,0 +1,199 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/simulation_clock.h"
+#include "test_harness.h"
+
+#include <random>
+
+namespace sandbox::testing {
+	namespace {
+		using namespace std::chrono_literals;
+
+		// What the client's camera does, reduced to integers so that states compare exactly (the camera itself needs
+		// DirectXMath): each tick moves one unit along each axis whose key is held
+		struct simulation_state {
+			std::int64_t x;
+			std::int64_t z;
+			std::uint64_t tick_count;
+			std::uint64_t dropped_tick_count;
+			float interpolation;
+
+			bool operator==(const simulation_state&) const = default;
+		};
+
+		void simulate_tick(simulation_state& state, const key_state& keys) noexcept
+		{
+			state.x += (keys.test('D') ? 1 : 0) - (keys.test('A') ? 1 : 0);
+			state.z += (keys.test('W') ? 1 : 0) - (keys.test('S') ? 1 : 0);
+		}
+
+		// One frame of a recorded session: the input handled at its start, whether focus was lost meanwhile, and the
+		// real time it advances by
+		struct trace_frame {
+			std::vector<key_event> events;
+			std::chrono::nanoseconds elapsed;
+			bool focus_lost;
+		};
+
+		// Replays a trace through the client's own per-frame step
+		simulation_state replay(gsl::span<const trace_frame> trace)
+		{
+			simulation_clock clock {simulation_tick_duration, max_simulation_ticks_per_frame};
+			simulation_state state {};
+			key_state keys {};
+			for (const auto& [events, elapsed, focus_lost] : trace) {
+				auto next = events.begin();
+				step_simulation(
+					clock,
+					keys,
+					elapsed,
+					[&]() -> std::optional<key_event> {
+						if (next == events.end())
+							return {};
+
+						return *next++;
+					},
+					[focus_lost] { return focus_lost; },
+					[&state](const key_state& held) { simulate_tick(state, held); });
+			}
+
+			state.tick_count = clock.tick_count();
+			state.dropped_tick_count = clock.dropped_tick_count();
+			state.interpolation = clock.interpolation();
+			return state;
+		}
+
+		// A jittery session with overlapping key presses and one long stall
+		std::vector<trace_frame> make_trace()
+		{
+			std::mt19937 engine {3};
+			std::uniform_int_distribution<std::int64_t> frame_time {4'000'000, 30'000'000};
+			std::uniform_int_distribution<int> key_choice {0, 3};
+			std::bernoulli_distribution has_event {0.2};
+			constexpr std::array<std::size_t, 4> keys {'W', 'A', 'S', 'D'};
+
+			std::vector<trace_frame> trace {};
+			for (int i {}; i < 2000; ++i) {
+				trace_frame frame {.events {}, .elapsed {std::chrono::nanoseconds {frame_time(engine)}}, .focus_lost {}};
+				if (has_event(engine))
+					frame.events.push_back({keys.at(key_choice(engine)), has_event(engine) || i % 2 == 0});
+
+				if (i == 1000)
+					frame.elapsed = 500ms;
+
+				trace.push_back(std::move(frame));
+			}
+
+			return trace;
+		}
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(a_recorded_trace_replays_to_the_same_state)
+{
+	const auto trace = make_trace();
+	const auto first = replay(trace);
+	const auto second = replay(trace);
+	CHECK(first == second);
+	CHECK(first.tick_count > 0);
+	CHECK(first.dropped_tick_count > 0);
+	CHECK(first.x != 0 || first.z != 0);
+}
+
+SANDBOX_TEST(a_known_trace_replays_to_the_expected_state)
+{
+	// Two seconds in 10 ms frames: W is pressed at the start, D after one second, and W is let go after one and a half
+	std::vector<trace_frame> trace(200, trace_frame {.events {}, .elapsed {10ms}, .focus_lost {}});
+	trace[0].events = {{'W', true}};
+	trace[100].events = {{'D', true}};
+	trace[150].events = {{'W', false}};
+
+	const auto state = replay(trace);
+	CHECK(state.tick_count == 120);
+	CHECK(state.dropped_tick_count == 0);
+
+	// Ticks fall due at multiples of 1/60 s, and each frame's input is applied before its ticks run: W is held for
+	// ticks due in frames 0 to 149 (the first 90), D for those in frames 100 to 199 (the last 60)
+	CHECK(state.z == 90);
+	CHECK(state.x == 60);
+
+	// A tick is a whole number of nanoseconds just short of 1/60 s, so two seconds leave a sliver over
+	CHECK(state.interpolation < 1e-5f);
+}
+
+SANDBOX_TEST(losing_focus_releases_held_keys)
+{
+	// One second in 10 ms frames: W is pressed at the start and focus is lost halfway, with no release ever queued
+	std::vector<trace_frame> trace(100, trace_frame {.events {}, .elapsed {10ms}, .focus_lost {}});
+	trace[0].events = {{'W', true}};
+	trace[50].focus_lost = true;
+
+	// A press queued in the same frame as the focus loss does not survive it either
+	trace[50].events = {{'D', true}};
+
+	const auto state = replay(trace);
+	CHECK(state.z == 30);
+	CHECK(state.x == 0);
+}
+
+SANDBOX_TEST(out_of_range_key_codes_are_ignored)
+{
+	std::vector<trace_frame> trace(10, trace_frame {.events {}, .elapsed {simulation_tick_duration}, .focus_lost {}});
+	trace[0].events = {{key_state {}.size(), true}, {'W', true}};
+	const auto state = replay(trace);
+	CHECK(state.z == 10);
+}
+
+SANDBOX_TEST(the_tick_count_depends_only_on_total_time)
+{
+	// The same two seconds with W held throughout, in steady, uneven and single-tick frames
+	const auto run = [](std::vector<std::chrono::nanoseconds> frame_times) {
+		std::vector<trace_frame> trace {};
+		for (const auto elapsed : frame_times)
+			trace.push_back({.events {}, .elapsed {elapsed}, .focus_lost {}});
+
+		trace.front().events = {{'W', true}};
+		return replay(trace);
+	};
+
+	const std::vector<std::chrono::nanoseconds> steady(120, simulation_tick_duration);
+	std::vector<std::chrono::nanoseconds> uneven {};
+	for (std::chrono::nanoseconds total {}; total < 2s;) {
+		const auto elapsed = std::min<std::chrono::nanoseconds>(uneven.size() % 3 == 0 ? 31ms : 7ms, 2s - total);
+		uneven.push_back(elapsed);
+		total += elapsed;
+	}
+
+	const std::vector<std::chrono::nanoseconds> stepped(2000, 1ms);
+	const auto expected = run(steady);
+	CHECK(expected.tick_count == 120);
+	CHECK(expected.z == 120);
+	for (const auto& frame_times : {uneven, stepped}) {
+		const auto state = run(frame_times);
+		CHECK(state.tick_count == expected.tick_count);
+		CHECK(state.z == expected.z);
+	}
+}
+
+SANDBOX_TEST(ticks_beyond_the_limit_are_dropped)
+{
+	simulation_clock clock {simulation_tick_duration, max_simulation_ticks_per_frame};
+	CHECK(clock.advance(simulation_tick_duration * 20) == max_simulation_ticks_per_frame);
+	CHECK(clock.tick_count() == max_simulation_ticks_per_frame);
+	CHECK(clock.dropped_tick_count() == 20 - max_simulation_ticks_per_frame);
+	CHECK(clock.advance(simulation_tick_duration) == 1);
+}
+
+SANDBOX_TEST(interpolation_is_the_fraction_of_a_tick_carried_forward)
+{
+	simulation_clock clock {10ms, max_simulation_ticks_per_frame};
+	CHECK(clock.advance(25ms) == 2);
+	CHECK(std::abs(clock.interpolation() - 0.5f) < 1e-6f);
+	CHECK(clock.advance(4ms) == 0);
+	CHECK(std::abs(clock.interpolation() - 0.9f) < 1e-6f);
+	CHECK(clock.advance(1ms) == 1);
+	CHECK(clock.interpolation() == 0.0f);
+}
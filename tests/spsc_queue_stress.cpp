@@ -0,0 +1,138 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/spsc_queue.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		// Several words, so that a value read while it is still being written shows up as a mismatch
+		struct event {
+			std::uint64_t sequence;
+			std::uint64_t tripled;
+			std::uint64_t inverted;
+		};
+
+		event make_event(std::uint64_t sequence) noexcept { return {sequence, sequence * 3, ~sequence}; }
+
+		bool is_intact(const event& value) noexcept
+		{
+			return value.tripled == value.sequence * 3 && value.inverted == ~value.sequence;
+		}
+
+		constexpr std::uint64_t stress_event_count {2'000'000};
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(an_empty_queue_pops_nothing)
+{
+	spsc_queue<int, 4> queue {};
+	CHECK(!queue.try_pop());
+}
+
+SANDBOX_TEST(a_full_queue_refuses_pushes_until_popped)
+{
+	spsc_queue<int, 4> queue {};
+	for (int i {}; i < 4; ++i)
+		CHECK(queue.try_push(i));
+
+	CHECK(!queue.try_push(4));
+	CHECK(queue.try_pop() == 0);
+	CHECK(queue.try_push(4));
+	for (int i {1}; i <= 4; ++i)
+		CHECK(queue.try_pop() == i);
+
+	CHECK(!queue.try_pop());
+}
+
+SANDBOX_TEST(values_survive_many_wraparounds)
+{
+	// Five at a time through eight slots, so that each batch starts at a different place in the ring
+	spsc_queue<int, 8> queue {};
+	int next_pushed {};
+	int next_popped {};
+	for (int batch {}; batch < 200; ++batch) {
+		for (int i {}; i < 5; ++i)
+			CHECK(queue.try_push(next_pushed++));
+
+		for (int i {}; i < 5; ++i)
+			CHECK(queue.try_pop() == next_popped++);
+	}
+
+	CHECK(!queue.try_pop());
+}
+
+SANDBOX_TEST(a_blocking_producer_delivers_every_event_in_order)
+{
+	spsc_queue<event, 256> queue {};
+	std::jthread producer {[&queue] {
+		for (std::uint64_t i {}; i < stress_event_count; ++i) {
+			while (!queue.try_push(make_event(i)))
+				std::this_thread::yield();
+		}
+	}};
+
+	std::uint64_t expected {};
+	auto intact = true;
+	auto ordered = true;
+	while (expected < stress_event_count) {
+		if (const auto value = queue.try_pop()) {
+			intact = intact && is_intact(*value);
+			ordered = ordered && value->sequence == expected;
+			++expected;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	CHECK(intact);
+	CHECK(ordered);
+	CHECK(!queue.try_pop());
+}
+
+SANDBOX_TEST(a_lossy_producer_accounts_for_every_event)
+{
+	// As the window procedure does: events that find the ring full are dropped and counted
+	spsc_queue<event, 64> queue {};
+	std::atomic_bool done {};
+	std::uint64_t accepted {};
+	std::uint64_t dropped {};
+	std::jthread producer {[&] {
+		for (std::uint64_t i {}; i < stress_event_count; ++i) {
+			if (queue.try_push(make_event(i)))
+				++accepted;
+			else
+				++dropped;
+		}
+
+		done.store(true, std::memory_order_release);
+	}};
+
+	std::uint64_t received {};
+	std::uint64_t last_sequence {};
+	auto intact = true;
+	auto ordered = true;
+	while (true) {
+		const auto finished = done.load(std::memory_order_acquire);
+		while (const auto value = queue.try_pop()) {
+			intact = intact && is_intact(*value);
+			ordered = ordered && (received == 0 || value->sequence > last_sequence);
+			last_sequence = value->sequence;
+			++received;
+		}
+
+		if (finished)
+			break;
+
+		std::this_thread::yield();
+	}
+
+	producer.join();
+	CHECK(intact);
+	CHECK(ordered);
+	CHECK(accepted + dropped == stress_event_count);
+	CHECK(received == accepted);
+}
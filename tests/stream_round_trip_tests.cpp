@@ -0,0 +1,189 @@
+#include "../runtime/pch.h"
+
+#include "../import/stream_writer.h"
+#include "../import/vertex_compression.h"
+#include "../runtime/stream_validation.h"
+#include "../runtime/xxhash64.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t sphere_side {48};
+
+		// A UV sphere of radius 3 around (1, -2, 5), with texture coordinates running past one so that the half
+		// precision's range is exercised as well as its rounding
+		std::vector<vertex_data> make_sphere_vertices()
+		{
+			constexpr auto pi = 3.14159265f;
+			std::vector<vertex_data> vertices {};
+			for (std::size_t y {}; y < sphere_side; ++y) {
+				for (std::size_t x {}; x < sphere_side; ++x) {
+					const auto u = static_cast<float>(x) / (sphere_side - 1);
+					const auto v = static_cast<float>(y) / (sphere_side - 1);
+					const auto theta = u * 2.0f * pi;
+					const auto phi = v * pi;
+					const vector3 normal {
+						std::sin(phi) * std::cos(theta),
+						std::cos(phi),
+						std::sin(phi) * std::sin(theta)};
+
+					vertices.push_back(
+						{.position {1.0f + 3.0f * normal.x, -2.0f + 3.0f * normal.y, 5.0f + 3.0f * normal.z},
+						 .texture_coord {u * 4.0f, v * 2.0f, 0.0f},
+						 .normal {normal}});
+				}
+			}
+
+			return vertices;
+		}
+
+		std::vector<std::byte> read_file(const std::filesystem::path& path)
+		{
+			std::ifstream infile {path, infile.binary};
+			infile.exceptions(infile.failbit | infile.badbit);
+			std::vector<std::byte> contents(std::filesystem::file_size(path));
+			infile.read(reinterpret_cast<char*>(contents.data()), gsl::narrow<std::streamsize>(contents.size()));
+			return contents;
+		}
+
+		// Checks the section's checksum and copies out its elements
+		template <typename type>
+		std::vector<type> read_section(gsl::span<const std::byte> contents, const stream_section& section)
+		{
+			const auto bytes = contents.subspan(gsl::narrow<std::size_t>(section.offset), get_section_size(section));
+			xxhash64 hash {};
+			hash.update(bytes);
+			CHECK(hash.digest() == section.checksum);
+
+			std::vector<type> elements(bytes.size() / sizeof(type));
+			std::memcpy(elements.data(), bytes.data(), elements.size() * sizeof(type));
+			return elements;
+		}
+
+		struct read_stream {
+			stream_layout layout;
+			std::vector<submesh> submeshes;
+			std::vector<std::uint16_t> indices;
+			std::vector<std::byte> vertices;
+		};
+
+		// Writes the sections out and reads them back the way the runtime does
+		read_stream round_trip(const position_bounds& bounds, gsl::span<const section_source> sources)
+		{
+			const auto path = std::filesystem::temp_directory_path() / "sandbox_stream_round_trip.bin";
+			write_streams(path.string().c_str(), bounds, sources);
+			const auto contents = read_file(path);
+			std::filesystem::remove(path);
+
+			stream_header header {};
+			std::memcpy(&header, contents.data(), sizeof(header));
+			validate_stream_header(header, contents.size());
+
+			std::vector<stream_section> sections(header.section_count);
+			std::memcpy(sections.data(), &contents.at(sizeof(header)), sections.size() * sizeof(stream_section));
+
+			read_stream stream {.layout {locate_sections(header, sections)}};
+			stream.submeshes = read_section<submesh>(contents, stream.layout.submeshes);
+			validate_submeshes(stream.submeshes, stream.layout);
+			stream.indices = read_section<std::uint16_t>(contents, stream.layout.indices);
+			stream.vertices = read_section<std::byte>(contents, stream.layout.vertices);
+			return stream;
+		}
+
+		std::vector<std::uint16_t> make_indices(std::size_t vertex_count)
+		{
+			const auto index = [](std::size_t i) { return gsl::narrow<std::uint16_t>(i); };
+			std::vector<std::uint16_t> indices {};
+			for (std::size_t i {}; i + 2 < vertex_count; ++i)
+				indices.insert(indices.end(), {index(i), index(i + 1), index(i + 2)});
+
+			return indices;
+		}
+
+		float get_angle_degrees(const vector3& a, const vector3& b)
+		{
+			const auto cosine = (a.x * b.x + a.y * b.y + a.z * b.z)
+				/ std::sqrt((a.x * a.x + a.y * a.y + a.z * a.z) * (b.x * b.x + b.y * b.y + b.z * b.z));
+
+			return std::acos(std::min(cosine, 1.0f)) * 57.2957795f;
+		}
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(compact_vertices_survive_a_round_trip_through_a_stream)
+{
+	const auto originals = make_sphere_vertices();
+	const auto compressed = compress_vertices(originals);
+	const auto indices = make_indices(originals.size());
+	const std::array submeshes {
+		submesh {.first_index {0}, .index_count {gsl::narrow<std::uint32_t>(indices.size())}, .base_vertex {0}}};
+
+	const std::array<section_source, 3> sources {
+		{{section_type::submeshes, 0, sizeof(submesh), gsl::as_bytes(gsl::span {submeshes})},
+		 {section_type::indices,
+		  static_cast<std::uint32_t>(index_format::uint16),
+		  sizeof(std::uint16_t),
+		  gsl::as_bytes(gsl::span {indices})},
+		 {section_type::vertices,
+		  static_cast<std::uint32_t>(vertex_format::compact),
+		  sizeof(compact_vertex_data),
+		  gsl::as_bytes(gsl::span {compressed.vertices})}}};
+
+	const auto stream = round_trip(compressed.bounds, sources);
+	CHECK(vertex_format {stream.layout.vertices.format} == vertex_format::compact);
+	CHECK(stream.indices == indices);
+	CHECK(stream.submeshes.size() == 1);
+	CHECK(stream.vertices.size() == originals.size() * sizeof(compact_vertex_data));
+
+	// Positions are within a quantization step of the 6-unit extent, texture coordinates within a half-precision ulp of
+	// values below 4, and normals within the octahedral encoding's error
+	const auto position_tolerance = 6.0f / 65535.0f;
+	const auto texture_tolerance = 1.0f / 512.0f;
+	const auto normal_tolerance = 0.05f;
+	const auto& bounds = stream.layout.bounds;
+	for (std::size_t i {}; i < originals.size(); ++i) {
+		compact_vertex_data compact {};
+		std::memcpy(&compact, &stream.vertices[i * sizeof(compact)], sizeof(compact));
+		const auto decoded = decompress_vertex(compact, bounds);
+		const auto& original = originals[i];
+		CHECK(std::abs(decoded.position.x - original.position.x) <= position_tolerance);
+		CHECK(std::abs(decoded.position.y - original.position.y) <= position_tolerance);
+		CHECK(std::abs(decoded.position.z - original.position.z) <= position_tolerance);
+		CHECK(std::abs(decoded.texture_coord.x - original.texture_coord.x) <= texture_tolerance);
+		CHECK(std::abs(decoded.texture_coord.y - original.texture_coord.y) <= texture_tolerance);
+		CHECK(get_angle_degrees(decoded.normal, original.normal) <= normal_tolerance);
+	}
+
+	const auto error = measure_compression_error(originals, compressed);
+	CHECK(error.position <= position_tolerance);
+	CHECK(error.texture_coord <= texture_tolerance);
+	CHECK(error.normal <= normal_tolerance);
+}
+
+SANDBOX_TEST(full_vertices_survive_a_round_trip_through_a_stream_unchanged)
+{
+	const auto originals = make_sphere_vertices();
+	const auto indices = make_indices(originals.size());
+	const std::array submeshes {
+		submesh {.first_index {0}, .index_count {gsl::narrow<std::uint32_t>(indices.size())}, .base_vertex {0}}};
+
+	const std::array<section_source, 3> sources {
+		{{section_type::submeshes, 0, sizeof(submesh), gsl::as_bytes(gsl::span {submeshes})},
+		 {section_type::indices,
+		  static_cast<std::uint32_t>(index_format::uint16),
+		  sizeof(std::uint16_t),
+		  gsl::as_bytes(gsl::span {indices})},
+		 {section_type::vertices,
+		  static_cast<std::uint32_t>(vertex_format::full),
+		  sizeof(vertex_data),
+		  gsl::as_bytes(gsl::span {originals})}}};
+
+	const auto stream = round_trip({}, sources);
+	CHECK(vertex_format {stream.layout.vertices.format} == vertex_format::full);
+	CHECK(stream.indices == indices);
+	const auto original_bytes = gsl::as_bytes(gsl::span {originals});
+	CHECK(std::equal(stream.vertices.begin(), stream.vertices.end(), original_bytes.begin(), original_bytes.end()));
+}
@@ -0,0 +1,122 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/stream_validation.h"
+#include "test_harness.h"
+
+namespace sandbox::testing {
+	namespace {
+		// Ten vertices and twelve 16-bit indices, without any of the sections' contents
+		stream_layout make_layout(index_format format = index_format::uint16)
+		{
+			const auto index_size = format == index_format::uint16 ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+			return {
+				.bounds {},
+				.submeshes {.type {section_type::submeshes}, .element_count {1}, .element_size {sizeof(submesh)}},
+				.indices {
+					.type {section_type::indices},
+					.format {static_cast<std::uint32_t>(format)},
+					.element_count {12},
+					.element_size {index_size}},
+				.vertices {
+					.type {section_type::vertices},
+					.format {static_cast<std::uint32_t>(vertex_format::full)},
+					.element_count {10},
+					.element_size {sizeof(vertex_data)}}};
+		}
+
+		// A header for a file holding nothing but the header itself
+		stream_header make_header(std::uint32_t version)
+		{
+			return {
+				.magic {stream_magic},
+				.version {version},
+				.section_count {},
+				.file_size {sizeof(stream_header)},
+				.bounds {}};
+		}
+
+		template <typename index_type>
+		std::vector<std::byte> make_indices(std::initializer_list<index_type> indices)
+		{
+			const auto bytes = gsl::as_bytes(gsl::span {indices.begin(), indices.size()});
+			return {bytes.begin(), bytes.end()};
+		}
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(submeshes_within_their_sections_are_accepted)
+{
+	const auto layout = make_layout();
+	const std::array submeshes {
+		submesh {.first_index {0}, .index_count {6}, .base_vertex {0}},
+		submesh {.first_index {6}, .index_count {6}, .base_vertex {4}}};
+
+	const auto indices = make_indices<std::uint16_t>({0, 1, 2, 2, 1, 3, 0, 1, 2, 2, 1, 5});
+	validate_submeshes(submeshes, layout);
+	validate_submesh_indices(submeshes, indices, layout);
+}
+
+SANDBOX_TEST(submeshes_past_the_index_section_are_rejected)
+{
+	const std::array submeshes {submesh {.first_index {8}, .index_count {6}, .base_vertex {0}}};
+	CHECK_THROWS(validate_submeshes(submeshes, make_layout()), stream_error);
+}
+
+SANDBOX_TEST(submeshes_with_a_base_vertex_out_of_range_are_rejected)
+{
+	const std::array negative {submesh {.first_index {0}, .index_count {3}, .base_vertex {-1}}};
+	const std::array past_the_end {submesh {.first_index {0}, .index_count {3}, .base_vertex {10}}};
+	CHECK_THROWS(validate_submeshes(negative, make_layout()), stream_error);
+	CHECK_THROWS(validate_submeshes(past_the_end, make_layout()), stream_error);
+}
+
+SANDBOX_TEST(submesh_indices_past_the_vertex_section_are_rejected)
+{
+	// The base vertex alone is in range, but vertex 8 + 2 is not
+	const auto layout = make_layout();
+	const std::array submeshes {submesh {.first_index {6}, .index_count {6}, .base_vertex {8}}};
+	const auto indices = make_indices<std::uint16_t>({0, 1, 2, 2, 1, 3, 0, 1, 0, 1, 0, 2});
+	validate_submeshes(submeshes, layout);
+	CHECK_THROWS(validate_submesh_indices(submeshes, indices, layout), stream_error);
+}
+
+SANDBOX_TEST(submesh_indices_reaching_the_last_vertex_are_accepted)
+{
+	const auto layout = make_layout();
+	const std::array submeshes {submesh {.first_index {0}, .index_count {3}, .base_vertex {7}}};
+	const auto indices = make_indices<std::uint16_t>({0, 1, 2, 0, 0, 0, 0, 0, 0, 9, 9, 9});
+	validate_submesh_indices(submeshes, indices, layout);
+}
+
+SANDBOX_TEST(submesh_indices_are_read_at_their_format_width)
+{
+	const auto layout = make_layout(index_format::uint32);
+	const std::array submeshes {submesh {.first_index {9}, .index_count {3}, .base_vertex {0}}};
+	auto indices = make_indices<std::uint32_t>({0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2});
+	validate_submesh_indices(submeshes, indices, layout);
+
+	indices = make_indices<std::uint32_t>({0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 0x10000});
+	CHECK_THROWS(validate_submesh_indices(submeshes, indices, layout), stream_error);
+}
+
+SANDBOX_TEST(truncated_index_sections_are_rejected)
+{
+	const std::array submeshes {submesh {.first_index {0}, .index_count {3}, .base_vertex {0}}};
+	const auto indices = make_indices<std::uint16_t>({0, 1, 2});
+	CHECK_THROWS(validate_submesh_indices(submeshes, indices, make_layout()), stream_error);
+}
+
+SANDBOX_TEST(every_supported_stream_version_is_accepted)
+{
+	for (auto version = oldest_stream_version; version <= stream_version; ++version)
+		validate_stream_header(make_header(version), sizeof(stream_header));
+}
+
+SANDBOX_TEST(unknown_stream_versions_are_rejected)
+{
+	CHECK_THROWS(validate_stream_header(make_header(oldest_stream_version - 1), sizeof(stream_header)), stream_error);
+	CHECK_THROWS(validate_stream_header(make_header(stream_version + 1), sizeof(stream_header)), stream_error);
+}
@@ -0,0 +1,93 @@
+#include "../import/pch.h"
+
+#include "../import/submesh_splitting.h"
+#include "test_harness.h"
+#include "test_meshes.h"
+
+#include <cstring>
+#include <unordered_set>
+
+namespace sandbox::testing {
+	namespace {
+		// 90,000 vertices, so that the mesh has to be split
+		constexpr std::size_t large_grid_side {300};
+
+		bool bitwise_equal(const vertex_data& a, const vertex_data& b)
+		{
+			return std::memcmp(&a, &b, sizeof(vertex_data)) == 0;
+		}
+
+		// Rebuilds every triangle from the split mesh the way the runtime draws it, and compares it with the input
+		void check_triangles_preserved(
+			const std::vector<unsigned int>& indices,
+			const std::vector<vertex_data>& vertices,
+			const split_mesh& mesh)
+		{
+			std::size_t input_index {};
+			std::size_t mismatches {};
+			for (const auto& [first_index, index_count, base_vertex] : mesh.submeshes) {
+				CHECK(first_index == input_index);
+				for (std::size_t i {}; i < index_count; ++i, ++input_index) {
+					const auto vertex = gsl::narrow<std::size_t>(base_vertex + mesh.indices.at(first_index + i));
+					mismatches += bitwise_equal(mesh.vertices.at(vertex), vertices.at(indices.at(input_index))) ? 0 : 1;
+				}
+			}
+
+			CHECK(input_index == indices.size());
+			CHECK(mismatches == 0);
+		}
+
+		void check_submesh_vertex_counts(const split_mesh& mesh)
+		{
+			for (const auto& [first_index, index_count, base_vertex] : mesh.submeshes) {
+				const auto first = std::next(mesh.indices.begin(), first_index);
+				const std::unordered_set<std::uint16_t> referenced {first, std::next(first, index_count)};
+				CHECK(referenced.size() <= 65536);
+			}
+		}
+	}
+
+	SANDBOX_TEST(large_grid_splits_into_submeshes)
+	{
+		const auto indices = make_grid_indices(large_grid_side);
+		const auto vertices = make_grid_vertices(large_grid_side);
+		const auto mesh = split_submeshes(indices, vertices);
+		CHECK(mesh.submeshes.size() == 2);
+		CHECK(mesh.submeshes.front().base_vertex == 0);
+		CHECK(mesh.indices.size() == indices.size());
+		check_triangles_preserved(indices, vertices, mesh);
+		check_submesh_vertex_counts(mesh);
+	}
+
+	// Shuffled triangles reach all over the grid, so that most vertices are duplicated across several submeshes
+	SANDBOX_TEST(shuffled_grid_duplicates_shared_vertices)
+	{
+		auto indices = make_grid_indices(large_grid_side);
+		shuffle_triangles(indices, 11);
+		const auto vertices = make_grid_vertices(large_grid_side);
+		const auto mesh = split_submeshes(indices, vertices);
+		CHECK(mesh.submeshes.size() > 2);
+		CHECK(mesh.vertices.size() > vertices.size());
+		check_triangles_preserved(indices, vertices, mesh);
+		check_submesh_vertex_counts(mesh);
+
+		// Each submesh's vertices are its own contiguous run
+		for (std::size_t i {}; i + 1 < mesh.submeshes.size(); ++i)
+			CHECK(mesh.submeshes.at(i).base_vertex < mesh.submeshes.at(i + 1).base_vertex);
+	}
+
+	// Exactly 65,536 vertices, the most that fit in a single submesh
+	SANDBOX_TEST(small_grid_keeps_its_vertex_order)
+	{
+		const auto indices = make_grid_indices(256);
+		const auto vertices = make_grid_vertices(256);
+		const auto mesh = split_submeshes(indices, vertices);
+		CHECK(mesh.submeshes.size() == 1);
+		CHECK(mesh.submeshes.front().first_index == 0);
+		CHECK(mesh.submeshes.front().index_count == indices.size());
+		CHECK(mesh.submeshes.front().base_vertex == 0);
+		CHECK(mesh.vertices.size() == vertices.size());
+		CHECK(std::memcmp(mesh.vertices.data(), vertices.data(), vertices.size() * sizeof(vertex_data)) == 0);
+		CHECK(std::equal(indices.begin(), indices.end(), mesh.indices.begin(), mesh.indices.end()));
+	}
+}
@@ -0,0 +1,44 @@
+#include "test_harness.h"
+
+#include <iostream>
+
+namespace sandbox::testing {
+	namespace {
+		bool g_current_failed {};
+	}
+}
+
+std::vector<sandbox::testing::test_case>& sandbox::testing::get_tests()
+{
+	static std::vector<test_case> tests {};
+	return tests;
+}
+
+void sandbox::testing::report_failure(const char* file, int line, const char* expression)
+{
+	std::cout << file << "(" << line << "): check failed: " << expression << "\n";
+	g_current_failed = true;
+}
+
+int main()
+{
+	using namespace sandbox::testing;
+
+	std::size_t failed_count {};
+	for (const auto& [name, run] : get_tests()) {
+		g_current_failed = false;
+		try {
+			run();
+		}
+		catch (const std::exception& error) {
+			std::cout << name << ": threw " << error.what() << "\n";
+			g_current_failed = true;
+		}
+
+		std::cout << (g_current_failed ? "FAIL " : "pass ") << name << "\n";
+		failed_count += g_current_failed ? 1 : 0;
+	}
+
+	std::cout << get_tests().size() - failed_count << " of " << get_tests().size() << " tests passed\n";
+	return failed_count == 0 ? 0 : 1;
+}
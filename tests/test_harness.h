@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <string_view>
+#include <vector>
+
+namespace sandbox::testing {
+	struct test_case {
+		std::string_view name;
+		void (*run)();
+	};
+
+	// Every test in the executable, in the order they were registered
+	std::vector<test_case>& get_tests();
+
+	class registration {
+	public:
+		registration(std::string_view name, void (*run)()) { get_tests().push_back({name, run}); }
+	};
+
+	// Marks the running test as failed, but lets it continue
+	void report_failure(const char* file, int line, const char* expression);
+}
+
+// Defines a test, which is run by the harness's main() along with every other test linked into the executable
+#define SANDBOX_TEST(name)                                                                                             \
+	static void name();                                                                                                \
+	static const sandbox::testing::registration name##_registration {#name, name};                                    \
+	static void name()
+
+#define CHECK(expression)                                                                                              \
+	((expression) ? void() : sandbox::testing::report_failure(__FILE__, __LINE__, #expression))
+
+#define CHECK_THROWS(expression, exception_type)                                                                       \
+	do {                                                                                                               \
+		bool thrown {};                                                                                                \
+		try {                                                                                                          \
+			static_cast<void>(expression);                                                                             \
+		}                                                                                                              \
+		catch (const exception_type&) {                                                                                \
+			thrown = true;                                                                                             \
+		}                                                                                                              \
+                                                                                                                       \
+		if (!thrown)                                                                                                   \
+			sandbox::testing::report_failure(__FILE__, __LINE__, #expression " throws " #exception_type);              \
+	} while (false)
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../runtime/stream_format.h"
+
+namespace sandbox::testing {
+	// A `side` x `side` grid of vertices in the z = 0 plane, two triangles per cell; front faces point towards -z, at a
+	// viewer looking along +z
+	inline std::vector<unsigned int> make_grid_indices(std::size_t side)
+	{
+		std::vector<unsigned int> indices {};
+		const auto vertex = [side](std::size_t x, std::size_t y) { return static_cast<unsigned int>(y * side + x); };
+		for (std::size_t y {}; y + 1 < side; ++y) {
+			for (std::size_t x {}; x + 1 < side; ++x) {
+				indices.insert(indices.end(), {vertex(x, y), vertex(x, y + 1), vertex(x + 1, y)});
+				indices.insert(indices.end(), {vertex(x + 1, y), vertex(x, y + 1), vertex(x + 1, y + 1)});
+			}
+		}
+
+		return indices;
+	}
+
+	inline std::vector<vertex_data> make_grid_vertices(std::size_t side, float z = 0.0f)
+	{
+		std::vector<vertex_data> vertices {};
+		for (std::size_t y {}; y < side; ++y) {
+			for (std::size_t x {}; x < side; ++x) {
+				const auto u = static_cast<float>(x);
+				const auto v = static_cast<float>(y);
+				vertices.push_back({.position {u, v, z}, .texture_coord {u, v, 0.0f}, .normal {0.0f, 0.0f, -1.0f}});
+			}
+		}
+
+		return vertices;
+	}
+
+	// Shuffles whole triangles, keeping each one's corners in order
+	inline void shuffle_triangles(std::vector<unsigned int>& indices, unsigned int seed)
+	{
+		std::vector<std::array<unsigned int, 3>> triangles {};
+		for (std::size_t i {}; i + 2 < indices.size(); i += 3)
+			triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937 {seed});
+		indices.clear();
+		for (const auto& triangle : triangles)
+			indices.insert(indices.end(), triangle.begin(), triangle.end());
+	}
+
+	// The triangles as a sorted list, for comparing meshes whose triangles were only reordered
+	inline std::vector<std::array<unsigned int, 3>> get_sorted_triangles(const std::vector<unsigned int>& indices)
+	{
+		std::vector<std::array<unsigned int, 3>> triangles {};
+		for (std::size_t i {}; i + 2 < indices.size(); i += 3)
+			triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
@@ -0,0 +1,152 @@
+#include "../import/pch.h"
+
+#include "../import/token_scanner.h"
+#include "benchmark_harness.h"
+
+#include <random>
+#include <string>
+
+namespace sandbox {
+	namespace {
+		// The byte-at-a-time scanner that find_byte() and split_tokens() replaced, as the baseline
+		template <char delimiter, bool skip_leading = true>
+		std::string_view get_next_token(const char*& iterator, const char* last) noexcept
+		{
+			if constexpr (skip_leading) {
+				for (; iterator != last && *iterator == delimiter; ++iterator)
+					;
+			}
+
+			const auto first_char = iterator;
+			for (; iterator != last && *iterator != delimiter; ++iterator)
+				;
+
+			return {first_char, gsl::narrow_cast<std::size_t>(iterator - first_char)};
+		}
+
+		// Lines end in "\r\n", as the loader expects
+		std::string make_faces(std::size_t face_count)
+		{
+			std::mt19937 engine {1};
+			std::uniform_int_distribution<unsigned int> reference {1, 5'000'000};
+			std::string content {};
+			content.reserve(face_count * 48);
+			content += "\r\n";
+			for (std::size_t i {}; i < face_count; ++i) {
+				content += "f";
+				for (int corner {}; corner < 3; ++corner) {
+					content += ' ';
+					content += std::to_string(reference(engine));
+					content += '/';
+					content += std::to_string(reference(engine));
+					content += '/';
+					content += std::to_string(reference(engine));
+				}
+
+				content += "\r\n";
+			}
+
+			return content;
+		}
+
+		// Both scans visit the same tokens in the same way the loader does, and return the total length of the corner
+		// references, so that each can be checked against the other
+		std::size_t scan_bytewise(std::string_view content)
+		{
+			std::size_t total {};
+			auto iterator = content.data();
+			const auto last = content.data() + content.size();
+			while (true) {
+				const auto line = get_next_token<'\r'>(iterator, last);
+				if (line.empty())
+					break;
+
+				auto line_iterator = line.data() + 1;
+				const auto line_end = line.data() + line.size();
+				if (get_next_token<' '>(line_iterator, line_end) != "f")
+					continue;
+
+				for (int corner {}; corner < 3; ++corner) {
+					const auto corner_string = get_next_token<' '>(line_iterator, line_end);
+					auto corner_iterator = corner_string.data();
+					const auto corner_end = corner_string.data() + corner_string.size();
+					for (int component {}; component < 3; ++component) {
+						total += get_next_token<'/', false>(corner_iterator, corner_end).size();
+						if (corner_iterator != corner_end)
+							++corner_iterator;
+					}
+				}
+
+				get_next_token<' '>(line_iterator, line_end);
+			}
+
+			return total;
+		}
+
+		std::size_t scan_blockwise(std::string_view content)
+		{
+			std::size_t total {};
+			auto line_first = content.data();
+			const auto content_end = content.data() + content.size();
+			while (true) {
+				for (; line_first != content_end && *line_first == '\r'; ++line_first)
+					;
+
+				if (line_first == content_end)
+					break;
+
+				const auto line_last = find_byte(line_first, content_end, content_end, '\r');
+				const std::string_view line {line_first + 1, gsl::narrow_cast<std::size_t>(line_last - line_first) - 1};
+				line_first = line_last;
+
+				std::array<std::string_view, 1> line_type {};
+				split_tokens(line, content_end, ' ', true, line_type);
+				if (line_type[0] != "f")
+					continue;
+
+				const auto elements_first = line_type[0].data() + line_type[0].size();
+				const std::string_view elements {
+					elements_first,
+					gsl::narrow_cast<std::size_t>(line_last - elements_first)};
+
+				std::array<std::string_view, 4> corners {};
+				split_tokens(elements, content_end, ' ', true, corners);
+				for (std::size_t corner {}; corner < 3; ++corner) {
+					std::array<std::string_view, 3> components {};
+					split_tokens(corners[corner], content_end, '/', false, components);
+					for (const auto& component : components)
+						total += component.size();
+				}
+			}
+
+			return total;
+		}
+	}
+}
+
+// Usage: token_scanner_benchmark [face count (default 10M)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto face_count = get_count_argument(argc, argv, 1, 10'000'000);
+	const auto content = make_faces(face_count);
+	std::cout << face_count << " faces, " << content.size() / 1e6 << " MB\n";
+
+	std::size_t bytewise_total {};
+	std::size_t blockwise_total {};
+	constexpr std::size_t repeat_count {5};
+	const auto bytewise = time_fastest(repeat_count, [&] { bytewise_total = scan_bytewise(content); });
+	const auto blockwise = time_fastest(repeat_count, [&] { blockwise_total = scan_blockwise(content); });
+	keep(bytewise_total);
+	keep(blockwise_total);
+
+	report("byte-wise", bytewise, gsl::narrow_cast<double>(face_count), "face");
+	report("block-wise", blockwise, gsl::narrow_cast<double>(face_count), "face");
+	std::cout << "speedup " << bytewise / blockwise << "x\n";
+	if (bytewise_total != blockwise_total) {
+		std::cout << "scanners disagree\n";
+		return 1;
+	}
+}
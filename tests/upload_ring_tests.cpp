@@ -0,0 +1,162 @@
+#include "../runtime/pch.h"
+
+#include "../runtime/upload_ring.h"
+#include "test_harness.h"
+
+#include <random>
+
+using namespace sandbox;
+
+SANDBOX_TEST(allocations_are_aligned_and_padding_is_wasted)
+{
+	upload_ring ring {1024};
+	CHECK(ring.allocate(10, 1) == 0);
+	CHECK(ring.allocate(16, 256) == 256);
+	CHECK(ring.used() == 272);
+	CHECK(ring.wasted() == 246);
+	CHECK(ring.largest_free_block() == 1024 - 272);
+}
+
+SANDBOX_TEST(a_full_ring_refuses_until_its_batches_retire)
+{
+	upload_ring ring {1024};
+	CHECK(ring.allocate(1024, 1) == 0);
+	CHECK(!ring.allocate(1, 1));
+	CHECK(ring.largest_free_block() == 0);
+
+	ring.submit(5);
+	ring.retire(4);
+	CHECK(!ring.allocate(1, 1));
+
+	ring.retire(5);
+	CHECK(ring.used() == 0);
+	CHECK(ring.allocate(1024, 1) == 0);
+}
+
+SANDBOX_TEST(oversized_allocations_fail)
+{
+	upload_ring ring {1024};
+	CHECK(!ring.allocate(1025, 1));
+	CHECK(ring.used() == 0);
+}
+
+SANDBOX_TEST(batches_retire_in_order_of_their_fences)
+{
+	upload_ring ring {1024};
+	CHECK(ring.allocate(100, 1) == 0);
+	ring.submit(1);
+	CHECK(ring.allocate(200, 1) == 100);
+	ring.submit(2);
+	CHECK(ring.allocate(300, 1) == 300);
+	ring.submit(3);
+
+	ring.retire(2);
+	CHECK(ring.used() == 300);
+	ring.retire(3);
+	CHECK(ring.used() == 0);
+}
+
+SANDBOX_TEST(empty_batches_are_not_submitted)
+{
+	upload_ring ring {1024};
+	ring.submit(1);
+	CHECK(ring.allocate(100, 1) == 0);
+	ring.submit(2);
+	ring.retire(1);
+	CHECK(ring.used() == 100);
+	ring.retire(2);
+	CHECK(ring.used() == 0);
+}
+
+SANDBOX_TEST(allocations_wrap_around_and_waste_the_end_of_the_ring)
+{
+	upload_ring ring {1024};
+	CHECK(ring.allocate(400, 1) == 0);
+	ring.submit(1);
+	CHECK(ring.allocate(400, 1) == 400);
+	ring.submit(2);
+	ring.retire(1);
+
+	// 224 bytes are left at the end, so 300 goes to the start and the end is skipped
+	CHECK(ring.largest_free_block() == 400);
+	CHECK(ring.allocate(300, 1) == 0);
+	CHECK(ring.wasted() == 224);
+	CHECK(ring.used() == 400 + 224 + 300);
+	CHECK(ring.largest_free_block() == 100);
+	ring.submit(3);
+
+	// Retiring the batch that wrapped releases its wasted bytes along with it
+	ring.retire(2);
+	CHECK(ring.used() == 524);
+	ring.retire(3);
+	CHECK(ring.used() == 0);
+	CHECK(ring.wasted() == 0);
+}
+
+SANDBOX_TEST(an_emptied_ring_starts_again_from_the_beginning)
+{
+	upload_ring ring {1024};
+	CHECK(ring.allocate(1000, 1) == 0);
+	ring.submit(1);
+	ring.retire(1);
+	CHECK(ring.largest_free_block() == 1024);
+	CHECK(ring.allocate(1024, 1) == 0);
+}
+
+SANDBOX_TEST(random_traffic_never_hands_out_overlapping_space)
+{
+	struct live_allocation {
+		std::size_t offset;
+		std::size_t size;
+		std::uint64_t fence_value;
+	};
+
+	constexpr std::size_t capacity {1 << 16};
+	upload_ring ring {capacity};
+	std::vector<live_allocation> live {};
+	std::mt19937 engine {7};
+	std::uniform_int_distribution<std::size_t> size {1, 4096};
+	std::uniform_int_distribution<int> alignment_log2 {0, 8};
+	std::uniform_int_distribution<int> action {0, 9};
+	std::uint64_t next_fence {1};
+	std::uint64_t completed {};
+	std::size_t failures {};
+	for (int step {}; step < 100'000; ++step) {
+		const auto choice = action(engine);
+		if (choice < 7) {
+			const auto requested = size(engine);
+			const auto alignment = std::size_t {1} << alignment_log2(engine);
+			const auto offset = ring.allocate(requested, alignment);
+			if (!offset) {
+				// Aligning can cost up to `alignment - 1` bytes of the largest free block
+				CHECK(requested + alignment - 1 > ring.largest_free_block());
+				++failures;
+				continue;
+			}
+
+			CHECK(*offset % alignment == 0);
+			CHECK(*offset + requested <= capacity);
+			for (const auto& other : live)
+				CHECK(*offset + requested <= other.offset || other.offset + other.size <= *offset);
+
+			live.push_back({*offset, requested, next_fence});
+		}
+		else if (choice < 9) {
+			ring.submit(next_fence++);
+		}
+		else if (completed + 1 < next_fence) {
+			completed = std::uniform_int_distribution<std::uint64_t> {completed + 1, next_fence - 1}(engine);
+			ring.retire(completed);
+			std::erase_if(live, [completed](const live_allocation& other) { return other.fence_value <= completed; });
+		}
+
+		CHECK(ring.used() <= capacity);
+		CHECK(ring.wasted() <= ring.used());
+	}
+
+	ring.submit(next_fence);
+	ring.retire(next_fence);
+	CHECK(ring.used() == 0);
+	CHECK(ring.wasted() == 0);
+	CHECK(failures > 0);
+}
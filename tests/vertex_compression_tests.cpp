@@ -0,0 +1,100 @@
+#include "../import/pch.h"
+
+#include "../import/vertex_compression.h"
+#include "test_harness.h"
+
+#include <cmath>
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t sphere_side {48};
+
+		// A UV sphere of radius 3 around (1, -2, 5), with texture coordinates running past one so that the half
+		// precision's range is exercised as well as its rounding
+		std::vector<vertex_data> make_sphere_vertices()
+		{
+			constexpr auto pi = 3.14159265f;
+			std::vector<vertex_data> vertices {};
+			for (std::size_t y {}; y < sphere_side; ++y) {
+				for (std::size_t x {}; x < sphere_side; ++x) {
+					const auto u = static_cast<float>(x) / (sphere_side - 1);
+					const auto v = static_cast<float>(y) / (sphere_side - 1);
+					const auto theta = u * 2.0f * pi;
+					const auto phi = v * pi;
+					const vector3 normal {
+						std::sin(phi) * std::cos(theta),
+						std::cos(phi),
+						std::sin(phi) * std::sin(theta)};
+
+					vertices.push_back(
+						{.position {1.0f + 3.0f * normal.x, -2.0f + 3.0f * normal.y, 5.0f + 3.0f * normal.z},
+						 .texture_coord {u * 4.0f, v * 2.0f, 0.0f},
+						 .normal {normal}});
+				}
+			}
+
+			return vertices;
+		}
+
+		float get_angle_degrees(const vector3& a, const vector3& b)
+		{
+			const auto cosine = (a.x * b.x + a.y * b.y + a.z * b.z)
+				/ std::sqrt((a.x * a.x + a.y * a.y + a.z * a.z) * (b.x * b.x + b.y * b.y + b.z * b.z));
+
+			return std::acos(std::min(cosine, 1.0f)) * 57.2957795f;
+		}
+
+		// Positions are within a quantization step of the 6-unit extent, texture coordinates within a half-precision
+		// ulp of values below 4, and normals within the octahedral encoding's error
+		constexpr auto position_tolerance = 6.0f / 65535.0f;
+		constexpr auto texture_tolerance = 1.0f / 512.0f;
+		constexpr auto normal_tolerance = 0.05f;
+	}
+}
+
+using namespace sandbox;
+using namespace sandbox::testing;
+
+SANDBOX_TEST(compact_vertices_decode_within_the_quantization_error)
+{
+	const auto originals = make_sphere_vertices();
+	const auto compressed = compress_vertices(originals);
+	CHECK(compressed.vertices.size() == originals.size());
+	for (std::size_t i {}; i < originals.size(); ++i) {
+		const auto decoded = decompress_vertex(compressed.vertices[i], compressed.bounds);
+		const auto& original = originals[i];
+		CHECK(std::abs(decoded.position.x - original.position.x) <= position_tolerance);
+		CHECK(std::abs(decoded.position.y - original.position.y) <= position_tolerance);
+		CHECK(std::abs(decoded.position.z - original.position.z) <= position_tolerance);
+		CHECK(std::abs(decoded.texture_coord.x - original.texture_coord.x) <= texture_tolerance);
+		CHECK(std::abs(decoded.texture_coord.y - original.texture_coord.y) <= texture_tolerance);
+		CHECK(decoded.texture_coord.z == 0.0f);
+		CHECK(get_angle_degrees(decoded.normal, original.normal) <= normal_tolerance);
+	}
+}
+
+SANDBOX_TEST(reported_error_stays_within_the_quantization_error)
+{
+	const auto originals = make_sphere_vertices();
+	const auto error = measure_compression_error(originals, compress_vertices(originals));
+	CHECK(error.position <= position_tolerance);
+	CHECK(error.texture_coord <= texture_tolerance);
+	CHECK(error.normal <= normal_tolerance);
+}
+
+// The corners of the bounds are the ends of the quantized range, so they come back exactly
+SANDBOX_TEST(bounds_corners_decode_exactly)
+{
+	const std::vector<vertex_data> originals {
+		{.position {-1.5f, 2.0f, 0.25f}, .texture_coord {}, .normal {0.0f, 0.0f, 1.0f}},
+		{.position {3.5f, 4.0f, 8.25f}, .texture_coord {}, .normal {0.0f, 0.0f, -1.0f}}};
+
+	const auto compressed = compress_vertices(originals);
+	for (std::size_t i {}; i < originals.size(); ++i) {
+		const auto decoded = decompress_vertex(compressed.vertices[i], compressed.bounds);
+		CHECK(decoded.position.x == originals[i].position.x);
+		CHECK(decoded.position.y == originals[i].position.y);
+		CHECK(decoded.position.z == originals[i].position.z);
+		CHECK(decoded.normal.z == originals[i].normal.z);
+	}
+}
@@ -0,0 +1,99 @@
+#include "../import/pch.h"
+
+#include "../import/vertex_repacking.h"
+#include "test_harness.h"
+
+#include <random>
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t grid_side {96};
+
+		// A grid whose corners share positions with up to six triangles, texture coordinates along each row and
+		// normals cyclically, so that equal positions do not always mean equal vertices; the triangles are then
+		// shuffled so that first uses land in every shard in no particular order
+		wavefront make_shared_grid()
+		{
+			wavefront object {};
+			for (std::size_t i {}; i < grid_side * grid_side; ++i) {
+				const auto x = static_cast<float>(i % grid_side);
+				const auto y = static_cast<float>(i / grid_side);
+				object.positions.push_back({x, y, 0.0f});
+			}
+
+			for (std::size_t i {}; i < grid_side; ++i)
+				object.textures.push_back({static_cast<float>(i) / grid_side, 0.5f, 0.0f});
+
+			object.normals = {{0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+			const auto corner = [](std::size_t x, std::size_t y) {
+				const auto i = y * grid_side + x;
+				return vertex {.position {i}, .texture {x}, .normal {(x + y) % 3}};
+			};
+
+			std::vector<std::array<vertex, 3>> triangles {};
+			for (std::size_t y {}; y + 1 < grid_side; ++y) {
+				for (std::size_t x {}; x + 1 < grid_side; ++x) {
+					triangles.push_back({corner(x, y), corner(x, y + 1), corner(x + 1, y)});
+					triangles.push_back({corner(x + 1, y), corner(x, y + 1), corner(x + 1, y + 1)});
+				}
+			}
+
+			// Corners with missing and out-of-range references, which all read as the default attribute
+			constexpr auto missing = std::numeric_limits<std::size_t>::max();
+			const vertex untextured {.position {5}, .texture {missing}, .normal {0}};
+			const vertex out_of_range {.position {5}, .texture {grid_side + 7}, .normal {missing - 2}};
+			for (std::size_t i {}; i < 50; ++i)
+				triangles.push_back({untextured, out_of_range, corner(i, i)});
+
+			std::shuffle(triangles.begin(), triangles.end(), std::mt19937 {7});
+			for (const auto& triangle : triangles)
+				object.faces.insert(object.faces.end(), triangle.begin(), triangle.end());
+
+			return object;
+		}
+
+		template <typename type>
+		bool bitwise_equal(const std::vector<type>& a, const std::vector<type>& b)
+		{
+			return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(type)) == 0;
+		}
+	}
+
+	SANDBOX_TEST(serial_repack_numbers_vertices_by_first_use)
+	{
+		const auto object = make_shared_grid();
+		const auto mesh = repack(object);
+		CHECK(mesh.indices.size() == object.faces.size());
+
+		unsigned int next_number {};
+		for (const auto index : mesh.indices) {
+			CHECK(index <= next_number);
+			if (index == next_number)
+				++next_number;
+		}
+
+		CHECK(next_number == mesh.vertices.size());
+		CHECK(mesh.vertices.size() < object.faces.size() / 4);
+	}
+
+	// Explicit thread counts, whichever machine this runs on, so that the sharded path is taken even on a single core
+	SANDBOX_TEST(sharded_repack_matches_serial_repack)
+	{
+		const auto object = make_shared_grid();
+		const auto expected = repack(object);
+		for (const auto worker_count : {1u, 3u, 6u}) {
+			job_system jobs {worker_count};
+			const auto actual = repack(object, jobs);
+			CHECK(bitwise_equal(actual.indices, expected.indices));
+			CHECK(bitwise_equal(actual.vertices, expected.vertices));
+		}
+	}
+
+	SANDBOX_TEST(sharded_repack_of_an_empty_object_is_empty)
+	{
+		job_system jobs {3};
+		const auto mesh = repack(wavefront {}, jobs);
+		CHECK(mesh.indices.empty());
+		CHECK(mesh.vertices.empty());
+	}
+}
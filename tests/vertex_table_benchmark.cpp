@@ -0,0 +1,179 @@
+#include "../import/pch.h"
+
+#include "../import/vertex_repacking.h"
+#include "../import/vertex_table.h"
+#include "benchmark_harness.h"
+
+#include <unordered_map>
+
+namespace sandbox {
+	namespace {
+		std::size_t g_allocated_bytes {};
+
+		// Counts what the node-based map asks for, so that its footprint can be compared with the flat table's;
+		// allocator overhead per node comes on top of this
+		template <typename value_type_>
+		struct counting_allocator {
+			using value_type = value_type_;
+
+			counting_allocator() noexcept = default;
+
+			template <typename other_type>
+			counting_allocator(const counting_allocator<other_type>&) noexcept
+			{
+			}
+
+			value_type* allocate(std::size_t count)
+			{
+				g_allocated_bytes += count * sizeof(value_type);
+				return std::allocator<value_type> {}.allocate(count);
+			}
+
+			void deallocate(value_type* pointer, std::size_t count) noexcept
+			{
+				g_allocated_bytes -= count * sizeof(value_type);
+				std::allocator<value_type> {}.deallocate(pointer, count);
+			}
+
+			template <typename other_type>
+			bool operator==(const counting_allocator<other_type>&) const noexcept
+			{
+				return true;
+			}
+		};
+
+		// The flat table's own CRC32 hash, so that only the containers differ
+		struct vertex_hash {
+			std::size_t operator()(const vertex& key) const noexcept { return hash(key); }
+		};
+
+		struct vertex_equal {
+			bool operator()(const vertex& a, const vertex& b) const noexcept
+			{
+				return a.position == b.position && a.texture == b.texture && a.normal == b.normal;
+			}
+		};
+
+		using node_map = std::unordered_map<
+			vertex,
+			unsigned int,
+			vertex_hash,
+			vertex_equal,
+			counting_allocator<std::pair<const vertex, unsigned int>>>;
+
+		vector3 map_index(gsl::span<const vector3> values, std::size_t index) noexcept
+		{
+			return index < values.size() ? values[index] : vector3 {1.0f};
+		}
+
+		// The repacking loop as it was before the flat table, as the baseline
+		repacked_mesh repack_node_map(const wavefront& object)
+		{
+			node_map index_map {};
+			repacked_mesh mesh {};
+			auto& [indices, vertices] = mesh;
+			for (const auto& corner : object.faces) {
+				const auto [iterator, inserted]
+					= index_map.insert({corner, gsl::narrow_cast<unsigned int>(vertices.size())});
+
+				if (inserted) {
+					vertices.push_back(
+						{.position {map_index(object.positions, corner.position)},
+						 .texture_coord {map_index(object.textures, corner.texture)},
+						 .normal {map_index(object.normals, corner.normal)}});
+				}
+
+				indices.push_back(iterator->second);
+			}
+
+			return mesh;
+		}
+
+		// A grid of `vertex_count` distinct corners, two triangles per cell, so that each vertex is shared by up to
+		// six triangles with the locality of a real mesh
+		wavefront make_grid(std::size_t vertex_count)
+		{
+			const auto side = gsl::narrow_cast<std::size_t>(std::sqrt(gsl::narrow_cast<double>(vertex_count)));
+			wavefront object {};
+			for (std::size_t i {}; i < side * side; ++i) {
+				const auto x = gsl::narrow_cast<float>(i % side);
+				const auto y = gsl::narrow_cast<float>(i / side);
+				object.positions.push_back({x, y, 0.0f});
+			}
+
+			object.textures.resize(side, {0.5f, 0.5f, 0.0f});
+			object.normals.resize(7, {0.0f, 0.0f, 1.0f});
+			const auto corner = [&](std::size_t x, std::size_t y) {
+				const auto i = y * side + x;
+				return vertex {.position {i}, .texture {i % side}, .normal {i % 7}};
+			};
+
+			for (std::size_t y {}; y + 1 < side; ++y) {
+				for (std::size_t x {}; x + 1 < side; ++x) {
+					object.faces.insert(object.faces.end(), {corner(x, y), corner(x, y + 1), corner(x + 1, y)});
+					object.faces.insert(
+						object.faces.end(),
+						{corner(x + 1, y), corner(x, y + 1), corner(x + 1, y + 1)});
+				}
+			}
+
+			return object;
+		}
+	}
+}
+
+// Usage: vertex_table_benchmark [unique vertex count (default 4M)]
+int main(int argc, char** argv)
+{
+	using namespace sandbox;
+	using namespace sandbox::benchmarking;
+
+	const auto object = make_grid(get_count_argument(argc, argv, 1, 4'000'000));
+	const auto corner_count = gsl::narrow_cast<double>(object.faces.size());
+	std::cout << object.positions.size() << " unique vertices, " << object.faces.size() << " corners\n";
+
+	std::size_t node_bytes {};
+	std::size_t flat_bytes {};
+	constexpr std::size_t repeat_count {3};
+	const auto node_insert = time_fastest(repeat_count, [&] {
+		node_map index_map {};
+		for (const auto& corner : object.faces)
+			index_map.insert({corner, gsl::narrow_cast<unsigned int>(index_map.size())});
+
+		node_bytes = g_allocated_bytes;
+	});
+
+	const auto flat_insert = time_fastest(repeat_count, [&] {
+		vertex_table index_map {object.faces.size()};
+		for (const auto& corner : object.faces)
+			index_map.insert(corner, gsl::narrow_cast<unsigned int>(index_map.size()));
+
+		flat_bytes = index_map.memory_footprint();
+	});
+
+	report("std::unordered_map insert", node_insert, corner_count, "corner");
+	report("vertex_table insert", flat_insert, corner_count, "corner");
+	const auto vertex_count = gsl::narrow_cast<double>(object.positions.size());
+	std::cout << "footprint: std::unordered_map " << node_bytes / 1e6 << " MB (before allocator overhead), "
+			  << "vertex_table " << flat_bytes / 1e6 << " MB\n"
+			  << "per unique vertex: std::unordered_map " << node_bytes / vertex_count << " B, vertex_table "
+			  << flat_bytes / vertex_count << " B\n";
+
+	repacked_mesh node_mesh {};
+	repacked_mesh flat_mesh {};
+	const auto node_repack = time_fastest(repeat_count, [&] { node_mesh = repack_node_map(object); });
+	const auto flat_repack = time_fastest(repeat_count, [&] { flat_mesh = repack(object); });
+	report("repack, std::unordered_map", node_repack, corner_count, "corner");
+	report("repack, vertex_table", flat_repack, corner_count, "corner");
+
+	job_system jobs {std::max(std::thread::hardware_concurrency(), 1u) - 1};
+	repacked_mesh parallel_mesh {};
+	const auto parallel_repack = time_fastest(repeat_count, [&] { parallel_mesh = repack(object, jobs); });
+	report("repack, sharded", parallel_repack, corner_count, "corner");
+	std::cout << "(" << jobs.thread_count() << " threads)\n";
+
+	if (node_mesh.indices != flat_mesh.indices || parallel_mesh.indices != flat_mesh.indices) {
+		std::cout << "repacked indices disagree\n";
+		return 1;
+	}
+}
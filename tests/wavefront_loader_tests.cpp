@@ -0,0 +1,125 @@
+#include "../import/pch.h"
+
+#include "../import/wavefront_loader.h"
+#include "test_harness.h"
+
+#include <filesystem>
+#include <string>
+
+namespace sandbox::testing {
+	namespace {
+		constexpr std::size_t group_count {20000};
+
+		struct relative_strip {
+			std::string content;
+			std::vector<vertex> faces; // Resolved by hand
+		};
+
+		// Groups of three vertices, each followed by a face on its own vertices and a face reaching three groups back,
+		// all through relative references, so that every chunk boundary is crossed by some face; every tenth group
+		// also has a face with absolute references. Lines end in CRLF, as the loader expects.
+		relative_strip make_relative_strip()
+		{
+			relative_strip strip {.content {"# relative strip\r\n"}, .faces {}};
+			const auto add_face = [&strip](std::string_view line, std::initializer_list<vertex> corners) {
+				strip.content += line;
+				strip.content += "\r\n";
+				strip.faces.insert(strip.faces.end(), corners);
+			};
+
+			for (std::size_t group {}; group < group_count; ++group) {
+				for (std::size_t corner {}; corner < 3; ++corner) {
+					const auto n = std::to_string(group * 3 + corner);
+					strip.content += "v " + n + ".25 -" + n + " 1.5e-3\r\n";
+					strip.content += "vt 0." + n + " 0.5\r\n";
+					strip.content += "vn 0 0 -1\r\n";
+				}
+
+				const auto first = group * 3;
+				add_face(
+					"f -3/-3/-3 -2/-2/-2 -1/-1/-1",
+					{{first, first, first}, {first + 1, first + 1, first + 1}, {first + 2, first + 2, first + 2}});
+				if (group >= 3) {
+					add_face(
+						"f -12/-11/-10 -1/-2/-3 -6/-6/-6",
+						{{first - 9, first - 8, first - 7}, {first + 2, first + 1, first}, {first - 3, first - 3, first - 3}});
+				}
+
+				if (group % 10 == 0) {
+					const auto absolute = std::to_string(first + 2);
+					add_face(
+						"f " + absolute + "/" + absolute + "/" + absolute + " 1/1/1 -1/-1/-1",
+						{{first + 1, first + 1, first + 1}, {0, 0, 0}, {first + 2, first + 2, first + 2}});
+				}
+			}
+
+			return strip;
+		}
+
+		template <typename type>
+		bool bitwise_equal(const std::vector<type>& a, const std::vector<type>& b)
+		{
+			return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(type)) == 0;
+		}
+
+		void check_identical(const wavefront& expected, const wavefront& actual)
+		{
+			CHECK(bitwise_equal(expected.positions, actual.positions));
+			CHECK(bitwise_equal(expected.textures, actual.textures));
+			CHECK(bitwise_equal(expected.normals, actual.normals));
+			CHECK(bitwise_equal(expected.faces, actual.faces));
+		}
+
+		class temporary_file {
+		public:
+			explicit temporary_file(const std::string& content) :
+				m_path {std::filesystem::temp_directory_path() / "sandbox_wavefront_loader.obj"}
+			{
+				std::ofstream outfile {m_path, outfile.binary};
+				outfile.exceptions(outfile.failbit | outfile.badbit);
+				outfile.write(content.data(), gsl::narrow<std::streamsize>(content.size()));
+			}
+
+			~temporary_file() noexcept { std::filesystem::remove(m_path); }
+
+			temporary_file(const temporary_file&) = delete;
+			temporary_file& operator=(const temporary_file&) = delete;
+			temporary_file(temporary_file&&) = delete;
+			temporary_file& operator=(temporary_file&&) = delete;
+
+			std::string name() const { return m_path.string(); }
+
+		private:
+			std::filesystem::path m_path;
+		};
+	}
+
+	SANDBOX_TEST(serial_load_resolves_relative_references)
+	{
+		const auto strip = make_relative_strip();
+		const temporary_file file {strip.content};
+		const auto object = load_wavefront(file.name().c_str());
+		CHECK(object.positions.size() == group_count * 3);
+		CHECK(bitwise_equal(object.faces, strip.faces));
+	}
+
+	// Enough chunks that every one of them starts part way through the strip, with faces reaching back past its start
+	SANDBOX_TEST(mapped_load_matches_serial_load_across_chunks)
+	{
+		const temporary_file file {make_relative_strip().content};
+		const auto expected = load_wavefront(file.name().c_str());
+		for (const auto worker_count : {0u, 1u, 3u, 7u}) {
+			job_system jobs {worker_count};
+			check_identical(expected, load_wavefront_mapped(file.name().c_str(), jobs));
+		}
+	}
+
+	SANDBOX_TEST(empty_file_maps_to_empty_object)
+	{
+		const temporary_file file {""};
+		job_system jobs {3};
+		const auto object = load_wavefront_mapped(file.name().c_str(), jobs);
+		CHECK(object.positions.empty());
+		CHECK(object.faces.empty());
+	}
+}